@@ -50,6 +50,8 @@ static void audio_thread_loop(void *data)
    if (!thr)
       return;
 
+   rarch_perf_trace_thread_name("audio");
+
    RARCH_LOG("[Audio Thread]: Initializing audio driver.\n");
    thr->driver_data   = thr->driver->init(thr->device, thr->out_rate, thr->latency);
    slock_lock(thr->lock);
@@ -60,7 +62,10 @@ static void audio_thread_loop(void *data)
    slock_unlock(thr->lock);
 
    if (thr->inited < 0)
+   {
+      rarch_perf_thread_exit();
       return;
+   }
 
    /* Wait until we start to avoid calling 
     * stop immediately after initialization. */
@@ -93,11 +98,16 @@ static void audio_thread_loop(void *data)
       }
 
       slock_unlock(thr->lock);
+
+      rarch_perf_trace_begin("audio_callback");
       global->system.audio_callback.callback();
+      rarch_perf_trace_end("audio_callback");
    }
 
    RARCH_LOG("[Audio Thread]: Tearing down driver.\n");
    thr->driver->free(thr->driver_data);
+
+   rarch_perf_thread_exit();
 }
 
 static void audio_thread_block(audio_thread_t *thr)
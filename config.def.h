@@ -393,6 +393,12 @@ static const unsigned hard_sync_frames = 0;
  */
 static const unsigned frame_delay = 0;
 
+/* Picks the frame delay automatically from how long the core 
+ * has been taking per frame, backing off when a VSync is missed. 
+ * A non-zero frame_delay then acts as the upper bound.
+ */
+static const bool frame_delay_auto = false;
+
 /* Inserts a black frame inbetween frames.
  * Useful for 120 Hz monitors who want to play 60 Hz material with eliminated 
  * ghosting. video_refresh_rate should still be configured as if it 
@@ -588,6 +594,15 @@ static const unsigned rewind_buffer_size = 20 << 20; /* 20MiB */
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
+/* How many frames to run ahead of the frame being shown, 
+ * hiding the core's own input lag. Needs save state support 
+ * and that many extra frames of CPU time. 0 disables. */
+static const unsigned run_ahead_frames = 0;
+
+/* Runs the core on its own thread, so the frontend's work 
+ * doesn't eat into the frame. Adds a frame of latency. */
+static const bool emulation_threaded = false;
+
 /* Pause gameplay when gameplay loses focus. */
 static const bool pause_nonactive = false;
 
@@ -625,6 +640,11 @@ static const float fastforward_ratio = 1.0;
 /* Throttle fast forward. */
 static const bool fastforward_ratio_throttle_enable = false;
 
+/* Present only every Nth frame while fast forwarding, the 
+ * others skip video and audio processing. 0 presents at the 
+ * display's refresh rate. */
+static const unsigned fastforward_frameskip = 1;
+
 /* Enable stdin/network command interface. */
 static const bool network_cmd_enable = false;
 static const uint16_t network_cmd_port = 55355;
@@ -441,6 +441,7 @@ static void config_set_defaults(void)
    settings->video.hard_sync             = hard_sync;
    settings->video.hard_sync_frames      = hard_sync_frames;
    settings->video.frame_delay           = frame_delay;
+   settings->video.frame_delay_auto      = frame_delay_auto;
    settings->video.black_frame_insertion = black_frame_insertion;
    settings->video.swap_interval         = swap_interval;
    settings->video.threaded              = video_threaded;
@@ -510,9 +511,12 @@ static void config_set_defaults(void)
    settings->rewind_enable = rewind_enable;
    settings->rewind_buffer_size = rewind_buffer_size;
    settings->rewind_granularity = rewind_granularity;
+   settings->run_ahead_frames = run_ahead_frames;
+   settings->emulation_threaded = emulation_threaded;
    settings->slowmotion_ratio = slowmotion_ratio;
    settings->fastforward_ratio = fastforward_ratio;
    settings->fastforward_ratio_throttle_enable = fastforward_ratio_throttle_enable;
+   settings->fastforward_frameskip = fastforward_frameskip;
    settings->pause_nonactive = pause_nonactive;
    settings->autosave_interval = autosave_interval;
 
@@ -1187,6 +1191,8 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_INT_BASE(conf, settings, video.frame_delay, "video_frame_delay");
    if (settings->video.frame_delay > 15)
       settings->video.frame_delay = 15;
+   CONFIG_GET_BOOL_BASE(conf, settings, video.frame_delay_auto,
+         "video_frame_delay_auto");
 
    CONFIG_GET_BOOL_BASE(conf, settings, video.black_frame_insertion, "video_black_frame_insertion");
    CONFIG_GET_INT_BASE(conf, settings, video.swap_interval, "video_swap_interval");
@@ -1413,6 +1419,7 @@ static bool config_load_file(const char *path, bool set_defaults)
       CONFIG_GET_BOOL_BASE(conf, global, verbosity, "log_verbosity");
 
    CONFIG_GET_BOOL_BASE(conf, global, perfcnt_enable, "perfcnt_enable");
+   CONFIG_GET_BOOL_BASE(conf, global, perfcnt_hw_enable, "perfcnt_hw_enable");
 
    CONFIG_GET_INT_BASE(conf, settings, archive.mode, "archive_mode");
 
@@ -1441,6 +1448,10 @@ static bool config_load_file(const char *path, bool set_defaults)
       settings->rewind_buffer_size = buffer_size * UINT64_C(1000000);
 
    CONFIG_GET_INT_BASE(conf, settings, rewind_granularity, "rewind_granularity");
+   CONFIG_GET_INT_BASE(conf, settings, run_ahead_frames, "run_ahead_frames");
+   if (settings->run_ahead_frames > 6)
+      settings->run_ahead_frames = 6;
+   CONFIG_GET_BOOL_BASE(conf, settings, emulation_threaded, "emulation_threaded");
    CONFIG_GET_FLOAT_BASE(conf, settings, slowmotion_ratio, "slowmotion_ratio");
    if (settings->slowmotion_ratio < 1.0f)
       settings->slowmotion_ratio = 1.0f;
@@ -1453,6 +1464,7 @@ static bool config_load_file(const char *path, bool set_defaults)
       settings->fastforward_ratio = 1.0f;
 
    CONFIG_GET_BOOL_BASE(conf, settings, fastforward_ratio_throttle_enable, "fastforward_ratio_throttle_enable");
+   CONFIG_GET_INT_BASE(conf, settings, fastforward_frameskip, "fastforward_frameskip");
 
    CONFIG_GET_BOOL_BASE(conf, settings, pause_nonactive, "pause_nonactive");
    CONFIG_GET_INT_BASE(conf, settings, autosave_interval, "autosave_interval");
@@ -2164,6 +2176,8 @@ bool config_save_file(const char *path)
    config_set_bool(conf,  "audio_sync",    settings->audio.sync);
    config_set_int(conf,   "audio_block_frames", settings->audio.block_frames);
    config_set_int(conf,   "rewind_granularity", settings->rewind_granularity);
+   config_set_int(conf,   "run_ahead_frames", settings->run_ahead_frames);
+   config_set_bool(conf,  "emulation_threaded", settings->emulation_threaded);
    config_set_path(conf,  "video_shader", settings->video.shader_path);
    config_set_bool(conf,  "video_shader_enable",
          settings->video.shader_enable);
@@ -2209,6 +2223,8 @@ bool config_save_file(const char *path)
    config_set_int(conf,   "video_hard_sync_frames",
          settings->video.hard_sync_frames);
    config_set_int(conf,   "video_frame_delay", settings->video.frame_delay);
+   config_set_bool(conf,  "video_frame_delay_auto",
+         settings->video.frame_delay_auto);
    config_set_bool(conf,  "video_black_frame_insertion",
          settings->video.black_frame_insertion);
    config_set_bool(conf,  "video_disable_composition",
@@ -2378,6 +2394,7 @@ bool config_save_file(const char *path)
 
    config_set_float(conf, "fastforward_ratio", settings->fastforward_ratio);
    config_set_bool(conf, "fastforward_ratio_throttle_enable", settings->fastforward_ratio_throttle_enable);
+   config_set_int(conf, "fastforward_frameskip", settings->fastforward_frameskip);
    config_set_float(conf, "slowmotion_ratio", settings->slowmotion_ratio);
 
    config_set_bool(conf, "config_save_on_exit",
@@ -2426,6 +2443,7 @@ bool config_save_file(const char *path)
    config_set_int(conf, "libretro_log_level", settings->libretro_log_level);
    config_set_bool(conf, "log_verbosity", global->verbosity);
    config_set_bool(conf, "perfcnt_enable", global->perfcnt_enable);
+   config_set_bool(conf, "perfcnt_hw_enable", global->perfcnt_hw_enable);
 
    config_set_int(conf, "archive_mode", settings->archive.mode);
 
@@ -49,6 +49,7 @@ typedef struct settings
       unsigned swap_interval;
       unsigned hard_sync_frames;
       unsigned frame_delay;
+      bool frame_delay_auto;
 #ifdef GEKKO
       unsigned viwidth;
       bool vfilter;
@@ -274,10 +275,13 @@ typedef struct settings
    bool rewind_enable;
    size_t rewind_buffer_size;
    unsigned rewind_granularity;
+   unsigned run_ahead_frames;
+   bool emulation_threaded;
 
    float slowmotion_ratio;
    float fastforward_ratio;
    bool fastforward_ratio_throttle_enable;
+   unsigned fastforward_frameskip;
 
    bool pause_nonactive;
    unsigned autosave_interval;
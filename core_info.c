@@ -17,97 +17,739 @@
 
 #include "core_info.h"
 #include "general.h"
+#include "performance.h"
 #include <file/file_path.h>
 #include "file_ext.h"
 #include <file/file_extract.h>
 #include <file/dir_list.h>
+#include <ctype.h>
 #include "config.def.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if !defined(RARCH_CONSOLE)
+#define HAVE_CORE_INFO_CACHE
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+#define CORE_INFO_MAX_WORKERS 8
+
+/* Maps a file extension to the sorted list indices of the
+ * cores that support it. */
+struct core_info_ext_entry
+{
+   const char *ext;
+   size_t *cores;
+   size_t count;
+   size_t cap;
+};
+
+struct core_info_ext_map
+{
+   struct core_info_ext_entry *entries;
+   size_t size;
+   /* Scratch space for core_info_list_get_supported_cores. */
+   core_info_t *supported;
+   size_t *picked;
+   uint8_t *marks;
+};
+
+/* Extensions compare case-insensitively, with or without a leading dot. */
+static uint32_t core_info_ext_hash(const char *ext)
+{
+   uint32_t hash = 5381;
+
+   while (*ext)
+      hash = (hash << 5) + hash + (uint8_t)tolower((uint8_t)*ext++);
+
+   return hash;
+}
+
+static struct core_info_ext_entry *core_info_ext_find(
+      const struct core_info_ext_map *map, const char *ext, bool insert)
+{
+   size_t mask, pos;
+
+   if (!map || !ext)
+      return NULL;
+
+   if (*ext == '.')
+      ext++;
+   if (!*ext)
+      return NULL;
+
+   mask = map->size - 1;
+
+   for (pos = core_info_ext_hash(ext) & mask; ; pos = (pos + 1) & mask)
+   {
+      struct core_info_ext_entry *entry = &map->entries[pos];
+
+      if (!entry->ext)
+      {
+         if (!insert)
+            return NULL;
+         entry->ext = ext;
+         return entry;
+      }
+
+      if (!strcasecmp(entry->ext, ext))
+         return entry;
+   }
+}
+
+static bool core_info_ext_add_core(struct core_info_ext_entry *entry,
+      size_t core)
+{
+   /* Cores are added in list order, skip repeated extensions. */
+   if (entry->count && entry->cores[entry->count - 1] == core)
+      return true;
+
+   if (entry->count == entry->cap)
+   {
+      size_t cap    = entry->cap ? entry->cap * 2 : 4;
+      size_t *cores = (size_t*)realloc(entry->cores, cap * sizeof(*cores));
+
+      if (!cores)
+         return false;
+
+      entry->cores = cores;
+      entry->cap   = cap;
+   }
+
+   entry->cores[entry->count++] = core;
+   return true;
+}
+
+static bool core_info_ext_has_core(const struct core_info_ext_map *map,
+      const char *ext, size_t core)
+{
+   size_t lo = 0, hi;
+   const struct core_info_ext_entry *entry =
+      core_info_ext_find(map, ext, false);
+
+   if (!entry)
+      return false;
+
+   for (hi = entry->count; lo < hi; )
+   {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (entry->cores[mid] == core)
+         return true;
+      if (entry->cores[mid] < core)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return false;
+}
+
+static void core_info_ext_map_free(struct core_info_ext_map *map)
+{
+   size_t i;
+
+   if (!map)
+      return;
+
+   for (i = 0; i < map->size; i++)
+      free(map->entries[i].cores);
+
+   free(map->entries);
+   free(map->supported);
+   free(map->picked);
+   free(map->marks);
+   free(map);
+}
+
+static int core_info_display_name_cmp(const void *a_, const void *b_)
+{
+   const core_info_t *a = (const core_info_t*)a_;
+   const core_info_t *b = (const core_info_t*)b_;
+   int order            = strcasecmp(a->display_name, b->display_name);
+
+   if (order)
+      return order;
+   return strcmp(a->path, b->path);
+}
+
+static int core_info_index_cmp(const void *a_, const void *b_)
+{
+   size_t a = *(const size_t*)a_;
+   size_t b = *(const size_t*)b_;
+
+   return (a > b) - (a < b);
+}
+
 static void core_info_list_resolve_all_extensions(
       core_info_list_t *core_info_list)
 {
-   size_t i, all_ext_len = 0;
+   size_t i, j, all_ext_len = 0, all_ext_pos = 0, ext_count = 0;
+   struct core_info_ext_map *map = NULL;
 
    if (!core_info_list)
       return;
 
+   /* Cores are listed by name, so are the per-extension core lists. */
+   qsort(core_info_list->list, core_info_list->count,
+         sizeof(core_info_t), core_info_display_name_cmp);
+
    for (i = 0; i < core_info_list->count; i++)
    {
-      if (core_info_list->list[i].supported_extensions)
-         all_ext_len += 
-            (strlen(core_info_list->list[i].supported_extensions) + 2);
+      const core_info_t *info = &core_info_list->list[i];
+
+      if (info->supported_extensions)
+         all_ext_len += strlen(info->supported_extensions) + 2;
+      if (info->supported_extensions_list)
+         ext_count   += info->supported_extensions_list->size;
    }
 
    if (all_ext_len)
       core_info_list->all_ext = (char*)calloc(1, all_ext_len);
 
-   if (!core_info_list->all_ext)
+   if (core_info_list->all_ext)
+   {
+      for (i = 0; i < core_info_list->count; i++)
+      {
+         const char *exts = core_info_list->list[i].supported_extensions;
+         size_t len;
+
+         if (!exts)
+            continue;
+
+         len = strlen(exts);
+         memcpy(core_info_list->all_ext + all_ext_pos, exts, len);
+         all_ext_pos += len;
+         core_info_list->all_ext[all_ext_pos++] = '|';
+      }
+   }
+
+   map = (struct core_info_ext_map*)calloc(1, sizeof(*map));
+   if (!map)
       return;
 
+   for (map->size = 16; map->size < ext_count * 2; )
+      map->size *= 2;
+
+   map->entries   = (struct core_info_ext_entry*)
+      calloc(map->size, sizeof(*map->entries));
+   map->supported = (core_info_t*)
+      calloc(core_info_list->count + 1, sizeof(*map->supported));
+   map->picked    = (size_t*)
+      calloc(core_info_list->count + 1, sizeof(*map->picked));
+   map->marks     = (uint8_t*)calloc(core_info_list->count + 1, 1);
+
+   if (!map->entries || !map->supported || !map->picked || !map->marks)
+      goto error;
+
    for (i = 0; i < core_info_list->count; i++)
    {
-      if (!core_info_list->list[i].supported_extensions)
-         continue;
+      core_info_t *info                = &core_info_list->list[i];
+      const struct string_list *exts   = info->supported_extensions_list;
 
-      strlcat(core_info_list->all_ext,
-            core_info_list->list[i].supported_extensions, all_ext_len);
-      strlcat(core_info_list->all_ext, "|", all_ext_len);
+      info->ext_map    = map;
+      info->list_index = i;
+
+      for (j = 0; exts && j < exts->size; j++)
+      {
+         struct core_info_ext_entry *entry =
+            core_info_ext_find(map, exts->elems[j].data, true);
+
+         if (entry && !core_info_ext_add_core(entry, i))
+            goto error;
+      }
    }
+
+   core_info_list->ext_map = map;
+   return;
+
+error:
+   for (i = 0; i < core_info_list->count; i++)
+      core_info_list->list[i].ext_map = NULL;
+   core_info_ext_map_free(map);
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+/* Parses one .info file, leaves info untouched if there is none. */
+static void core_info_parse(core_info_t *info, const char *info_path)
 {
+   unsigned c, count   = 0;
+   config_file_t *conf = config_file_new(info_path);
+
+   if (!conf)
+      return;
+
+   info->has_info = true;
+
+   config_get_string(conf, "display_name",         &info->display_name);
+   config_get_string(conf, "corename",             &info->core_name);
+   config_get_string(conf, "systemname",           &info->systemname);
+   config_get_string(conf, "manufacturer",         &info->system_manufacturer);
+   config_get_string(conf, "supported_extensions", &info->supported_extensions);
+   config_get_string(conf, "authors",              &info->authors);
+   config_get_string(conf, "permissions",          &info->permissions);
+   config_get_string(conf, "license",              &info->licenses);
+   config_get_string(conf, "categories",           &info->categories);
+   config_get_string(conf, "database",             &info->databases);
+   config_get_string(conf, "notes",                &info->notes);
+   config_get_bool(conf,   "supports_no_game",     &info->supports_no_game);
+
+   if (config_get_uint(conf, "firmware_count", &count) && count)
+   {
+      info->firmware = (core_info_firmware_t*)
+         calloc(count, sizeof(*info->firmware));
+
+      if (info->firmware)
+         info->firmware_count = count;
+   }
+
+   for (c = 0; c < info->firmware_count; c++)
+   {
+      char path_key[64], desc_key[64], opt_key[64];
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+
+      config_get_string(conf, path_key, &info->firmware[c].path);
+      config_get_string(conf, desc_key, &info->firmware[c].desc);
+      config_get_bool(conf, opt_key , &info->firmware[c].optional);
+   }
+
+   config_file_free(conf);
+}
+
+static void core_info_split_lists(core_info_t *info)
+{
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+         string_split(info->supported_extensions, "|");
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+   if (info->databases)
+      info->databases_list   = string_split(info->databases, "|");
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+
+   if (!info->display_name)
+      info->display_name = strdup(path_basename(info->path));
+}
+
+typedef struct core_info_job
+{
+   core_info_t *info;
+   char info_path[PATH_MAX_LENGTH];
+   int64_t mtime;
+   int64_t size;
+   bool cached;
+} core_info_job_t;
+
+typedef struct core_info_queue
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   core_info_job_t *jobs;
+   size_t count;
+   size_t next;
+} core_info_queue_t;
+
+static void core_info_worker(void *data)
+{
+   core_info_queue_t *queue = (core_info_queue_t*)data;
+
+   for (;;)
+   {
+      core_info_job_t *job = NULL;
+
+#ifdef HAVE_THREADS
+      if (queue->lock)
+         slock_lock(queue->lock);
+#endif
+      if (queue->next < queue->count)
+         job = &queue->jobs[queue->next++];
+#ifdef HAVE_THREADS
+      if (queue->lock)
+         slock_unlock(queue->lock);
+#endif
+
+      if (!job)
+         break;
+
+      if (!job->cached)
+         core_info_parse(job->info, job->info_path);
+      core_info_split_lists(job->info);
+   }
+}
+
+#ifdef HAVE_THREADS
+static unsigned core_info_worker_count(size_t jobs)
+{
+   unsigned cores = rarch_get_cpu_cores();
+
+   if (cores > CORE_INFO_MAX_WORKERS)
+      cores = CORE_INFO_MAX_WORKERS;
+   if (cores > jobs)
+      cores = jobs;
+   if (cores < 1)
+      cores = 1;
+   return cores;
+}
+#endif
+
+static void core_info_run_jobs(core_info_job_t *jobs, size_t count)
+{
+   core_info_queue_t queue;
+#ifdef HAVE_THREADS
    size_t i;
-   unsigned c;
+   sthread_t **workers = NULL;
+   unsigned threads    = core_info_worker_count(count) - 1;
+
+   queue.lock = slock_new();
+
+   /* Without a lock, everything runs on this thread. */
+   if (!queue.lock)
+      threads = 0;
+   if (threads)
+      workers = (sthread_t**)calloc(threads, sizeof(*workers));
+   if (!workers)
+      threads = 0;
+#endif
 
-   if (!core_info_list)
+   queue.jobs  = jobs;
+   queue.count = count;
+   queue.next  = 0;
+
+#ifdef HAVE_THREADS
+   for (i = 0; i < threads; i++)
+      workers[i] = sthread_create(core_info_worker, &queue);
+#endif
+
+   /* The calling thread works the queue too, which also covers
+    * the case where no threads could be created. */
+   core_info_worker(&queue);
+
+#ifdef HAVE_THREADS
+   for (i = 0; i < threads; i++)
+      if (workers[i])
+         sthread_join(workers[i]);
+
+   free(workers);
+   if (queue.lock)
+      slock_free(queue.lock);
+#endif
+}
+
+#ifdef HAVE_CORE_INFO_CACHE
+/* Binary cache of parsed .info files, stored next to the config file
+ * since the info directory is often read-only. The cache is dropped
+ * when it was built from another info directory. An entry is reused
+ * if its core path, and the modification time and size of its .info
+ * file, match. Missing .info files are cached as well so they are not
+ * probed again on every start. */
+
+#define CORE_INFO_CACHE_FILE    "core_info.cache"
+#define CORE_INFO_CACHE_MAGIC   0x43494152 /* "RAIC" */
+#define CORE_INFO_CACHE_VERSION 2
+#define CORE_INFO_CACHE_NULL    0xffffffff
+
+typedef struct core_info_cache_reader
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+   bool error;
+} core_info_cache_reader_t;
+
+static bool core_info_stat(const char *path, int64_t *mtime, int64_t *size)
+{
+   struct stat st;
+
+   if (stat(path, &st) != 0)
+      return false;
+
+   *mtime = st.st_mtime;
+   *size  = st.st_size;
+   return true;
+}
+
+static void core_info_cache_read(core_info_cache_reader_t *reader,
+      void *data, size_t len)
+{
+   if (reader->error || (size_t)(reader->end - reader->ptr) < len)
+   {
+      reader->error = true;
+      memset(data, 0, len);
       return;
+   }
 
-   for (i = 0; i < core_info_list->count; i++)
+   memcpy(data, reader->ptr, len);
+   reader->ptr += len;
+}
+
+static char *core_info_cache_read_string(core_info_cache_reader_t *reader)
+{
+   uint32_t len;
+   char *str = NULL;
+
+   core_info_cache_read(reader, &len, sizeof(len));
+
+   if (reader->error || len == CORE_INFO_CACHE_NULL)
+      return NULL;
+
+   if ((size_t)(reader->end - reader->ptr) < len
+         || !(str = (char*)malloc(len + 1)))
    {
-      unsigned count    = 0;
-      core_info_t *info = (core_info_t*)&core_info_list->list[i];
+      reader->error = true;
+      return NULL;
+   }
 
-      if (!info || !info->data)
-         continue;
+   memcpy(str, reader->ptr, len);
+   str[len]     = '\0';
+   reader->ptr += len;
+   return str;
+}
 
-      if (!config_get_uint(info->data, "firmware_count", &count))
-         continue;
+static void core_info_cache_write_string(FILE *file, const char *str)
+{
+   uint32_t len = str ? strlen(str) : CORE_INFO_CACHE_NULL;
 
-      info->firmware = (core_info_firmware_t*)
-         calloc(count, sizeof(*info->firmware));
+   fwrite(&len, sizeof(len), 1, file);
+   if (str)
+      fwrite(str, 1, len, file);
+}
 
-      if (!info->firmware)
-         continue;
+static void core_info_cache_read_entry(core_info_cache_reader_t *reader,
+      core_info_t *info, int64_t *mtime, int64_t *size)
+{
+   uint8_t flags = 0;
+   uint32_t c, count = 0;
+
+   info->path                = core_info_cache_read_string(reader);
+   core_info_cache_read(reader, mtime, sizeof(*mtime));
+   core_info_cache_read(reader, size, sizeof(*size));
+   core_info_cache_read(reader, &flags, sizeof(flags));
+   info->has_info            = flags & 1;
+   info->supports_no_game    = (flags >> 1) & 1;
+   info->display_name        = core_info_cache_read_string(reader);
+   info->core_name           = core_info_cache_read_string(reader);
+   info->systemname          = core_info_cache_read_string(reader);
+   info->system_manufacturer = core_info_cache_read_string(reader);
+   info->supported_extensions= core_info_cache_read_string(reader);
+   info->authors             = core_info_cache_read_string(reader);
+   info->permissions         = core_info_cache_read_string(reader);
+   info->licenses            = core_info_cache_read_string(reader);
+   info->categories          = core_info_cache_read_string(reader);
+   info->databases           = core_info_cache_read_string(reader);
+   info->notes               = core_info_cache_read_string(reader);
+   core_info_cache_read(reader, &count, sizeof(count));
+
+   if (reader->error || !count)
+      return;
+
+   if ((size_t)(reader->end - reader->ptr) < count * 9
+         || !(info->firmware = (core_info_firmware_t*)
+            calloc(count, sizeof(*info->firmware))))
+   {
+      reader->error = true;
+      return;
+   }
+
+   info->firmware_count = count;
 
-      for (c = 0; c < count; c++)
+   for (c = 0; c < count; c++)
+   {
+      info->firmware[c].path     = core_info_cache_read_string(reader);
+      info->firmware[c].desc     = core_info_cache_read_string(reader);
+      core_info_cache_read(reader, &flags, sizeof(flags));
+      info->firmware[c].optional = flags & 1;
+   }
+}
+
+static void core_info_cache_write_entry(FILE *file,
+      const core_info_job_t *job)
+{
+   size_t c;
+   uint32_t count          = job->info->firmware_count;
+   const core_info_t *info = job->info;
+   uint8_t flags           = info->has_info | (info->supports_no_game << 1);
+
+   core_info_cache_write_string(file, info->path);
+   fwrite(&job->mtime, sizeof(job->mtime), 1, file);
+   fwrite(&job->size, sizeof(job->size), 1, file);
+   fwrite(&flags, sizeof(flags), 1, file);
+   core_info_cache_write_string(file, info->display_name);
+   core_info_cache_write_string(file, info->core_name);
+   core_info_cache_write_string(file, info->systemname);
+   core_info_cache_write_string(file, info->system_manufacturer);
+   core_info_cache_write_string(file, info->supported_extensions);
+   core_info_cache_write_string(file, info->authors);
+   core_info_cache_write_string(file, info->permissions);
+   core_info_cache_write_string(file, info->licenses);
+   core_info_cache_write_string(file, info->categories);
+   core_info_cache_write_string(file, info->databases);
+   core_info_cache_write_string(file, info->notes);
+   fwrite(&count, sizeof(count), 1, file);
+
+   for (c = 0; c < count; c++)
+   {
+      flags = info->firmware[c].optional;
+      core_info_cache_write_string(file, info->firmware[c].path);
+      core_info_cache_write_string(file, info->firmware[c].desc);
+      fwrite(&flags, sizeof(flags), 1, file);
+   }
+}
+
+static void core_info_free_entry(core_info_t *info);
+
+/* Fills jobs from the cache. Returns the number of reused entries. */
+static size_t core_info_cache_load(const char *path, const char *info_dir,
+      core_info_job_t *jobs, size_t count, size_t *cached_count)
+{
+   long len;
+   uint32_t header[3];
+   size_t i, hint = 0, hits = 0;
+   char *cached_dir = NULL;
+   uint8_t *buf = NULL;
+   FILE *file   = fopen(path, "rb");
+   core_info_cache_reader_t reader = {0};
+
+   *cached_count = 0;
+
+   if (!file)
+      return 0;
+
+   if (fseek(file, 0, SEEK_END) != 0 || (len = ftell(file)) <= 0
+         || fseek(file, 0, SEEK_SET) != 0
+         || !(buf = (uint8_t*)malloc(len))
+         || fread(buf, 1, len, file) != (size_t)len)
+      goto end;
+
+   reader.ptr = buf;
+   reader.end = buf + len;
+
+   core_info_cache_read(&reader, header, sizeof(header));
+   if (reader.error || header[0] != CORE_INFO_CACHE_MAGIC
+         || header[1] != CORE_INFO_CACHE_VERSION)
+      goto end;
+
+   cached_dir = core_info_cache_read_string(&reader);
+   if (reader.error || !cached_dir || strcmp(cached_dir, info_dir))
+      goto end;
+
+   for (i = 0; i < header[2]; i++)
+   {
+      size_t j;
+      int64_t mtime, size;
+      core_info_t entry      = {0};
+      core_info_job_t *match = NULL;
+
+      core_info_cache_read_entry(&reader, &entry, &mtime, &size);
+
+      if (reader.error || !entry.path)
       {
-         char path_key[64], desc_key[64], opt_key[64];
+         core_info_free_entry(&entry);
+         break;
+      }
+
+      (*cached_count)++;
 
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+      /* Cores are usually listed in the same order as last time. */
+      for (j = 0; j < count && !match; j++, hint++)
+      {
+         if (hint >= count)
+            hint = 0;
+         if (!strcmp(jobs[hint].info->path, entry.path))
+            match = &jobs[hint];
+      }
 
-         config_get_string(info->data, path_key, &info->firmware[c].path);
-         config_get_string(info->data, desc_key, &info->firmware[c].desc);
-         config_get_bool(info->data, opt_key , &info->firmware[c].optional);
+      if (!match || match->cached
+            || match->mtime != mtime || match->size != size)
+      {
+         core_info_free_entry(&entry);
+         continue;
       }
+
+      free(entry.path);
+      entry.path    = match->info->path;
+      *match->info  = entry;
+      match->cached = true;
+      hits++;
+   }
+
+end:
+   free(cached_dir);
+   free(buf);
+   fclose(file);
+   return hits;
+}
+
+static void core_info_cache_save(const char *path, const char *info_dir,
+      const core_info_job_t *jobs, size_t count)
+{
+   size_t i;
+   uint32_t header[3];
+   FILE *file = fopen(path, "wb");
+
+   if (!file)
+   {
+      RARCH_WARN("Could not write core info cache \"%s\".\n", path);
+      return;
    }
+
+   header[0] = CORE_INFO_CACHE_MAGIC;
+   header[1] = CORE_INFO_CACHE_VERSION;
+   header[2] = count;
+   fwrite(header, sizeof(header), 1, file);
+   core_info_cache_write_string(file, info_dir);
+
+   for (i = 0; i < count; i++)
+      core_info_cache_write_entry(file, &jobs[i]);
+
+   fclose(file);
 }
 
+/* Returns false when there is no config file to put the cache next to. */
+static bool core_info_cache_path(char *path, size_t size)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global || !*global->config_path)
+      return false;
+
+   fill_pathname_resolve_relative(path, global->config_path,
+         CORE_INFO_CACHE_FILE, size);
+   return true;
+}
+#endif
+
 core_info_list_t *core_info_list_new(const char *modules_path)
 {
    size_t i;
    core_info_t *core_info = NULL;
+   core_info_job_t *jobs  = NULL;
    core_info_list_t *core_info_list = NULL;
    settings_t *settings = config_get_ptr();
+   const char *info_dir = (*settings->libretro_info_path) ?
+      settings->libretro_info_path : modules_path;
    struct string_list *contents = (struct string_list*)
       dir_list_new(modules_path, EXT_EXECUTABLES, false);
+#ifdef HAVE_CORE_INFO_CACHE
+   char cache_path[PATH_MAX_LENGTH];
+   bool has_cache = core_info_cache_path(cache_path, sizeof(cache_path));
+   size_t hits = 0, cached_count = 0;
+#endif
 
    if (!contents)
       return NULL;
@@ -120,16 +762,20 @@ core_info_list_t *core_info_list_new(const char *modules_path)
    if (!core_info)
       goto error;
 
+   jobs = (core_info_job_t*)calloc(contents->size, sizeof(*jobs));
+   if (!jobs)
+      goto error;
+
    core_info_list->list = core_info;
    core_info_list->count = contents->size;
 
    for (i = 0; i < contents->size; i++)
    {
-      char info_path_base[PATH_MAX_LENGTH], info_path[PATH_MAX_LENGTH];
+      char info_path_base[PATH_MAX_LENGTH];
       core_info[i].path = strdup(contents->elems[i].data);
 
       if (!core_info[i].path)
-         break;
+         goto error;
 
       fill_pathname_base(info_path_base, contents->elems[i].data,
             sizeof(info_path_base));
@@ -143,130 +789,90 @@ core_info_list_t *core_info_list_new(const char *modules_path)
 
       strlcat(info_path_base, ".info", sizeof(info_path_base));
 
-      fill_pathname_join(info_path, (*settings->libretro_info_path) ?
-            settings->libretro_info_path : modules_path,
-            info_path_base, sizeof(info_path));
+      jobs[i].info = &core_info[i];
+      fill_pathname_join(jobs[i].info_path, info_dir,
+            info_path_base, sizeof(jobs[i].info_path));
+#ifdef HAVE_CORE_INFO_CACHE
+      if (!core_info_stat(jobs[i].info_path, &jobs[i].mtime, &jobs[i].size))
+         jobs[i].mtime = jobs[i].size = -1;
+#endif
+   }
 
-      core_info[i].data = config_file_new(info_path);
+#ifdef HAVE_CORE_INFO_CACHE
+   if (has_cache)
+      hits = core_info_cache_load(cache_path, info_dir, jobs,
+            contents->size, &cached_count);
+#endif
 
-      if (core_info[i].data)
-      {
-         unsigned count = 0;
-         config_get_string(core_info[i].data, "display_name",
-               &core_info[i].display_name);
-         config_get_string(core_info[i].data, "corename",
-               &core_info[i].core_name);
-         config_get_string(core_info[i].data, "systemname",
-               &core_info[i].systemname);
-         config_get_string(core_info[i].data, "manufacturer",
-               &core_info[i].system_manufacturer);
-         config_get_uint(core_info[i].data, "firmware_count", &count);
-         core_info[i].firmware_count = count;
-         if (config_get_string(core_info[i].data, "supported_extensions",
-                  &core_info[i].supported_extensions) &&
-               core_info[i].supported_extensions)
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
-
-         if (config_get_string(core_info[i].data, "authors",
-                  &core_info[i].authors) &&
-               core_info[i].authors)
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
-
-         if (config_get_string(core_info[i].data, "permissions",
-                  &core_info[i].permissions) &&
-               core_info[i].permissions)
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
-
-         if (config_get_string(core_info[i].data, "license",
-                  &core_info[i].licenses) &&
-               core_info[i].licenses)
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
-
-         if (config_get_string(core_info[i].data, "categories",
-                  &core_info[i].categories) &&
-               core_info[i].categories)
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
-
-         if (config_get_string(core_info[i].data, "database",
-                  &core_info[i].databases) &&
-               core_info[i].databases)
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
-
-         if (config_get_string(core_info[i].data, "notes",
-                  &core_info[i].notes) &&
-               core_info[i].notes)
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
-
-         config_get_bool(core_info[i].data, "supports_no_game",
-               &core_info[i].supports_no_game);
-      }
+   core_info_run_jobs(jobs, contents->size);
 
-      if (!core_info[i].display_name)
-         core_info[i].display_name = strdup(path_basename(core_info[i].path));
-   }
+#ifdef HAVE_CORE_INFO_CACHE
+   RARCH_LOG("Core info: %u of %u cores from cache.\n",
+         (unsigned)hits, (unsigned)contents->size);
+
+   if (has_cache && (hits != contents->size
+            || cached_count != contents->size))
+      core_info_cache_save(cache_path, info_dir, jobs, contents->size);
+#endif
 
    core_info_list_resolve_all_extensions(core_info_list);
-   core_info_list_resolve_all_firmware(core_info_list);
 
+   free(jobs);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   free(jobs);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
    return NULL;
 }
 
+static void core_info_free_entry(core_info_t *info)
+{
+   size_t j;
+
+   free(info->path);
+   free(info->core_name);
+   free(info->systemname);
+   free(info->system_manufacturer);
+   free(info->display_name);
+   free(info->supported_extensions);
+   free(info->authors);
+   free(info->permissions);
+   free(info->licenses);
+   free(info->categories);
+   free(info->databases);
+   free(info->notes);
+   if (info->supported_extensions_list)
+      string_list_free(info->supported_extensions_list);
+   string_list_free(info->authors_list);
+   string_list_free(info->note_list);
+   string_list_free(info->permissions_list);
+   string_list_free(info->licenses_list);
+   string_list_free(info->categories_list);
+   string_list_free(info->databases_list);
+
+   for (j = 0; j < info->firmware_count; j++)
+   {
+      free(info->firmware[j].path);
+      free(info->firmware[j].desc);
+   }
+   free(info->firmware);
+}
+
 void core_info_list_free(core_info_list_t *core_info_list)
 {
-   size_t i, j;
+   size_t i;
 
    if (!core_info_list)
       return;
 
    for (i = 0; i < core_info_list->count; i++)
-   {
-      core_info_t *info = (core_info_t*)&core_info_list->list[i];
-
-      if (!info)
-         continue;
-
-      free(info->path);
-      free(info->systemname);
-      free(info->system_manufacturer);
-      free(info->display_name);
-      free(info->supported_extensions);
-      free(info->authors);
-      free(info->permissions);
-      free(info->licenses);
-      free(info->categories);
-      free(info->databases);
-      free(info->notes);
-      if (info->supported_extensions_list)
-         string_list_free(info->supported_extensions_list);
-      string_list_free(info->authors_list);
-      string_list_free(info->note_list);
-      string_list_free(info->permissions_list);
-      string_list_free(info->licenses_list);
-      string_list_free(info->categories_list);
-      string_list_free(info->databases_list);
-      config_file_free(info->data);
-
-      for (j = 0; j < info->firmware_count; j++)
-      {
-         free(info->firmware[j].path);
-         free(info->firmware[j].desc);
-      }
-      free(info->firmware);
-   }
+      core_info_free_entry(&core_info_list->list[i]);
 
+   core_info_ext_map_free(core_info_list->ext_map);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -280,7 +886,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-      num += !!core_info_list->list[i].data;
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -347,6 +953,11 @@ bool core_info_does_support_file(const core_info_t *core, const char *path)
 {
    if (!path || !core || !core->supported_extensions_list)
       return false;
+
+   if (core->ext_map)
+      return core_info_ext_has_core(core->ext_map,
+            path_get_extension(path), core->list_index);
+
    return string_list_find_elem_prefix(
          core->supported_extensions_list, ".", path_get_extension(path));
 }
@@ -358,72 +969,72 @@ const char *core_info_list_get_all_extensions(core_info_list_t *core_info_list)
    return core_info_list->all_ext;
 }
 
-/* qsort_r() is not in standard C, sadly. */
-static const char *core_info_tmp_path;
-static const struct string_list *core_info_tmp_list;
-
-static int core_info_qsort_cmp(const void *a_, const void *b_)
+/* Marks every core supporting ext that has not been picked yet. */
+static size_t core_info_pick_ext(struct core_info_ext_map *map,
+      const char *ext, size_t picked)
 {
-   const core_info_t *a = (const core_info_t*)a_;
-   const core_info_t *b = (const core_info_t*)b_;
-   int support_a        = core_info_does_support_any_file(a, core_info_tmp_list) ||
-      core_info_does_support_file(a, core_info_tmp_path);
-   int support_b        = core_info_does_support_any_file(b, core_info_tmp_list) ||
-      core_info_does_support_file(b, core_info_tmp_path);
+   size_t i;
+   const struct core_info_ext_entry *entry =
+      core_info_ext_find(map, ext, false);
 
-   if (support_a != support_b)
-      return support_b - support_a;
-   return strcasecmp(a->display_name, b->display_name);
+   for (i = 0; entry && i < entry->count; i++)
+   {
+      size_t core = entry->cores[i];
+
+      if (map->marks[core])
+         continue;
+
+      map->marks[core]      = 1;
+      map->picked[picked++] = core;
+   }
+
+   return picked;
 }
 
 void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
       const char *path, const core_info_t **infos, size_t *num_infos)
 {
-   struct string_list *list = NULL;
-   size_t supported = 0, i;
+   size_t i, supported = 0;
+   struct core_info_ext_map *map = NULL;
+#ifdef HAVE_ZLIB
+   struct string_list *list      = NULL;
+#endif
 
    if (!core_info_list)
       return;
 
-   (void)list;
+   *infos     = core_info_list->list;
+   *num_infos = 0;
+
+   map = core_info_list->ext_map;
+   if (!map || !path)
+      return;
 
-   core_info_tmp_path = path;
+   supported = core_info_pick_ext(map, path_get_extension(path), 0);
 
 #ifdef HAVE_ZLIB
    if (!strcasecmp(path_get_extension(path), "zip"))
       list = zlib_get_file_list(path, NULL);
-   core_info_tmp_list = list;
-#endif
 
-   /* Let supported core come first in list so we can return 
-    * a pointer to them. */
-   qsort(core_info_list->list, core_info_list->count,
-         sizeof(core_info_t), core_info_qsort_cmp);
-
-   for (i = 0; i < core_info_list->count; i++, supported++)
-   {
-      const core_info_t *core = &core_info_list->list[i];
+   for (i = 0; list && i < list->size; i++)
+      supported = core_info_pick_ext(map,
+            path_get_extension(list->elems[i].data), supported);
 
-      if (!core)
-         continue;
-
-      if (core_info_does_support_file(core, path))
-         continue;
+   if (list)
+      string_list_free(list);
 
-#ifdef HAVE_ZLIB
-      if (core_info_does_support_any_file(core, list))
-         continue;
+   /* Only needed if several extensions got merged. */
+   qsort(map->picked, supported, sizeof(*map->picked), core_info_index_cmp);
 #endif
 
-      break;
+   /* Core indices are sorted by name already. */
+   for (i = 0; i < supported; i++)
+   {
+      map->marks[map->picked[i]] = 0;
+      map->supported[i]          = core_info_list->list[map->picked[i]];
    }
 
-#ifdef HAVE_ZLIB
-   if (list)
-      string_list_free(list);
-#endif
-
-   *infos = core_info_list->list;
+   *infos     = map->supported;
    *num_infos = supported;
 }
 
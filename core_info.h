@@ -25,6 +25,8 @@
 extern "C" {
 #endif
 
+struct core_info_ext_map;
+
 typedef struct
 {
    char *path;
@@ -38,7 +40,6 @@ typedef struct
 typedef struct
 {
    char *path;
-   config_file_t *data;
    char *display_name;
    char *core_name;
    char *system_manufacturer;
@@ -60,8 +61,14 @@ typedef struct
 
    core_info_firmware_t *firmware;
    size_t firmware_count;
+   /* False if the core came without a .info file. */
+   bool has_info;
    bool supports_no_game;
    void *userdata;
+
+   /* Extension index of the owning list, and position in it. */
+   const struct core_info_ext_map *ext_map;
+   size_t list_index;
 } core_info_t;
 
 typedef struct
@@ -69,6 +76,8 @@ typedef struct
    core_info_t *list;
    size_t count;
    char *all_ext;
+   /* Extension -> supporting cores, sorted by display name. */
+   struct core_info_ext_map *ext_map;
 } core_info_list_t;
 
 core_info_list_t *core_info_list_new(const char *modules_path);
@@ -82,7 +91,8 @@ bool core_info_does_support_file(const core_info_t *info,
 bool core_info_does_support_any_file(const core_info_t *info,
       const struct string_list *list);
 
-/* Non-reentrant, does not allocate. Returns pointer to internal state. */
+/* Non-reentrant, does not allocate. Returns pointer to internal state.
+ * Supported cores come sorted by display name. */
 void core_info_list_get_supported_cores(core_info_list_t *list,
       const char *path, const core_info_t **infos, size_t *num_infos);
 
@@ -168,153 +168,404 @@ static char *bin_to_hex_alloc(const uint8_t *data, size_t len)
    return ret;
 }
 
-database_info_list_t *database_info_list_new(const char *rdb_path, const char *query)
+enum database_info_field_type
+{
+   DATABASE_INFO_TYPE_STRING = 0,
+   DATABASE_INFO_TYPE_HEX,
+   DATABASE_INFO_TYPE_UINT,
+   DATABASE_INFO_TYPE_INT
+};
+
+typedef struct
+{
+   const char *key;
+   unsigned field;
+   enum database_info_field_type type;
+   size_t offset;
+} database_info_field_desc_t;
+
+#define DB_FIELD(key, field, type, member) \
+   { key, field, type, offsetof(database_info_t, member) }
+
+/* In enum database_info_field order: entry n is field (1 << n). */
+static const database_info_field_desc_t database_info_fields[] = {
+   DB_FIELD("name",           DATABASE_INFO_FIELD_NAME,                 DATABASE_INFO_TYPE_STRING, name),
+   DB_FIELD("description",    DATABASE_INFO_FIELD_DESCRIPTION,          DATABASE_INFO_TYPE_STRING, description),
+   DB_FIELD("publisher",      DATABASE_INFO_FIELD_PUBLISHER,            DATABASE_INFO_TYPE_STRING, publisher),
+   DB_FIELD("developer",      DATABASE_INFO_FIELD_DEVELOPER,            DATABASE_INFO_TYPE_STRING, developer),
+   DB_FIELD("origin",         DATABASE_INFO_FIELD_ORIGIN,               DATABASE_INFO_TYPE_STRING, origin),
+   DB_FIELD("franchise",      DATABASE_INFO_FIELD_FRANCHISE,            DATABASE_INFO_TYPE_STRING, franchise),
+   DB_FIELD("edge_review",    DATABASE_INFO_FIELD_EDGE_MAGAZINE_REVIEW, DATABASE_INFO_TYPE_STRING, edge_magazine_review),
+   DB_FIELD("bbfc_rating",    DATABASE_INFO_FIELD_BBFC_RATING,          DATABASE_INFO_TYPE_STRING, bbfc_rating),
+   DB_FIELD("elspa_rating",   DATABASE_INFO_FIELD_ELSPA_RATING,         DATABASE_INFO_TYPE_STRING, elspa_rating),
+   DB_FIELD("esrb_rating",    DATABASE_INFO_FIELD_ESRB_RATING,          DATABASE_INFO_TYPE_STRING, esrb_rating),
+   DB_FIELD("pegi_rating",    DATABASE_INFO_FIELD_PEGI_RATING,          DATABASE_INFO_TYPE_STRING, pegi_rating),
+   DB_FIELD("cero_rating",    DATABASE_INFO_FIELD_CERO_RATING,          DATABASE_INFO_TYPE_STRING, cero_rating),
+   DB_FIELD("enhancement_hw", DATABASE_INFO_FIELD_ENHANCEMENT_HW,       DATABASE_INFO_TYPE_STRING, enhancement_hw),
+   DB_FIELD("crc",            DATABASE_INFO_FIELD_CRC32,                DATABASE_INFO_TYPE_HEX,    crc32),
+   DB_FIELD("sha1",           DATABASE_INFO_FIELD_SHA1,                 DATABASE_INFO_TYPE_HEX,    sha1),
+   DB_FIELD("md5",            DATABASE_INFO_FIELD_MD5,                  DATABASE_INFO_TYPE_HEX,    md5),
+   DB_FIELD("famitsu_rating", DATABASE_INFO_FIELD_FAMITSU_RATING,       DATABASE_INFO_TYPE_UINT,   famitsu_magazine_rating),
+   DB_FIELD("edge_rating",    DATABASE_INFO_FIELD_EDGE_MAGAZINE_RATING, DATABASE_INFO_TYPE_UINT,   edge_magazine_rating),
+   DB_FIELD("edge_issue",     DATABASE_INFO_FIELD_EDGE_MAGAZINE_ISSUE,  DATABASE_INFO_TYPE_UINT,   edge_magazine_issue),
+   DB_FIELD("users",          DATABASE_INFO_FIELD_MAX_USERS,            DATABASE_INFO_TYPE_UINT,   max_users),
+   DB_FIELD("releasemonth",   DATABASE_INFO_FIELD_RELEASEMONTH,         DATABASE_INFO_TYPE_UINT,   releasemonth),
+   DB_FIELD("releaseyear",    DATABASE_INFO_FIELD_RELEASEYEAR,          DATABASE_INFO_TYPE_UINT,   releaseyear),
+   DB_FIELD("analog",         DATABASE_INFO_FIELD_ANALOG,               DATABASE_INFO_TYPE_INT,    analog_supported),
+   DB_FIELD("rumble",         DATABASE_INFO_FIELD_RUMBLE,               DATABASE_INFO_TYPE_INT,    rumble_supported),
+};
+
+#undef DB_FIELD
+
+/* djb2 hashes of the keys above. */
+#define DATABASE_INFO_KEY_NAME                 0x7c9b0c46U
+#define DATABASE_INFO_KEY_DESCRIPTION          0x91b0c789U
+#define DATABASE_INFO_KEY_PUBLISHER            0x5e099013U
+#define DATABASE_INFO_KEY_DEVELOPER            0x1783d2abU
+#define DATABASE_INFO_KEY_ORIGIN               0x1315e3edU
+#define DATABASE_INFO_KEY_FRANCHISE            0xc3a526b8U
+#define DATABASE_INFO_KEY_EDGE_MAGAZINE_REVIEW 0xd3573eabU
+#define DATABASE_INFO_KEY_BBFC_RATING          0xede26836U
+#define DATABASE_INFO_KEY_ELSPA_RATING         0xd9cab41eU
+#define DATABASE_INFO_KEY_ESRB_RATING          0x4c3fa255U
+#define DATABASE_INFO_KEY_PEGI_RATING          0x431b736eU
+#define DATABASE_INFO_KEY_CERO_RATING          0x084a1772U
+#define DATABASE_INFO_KEY_ENHANCEMENT_HW       0xab612029U
+#define DATABASE_INFO_KEY_CRC32                0x0b88671dU
+#define DATABASE_INFO_KEY_SHA1                 0x7c9de632U
+#define DATABASE_INFO_KEY_MD5                  0x0b888fabU
+#define DATABASE_INFO_KEY_FAMITSU_RATING       0x0a50ca62U
+#define DATABASE_INFO_KEY_EDGE_MAGAZINE_RATING 0xd30dc4feU
+#define DATABASE_INFO_KEY_EDGE_MAGAZINE_ISSUE  0xa0f30d42U
+#define DATABASE_INFO_KEY_MAX_USERS            0x1084ff77U
+#define DATABASE_INFO_KEY_RELEASEMONTH         0x790ad76cU
+#define DATABASE_INFO_KEY_RELEASEYEAR          0x7fd06ed7U
+#define DATABASE_INFO_KEY_ANALOG               0xf220fc17U
+#define DATABASE_INFO_KEY_RUMBLE               0x1a4dc3ecU
+
+static uint32_t database_info_key_hash(const char *str)
+{
+   uint32_t hash = 5381;
+   unsigned char c;
+
+   while ((c = (unsigned char)*str++))
+      hash = (hash << 5) + hash + c;
+
+   return hash;
+}
+
+static const database_info_field_desc_t *database_info_field_find(
+      const char *key)
+{
+   unsigned n;
+
+   switch (database_info_key_hash(key))
+   {
+      case DATABASE_INFO_KEY_NAME:
+         n = 0;
+         break;
+      case DATABASE_INFO_KEY_DESCRIPTION:
+         n = 1;
+         break;
+      case DATABASE_INFO_KEY_PUBLISHER:
+         n = 2;
+         break;
+      case DATABASE_INFO_KEY_DEVELOPER:
+         n = 3;
+         break;
+      case DATABASE_INFO_KEY_ORIGIN:
+         n = 4;
+         break;
+      case DATABASE_INFO_KEY_FRANCHISE:
+         n = 5;
+         break;
+      case DATABASE_INFO_KEY_EDGE_MAGAZINE_REVIEW:
+         n = 6;
+         break;
+      case DATABASE_INFO_KEY_BBFC_RATING:
+         n = 7;
+         break;
+      case DATABASE_INFO_KEY_ELSPA_RATING:
+         n = 8;
+         break;
+      case DATABASE_INFO_KEY_ESRB_RATING:
+         n = 9;
+         break;
+      case DATABASE_INFO_KEY_PEGI_RATING:
+         n = 10;
+         break;
+      case DATABASE_INFO_KEY_CERO_RATING:
+         n = 11;
+         break;
+      case DATABASE_INFO_KEY_ENHANCEMENT_HW:
+         n = 12;
+         break;
+      case DATABASE_INFO_KEY_CRC32:
+         n = 13;
+         break;
+      case DATABASE_INFO_KEY_SHA1:
+         n = 14;
+         break;
+      case DATABASE_INFO_KEY_MD5:
+         n = 15;
+         break;
+      case DATABASE_INFO_KEY_FAMITSU_RATING:
+         n = 16;
+         break;
+      case DATABASE_INFO_KEY_EDGE_MAGAZINE_RATING:
+         n = 17;
+         break;
+      case DATABASE_INFO_KEY_EDGE_MAGAZINE_ISSUE:
+         n = 18;
+         break;
+      case DATABASE_INFO_KEY_MAX_USERS:
+         n = 19;
+         break;
+      case DATABASE_INFO_KEY_RELEASEMONTH:
+         n = 20;
+         break;
+      case DATABASE_INFO_KEY_RELEASEYEAR:
+         n = 21;
+         break;
+      case DATABASE_INFO_KEY_ANALOG:
+         n = 22;
+         break;
+      case DATABASE_INFO_KEY_RUMBLE:
+         n = 23;
+         break;
+      default:
+         return NULL;
+   }
+
+   /* Rule out a record key that merely shares a hash. */
+   if (strcmp(database_info_fields[n].key, key))
+      return NULL;
+
+   return &database_info_fields[n];
+}
+
+static const struct rmsgpack_dom_value *database_info_view_find(
+      const database_info_view_t *view, const char *key)
+{
+   size_t i;
+   const struct rmsgpack_dom_value *item = view->item;
+
+   for (i = 0; i < item->map.len; i++)
+   {
+      const struct rmsgpack_dom_value *k = &item->map.items[i].key;
+
+      if (k->type == RDT_STRING && !strcmp(k->string.buff, key))
+         return &item->map.items[i].value;
+   }
+
+   return NULL;
+}
+
+const char *database_info_view_get_string(const database_info_view_t *view,
+      const char *key, size_t *len)
+{
+   const struct rmsgpack_dom_value *val = database_info_view_find(view, key);
+
+   if (!val || (val->type != RDT_STRING && val->type != RDT_BINARY))
+      return NULL;
+
+   if (len)
+      *len = val->string.len;
+   return val->string.buff;
+}
+
+unsigned database_info_view_get_uint(const database_info_view_t *view,
+      const char *key, unsigned default_value)
+{
+   const struct rmsgpack_dom_value *val = database_info_view_find(view, key);
+
+   if (!val)
+      return default_value;
+
+   switch (val->type)
+   {
+      case RDT_UINT:
+         return val->uint_;
+      case RDT_INT:
+         return val->int_;
+      default:
+         break;
+   }
+
+   return default_value;
+}
+
+int database_info_iterate(const char *rdb_path, const char *query,
+      database_info_view_cb cb, void *userdata)
 {
    libretrodb_t db;
    libretrodb_cursor_t cur;
    struct rmsgpack_dom_value item;
-   size_t j;
-   unsigned k                               = 0;
-   database_info_t *database_info           = NULL;
-   database_info_list_t *database_info_list = NULL;
+   database_info_view_t view;
+   int ret = 0;
 
    if ((libretrodb_open(rdb_path, &db)) != 0)
-      return NULL;
+      return -1;
    if ((database_open_cursor(&db, &cur, query) != 0))
-      return NULL;
+   {
+      libretrodb_close(&db);
+      return -1;
+   }
 
-   database_info_list = (database_info_list_t*)calloc(1, sizeof(*database_info_list));
-   if (!database_info_list)
-      goto error;
+   view.item = &item;
 
    while (libretrodb_cursor_read_item(&cur, &item) == 0)
    {
-      database_info_t *db_info = NULL;
-      if (item.type != RDT_MAP)
-         continue;
+      if (item.type == RDT_MAP)
+         ret = cb(userdata, &view);
 
-      database_info = (database_info_t*)realloc(database_info, (k+1) * sizeof(database_info_t));
+      rmsgpack_dom_value_free(&item);
 
-      if (!database_info)
-         goto error;
+      if (ret != 0)
+         break;
+   }
 
-      db_info = &database_info[k];
+   libretrodb_cursor_close(&cur);
+   libretrodb_close(&db);
 
-      if (!db_info)
-         continue;
+   return ret;
+}
 
-      db_info->name                   = NULL;
-      db_info->description            = NULL;
-      db_info->publisher              = NULL;
-      db_info->developer              = NULL;
-      db_info->origin                 = NULL;
-      db_info->franchise              = NULL;
-      db_info->bbfc_rating            = NULL;
-      db_info->elspa_rating           = NULL;
-      db_info->esrb_rating            = NULL;
-      db_info->pegi_rating            = NULL;
-      db_info->cero_rating            = NULL;
-      db_info->edge_magazine_review   = NULL;
-      db_info->enhancement_hw         = NULL;
-      db_info->crc32                  = NULL;
-      db_info->sha1                   = NULL;
-      db_info->md5                    = NULL;
-      db_info->famitsu_magazine_rating= 0;
-      db_info->edge_magazine_rating   = 0;
-      db_info->edge_magazine_issue    = 0;
-      db_info->max_users              = 0;
-      db_info->releasemonth           = 0;
-      db_info->releaseyear            = 0;
-      db_info->analog_supported       = -1;
-      db_info->rumble_supported       = -1;
-
-      for (j = 0; j < item.map.len; j++)
-      {
-         struct rmsgpack_dom_value *key = &item.map.items[j].key;
-         struct rmsgpack_dom_value *val = &item.map.items[j].value;
+typedef struct
+{
+   database_info_t *list;
+   size_t count;
+   size_t capacity;
+   unsigned fields;
+} database_info_list_builder_t;
+
+static void database_info_decode(database_info_t *db_info,
+      const struct rmsgpack_dom_value *item, unsigned fields)
+{
+   size_t i;
 
-         if (!strcmp(key->string.buff, "name"))
-            db_info->name = strdup(val->string.buff);
+   memset(db_info, 0, sizeof(*db_info));
+   db_info->analog_supported = -1;
+   db_info->rumble_supported = -1;
 
-         if (!strcmp(key->string.buff, "description"))
-            db_info->description = strdup(val->string.buff);
+   for (i = 0; i < item->map.len; i++)
+   {
+      const struct rmsgpack_dom_value *key = &item->map.items[i].key;
+      const struct rmsgpack_dom_value *val = &item->map.items[i].value;
+      const database_info_field_desc_t *desc = NULL;
+      uint8_t *member;
 
-         if (!strcmp(key->string.buff, "publisher"))
-            db_info->publisher = strdup(val->string.buff);
+      if (key->type != RDT_STRING)
+         continue;
 
-         if (!strcmp(key->string.buff, "developer"))
-            db_info->developer = strdup(val->string.buff);
+      desc = database_info_field_find(key->string.buff);
 
-         if (!strcmp(key->string.buff, "origin"))
-            db_info->origin = strdup(val->string.buff);
+      if (!desc || !(fields & desc->field))
+         continue;
 
-         if (!strcmp(key->string.buff, "franchise"))
-            db_info->franchise = strdup(val->string.buff);
+      member = (uint8_t*)db_info + desc->offset;
 
-         if (!strcmp(key->string.buff, "bbfc_rating"))
-            db_info->bbfc_rating = strdup(val->string.buff);
+      switch (desc->type)
+      {
+         case DATABASE_INFO_TYPE_STRING:
+            if (val->type == RDT_STRING)
+               *(char**)member = strdup(val->string.buff);
+            break;
+         case DATABASE_INFO_TYPE_HEX:
+            if (val->type == RDT_BINARY)
+               *(char**)member = bin_to_hex_alloc(
+                     (uint8_t*)val->binary.buff, val->binary.len);
+            break;
+         case DATABASE_INFO_TYPE_UINT:
+            *(unsigned*)member = val->uint_;
+            break;
+         case DATABASE_INFO_TYPE_INT:
+            *(int*)member = val->uint_;
+            break;
+      }
+   }
+}
 
-         if (!strcmp(key->string.buff, "esrb_rating"))
-            db_info->esrb_rating = strdup(val->string.buff);
+static int database_info_list_append(void *userdata,
+      const database_info_view_t *view)
+{
+   database_info_list_builder_t *builder =
+      (database_info_list_builder_t*)userdata;
 
-         if (!strcmp(key->string.buff, "elspa_rating"))
-            db_info->elspa_rating = strdup(val->string.buff);
+   if (builder->count == builder->capacity)
+   {
+      size_t capacity        = builder->capacity ? builder->capacity * 2 : 16;
+      database_info_t *list  = (database_info_t*)
+         realloc(builder->list, capacity * sizeof(database_info_t));
 
-         if (!strcmp(key->string.buff, "cero_rating"))
-            db_info->cero_rating = strdup(val->string.buff);
+      if (!list)
+         return -1;
 
-         if (!strcmp(key->string.buff, "pegi_rating"))
-            db_info->pegi_rating = strdup(val->string.buff);
+      builder->list     = list;
+      builder->capacity = capacity;
+   }
 
-         if (!strcmp(key->string.buff, "enhancement_hw"))
-            db_info->enhancement_hw = strdup(val->string.buff);
+   database_info_decode(&builder->list[builder->count],
+         view->item, builder->fields);
+   builder->count++;
 
-         if (!strcmp(key->string.buff, "edge_review"))
-            db_info->edge_magazine_review = strdup(val->string.buff);
+   return 0;
+}
 
-         if (!strcmp(key->string.buff, "edge_rating"))
-            db_info->edge_magazine_rating = val->uint_;
+static void database_info_free(database_info_t *info)
+{
+   size_t i;
 
-         if (!strcmp(key->string.buff, "edge_issue"))
-            db_info->edge_magazine_issue = val->uint_;
+   for (i = 0; i < ARRAY_SIZE(database_info_fields); i++)
+   {
+      char **member;
 
-         if (!strcmp(key->string.buff, "famitsu_rating"))
-            db_info->famitsu_magazine_rating = val->uint_;
+      if (database_info_fields[i].type != DATABASE_INFO_TYPE_STRING &&
+            database_info_fields[i].type != DATABASE_INFO_TYPE_HEX)
+         continue;
 
-         if (!strcmp(key->string.buff, "users"))
-            db_info->max_users = val->uint_;
+      member = (char**)((uint8_t*)info + database_info_fields[i].offset);
+      if (*member)
+         free(*member);
+   }
+}
 
-         if (!strcmp(key->string.buff, "releasemonth"))
-            db_info->releasemonth = val->uint_;
+database_info_list_t *database_info_list_new(const char *rdb_path,
+      const char *query, unsigned fields)
+{
+   size_t i;
+   database_info_list_builder_t builder     = {0};
+   database_info_list_t *database_info_list = NULL;
 
-         if (!strcmp(key->string.buff, "releaseyear"))
-            db_info->releaseyear = val->uint_;
+   builder.fields = fields;
 
-         if (!strcmp(key->string.buff, "rumble"))
-            db_info->rumble_supported = val->uint_;
+   if (database_info_iterate(rdb_path, query,
+            database_info_list_append, &builder) != 0)
+      goto error;
 
-         if (!strcmp(key->string.buff, "analog"))
-            db_info->analog_supported = val->uint_;
+   database_info_list = (database_info_list_t*)
+      calloc(1, sizeof(*database_info_list));
+   if (!database_info_list)
+      goto error;
 
-         if (!strcmp(key->string.buff, "crc"))
-            db_info->crc32 = bin_to_hex_alloc((uint8_t*)val->binary.buff, val->binary.len);
-         if (!strcmp(key->string.buff, "sha1"))
-            db_info->sha1 = bin_to_hex_alloc((uint8_t*)val->binary.buff, val->binary.len);
-         if (!strcmp(key->string.buff, "md5"))
-            db_info->md5 = bin_to_hex_alloc((uint8_t*)val->binary.buff, val->binary.len);
-      }
-      k++;
+   /* Give back the unused tail of the geometric allocation. */
+   if (builder.count && builder.count < builder.capacity)
+   {
+      database_info_t *list = (database_info_t*)
+         realloc(builder.list, builder.count * sizeof(database_info_t));
+      if (list)
+         builder.list = list;
    }
 
-   database_info_list->list  = database_info;
-   database_info_list->count = k;
+   database_info_list->list  = builder.list;
+   database_info_list->count = builder.count;
 
    return database_info_list;
 
 error:
-   libretrodb_cursor_close(&cur);
-   libretrodb_close(&db);
-   database_info_list_free(database_info_list);
+   for (i = 0; i < builder.count; i++)
+      database_info_free(&builder.list[i]);
+   free(builder.list);
    return NULL;
 }
 
@@ -326,46 +577,7 @@ void database_info_list_free(database_info_list_t *database_info_list)
       return;
 
    for (i = 0; i < database_info_list->count; i++)
-   {
-      database_info_t *info = &database_info_list->list[i];
-
-      if (!info)
-         continue;
-
-      if (info->name)
-         free(info->name);
-      if (info->description)
-         free(info->description);
-      if (info->publisher)
-         free(info->publisher);
-      if (info->developer)
-         free(info->developer);
-      if (info->origin)
-         free(info->origin);
-      if (info->franchise)
-         free(info->franchise);
-      if (info->edge_magazine_review)
-         free(info->edge_magazine_review);
-
-      if (info->cero_rating)
-         free(info->cero_rating);
-      if (info->pegi_rating)
-         free(info->pegi_rating);
-      if (info->enhancement_hw)
-         free(info->enhancement_hw);
-      if (info->elspa_rating)
-         free(info->elspa_rating);
-      if (info->esrb_rating)
-         free(info->esrb_rating);
-      if (info->bbfc_rating)
-         free(info->bbfc_rating);
-      if (info->crc32)
-         free(info->crc32);
-      if (info->sha1)
-         free(info->sha1);
-      if (info->md5)
-         free(info->md5);
-   }
+      database_info_free(&database_info_list->list[i]);
 
    free(database_info_list->list);
    free(database_info_list);
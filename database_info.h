@@ -35,6 +35,45 @@ typedef struct
    struct string_list *list;
 } database_info_rdl_handle_t;
 
+enum database_info_field
+{
+   DATABASE_INFO_FIELD_NAME                 = (1 << 0),
+   DATABASE_INFO_FIELD_DESCRIPTION          = (1 << 1),
+   DATABASE_INFO_FIELD_PUBLISHER            = (1 << 2),
+   DATABASE_INFO_FIELD_DEVELOPER            = (1 << 3),
+   DATABASE_INFO_FIELD_ORIGIN               = (1 << 4),
+   DATABASE_INFO_FIELD_FRANCHISE            = (1 << 5),
+   DATABASE_INFO_FIELD_EDGE_MAGAZINE_REVIEW = (1 << 6),
+   DATABASE_INFO_FIELD_BBFC_RATING          = (1 << 7),
+   DATABASE_INFO_FIELD_ELSPA_RATING         = (1 << 8),
+   DATABASE_INFO_FIELD_ESRB_RATING          = (1 << 9),
+   DATABASE_INFO_FIELD_PEGI_RATING          = (1 << 10),
+   DATABASE_INFO_FIELD_CERO_RATING          = (1 << 11),
+   DATABASE_INFO_FIELD_ENHANCEMENT_HW       = (1 << 12),
+   DATABASE_INFO_FIELD_CRC32                = (1 << 13),
+   DATABASE_INFO_FIELD_SHA1                 = (1 << 14),
+   DATABASE_INFO_FIELD_MD5                  = (1 << 15),
+   DATABASE_INFO_FIELD_FAMITSU_RATING       = (1 << 16),
+   DATABASE_INFO_FIELD_EDGE_MAGAZINE_RATING = (1 << 17),
+   DATABASE_INFO_FIELD_EDGE_MAGAZINE_ISSUE  = (1 << 18),
+   DATABASE_INFO_FIELD_MAX_USERS            = (1 << 19),
+   DATABASE_INFO_FIELD_RELEASEMONTH         = (1 << 20),
+   DATABASE_INFO_FIELD_RELEASEYEAR          = (1 << 21),
+   DATABASE_INFO_FIELD_ANALOG               = (1 << 22),
+   DATABASE_INFO_FIELD_RUMBLE               = (1 << 23),
+   DATABASE_INFO_FIELD_ALL                  = (1 << 24) - 1
+};
+
+/* Undecoded view of a database record. Values point into
+ * the record and are only valid while it is being visited. */
+typedef struct
+{
+   const struct rmsgpack_dom_value *item;
+} database_info_view_t;
+
+typedef int (*database_info_view_cb)(void *userdata,
+      const database_info_view_t *view);
+
 typedef struct
 {
    char *name;
@@ -70,7 +109,39 @@ typedef struct
    size_t count;
 } database_info_list_t;
 
-database_info_list_t *database_info_list_new(const char *rdb_path, const char *query);
+/**
+ * database_info_list_new:
+ * @rdb_path            : Path to database.
+ * @query               : Query to filter records with, or NULL.
+ * @fields              : Bitmask of enum database_info_field values
+ *                        to decode. Other fields are left NULL/0.
+ *
+ * Returns: list of matching records, or NULL on error.
+ **/
+database_info_list_t *database_info_list_new(const char *rdb_path,
+      const char *query, unsigned fields);
+
+/**
+ * database_info_iterate:
+ * @rdb_path            : Path to database.
+ * @query               : Query to filter records with, or NULL.
+ * @cb                  : Called for every matching record.
+ * @userdata            : User data passed to @cb.
+ *
+ * Visits matching records without copying any of their fields.
+ * Returning non-zero from @cb stops the iteration.
+ *
+ * Returns: 0 on success, otherwise the non-zero value returned by @cb,
+ * or -1 on error.
+ **/
+int database_info_iterate(const char *rdb_path, const char *query,
+      database_info_view_cb cb, void *userdata);
+
+const char *database_info_view_get_string(const database_info_view_t *view,
+      const char *key, size_t *len);
+
+unsigned database_info_view_get_uint(const database_info_view_t *view,
+      const char *key, unsigned default_value);
 
 void database_info_list_free(database_info_list_t *list);
 
@@ -18,6 +18,7 @@
 #include "general.h"
 #include "retroarch.h"
 #include "runloop.h"
+#include "performance.h"
 #include "compat/posix_string.h"
 #include "gfx/video_monitor.h"
 #include "audio/audio_monitor.h"
@@ -367,7 +368,9 @@ void init_drivers(int flags)
 
       runloop->frames.video.count = 0;
 
+      rarch_startup_phase_begin("init_video");
       init_video();
+      rarch_startup_phase_end();
 
       if (!driver->video_cache_context_ack
             && global->system.hw_render_callback.context_reset)
@@ -378,7 +381,11 @@ void init_drivers(int flags)
    }
 
    if (flags & DRIVER_AUDIO)
+   {
+      rarch_startup_phase_begin("init_audio");
       init_audio();
+      rarch_startup_phase_end();
+   }
 
    /* Only initialize camera driver if we're ever going to use it. */
    if ((flags & DRIVER_CAMERA) && driver->camera_active)
@@ -391,8 +398,10 @@ void init_drivers(int flags)
 #ifdef HAVE_MENU
    if (flags & DRIVER_MENU)
    {
+      rarch_startup_phase_begin("init_menu");
       init_menu();
       menu_update_libretro_info(&global->menu.info);
+      rarch_startup_phase_end();
    }
 #endif
 
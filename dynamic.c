@@ -32,6 +32,7 @@
 #include "dynamic_dummy.h"
 #include "retroarch.h"
 #include "runloop.h"
+#include "emu_thread.h"
 
 #include "input/input_sensor.h"
 
@@ -552,6 +553,11 @@ bool rarch_environment_cb(unsigned cmd, void *data)
    if (ignore_environment_cb)
       return false;
 
+#ifdef HAVE_THREADS
+   if (rarch_emu_thread_defer_environ(cmd, data))
+      return true;
+#endif
+
    switch (cmd)
    {
       case RETRO_ENVIRONMENT_GET_OVERSCAN:
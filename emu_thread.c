@@ -0,0 +1,610 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <rthreads/rthreads.h>
+
+#include "emu_thread.h"
+#include "autosave.h"
+#include "dynamic.h"
+#include "general.h"
+#include "libretro_version_1.h"
+#include "performance.h"
+
+#define EMU_THREAD_JOYPAD_IDS   (RETRO_DEVICE_ID_JOYPAD_R3 + 1)
+#define EMU_THREAD_MOUSE_IDS    (RETRO_DEVICE_ID_MOUSE_HORIZ_WHEELDOWN + 1)
+#define EMU_THREAD_LIGHTGUN_IDS (RETRO_DEVICE_ID_LIGHTGUN_START + 1)
+#define EMU_THREAD_POINTER_IDS  (RETRO_DEVICE_ID_POINTER_PRESSED + 1)
+#define EMU_THREAD_KEY_WORDS    ((RETROK_LAST + 31) / 32)
+
+/* Everything the core can read through input_state for one
+ * frame. The keyboard is only read for the first port. */
+typedef struct emu_thread_input
+{
+   int16_t joypad[MAX_USERS][EMU_THREAD_JOYPAD_IDS];
+   int16_t analog[MAX_USERS][2][2];
+   int16_t mouse[MAX_USERS][EMU_THREAD_MOUSE_IDS];
+   int16_t lightgun[MAX_USERS][EMU_THREAD_LIGHTGUN_IDS];
+   int16_t pointer[MAX_USERS][EMU_THREAD_POINTER_IDS];
+   uint32_t keys[EMU_THREAD_KEY_WORDS];
+} emu_thread_input_t;
+
+typedef struct emu_thread_output
+{
+   void *frame;
+   size_t frame_size;
+   unsigned width;
+   unsigned height;
+   size_t pitch;
+   /* The core called video_refresh, possibly with NULL
+    * to duplicate the previous frame. */
+   bool has_frame;
+   bool frame_dupe;
+
+   int16_t *audio;
+   size_t audio_samples;
+   size_t audio_size;
+} emu_thread_output_t;
+
+/* Environment call that reaches the drivers, made by the
+ * core while it ran on the emulation thread. */
+typedef struct emu_thread_environ
+{
+   unsigned cmd;
+   union
+   {
+      unsigned rotation;
+      struct retro_game_geometry geometry;
+      struct retro_system_av_info av_info;
+   } data;
+} emu_thread_environ_t;
+
+/* One entry per deferred call, see rarch_emu_thread_defer_environ(). */
+#define EMU_THREAD_ENVIRON_MAX 3
+
+typedef struct emu_thread
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond_run;
+   scond_t *cond_done;
+
+   bool alive;
+   /* A frame was handed over and hasn't finished yet. */
+   bool busy;
+
+   /* Read by the emulation thread while busy, written by
+    * the main thread otherwise. */
+   emu_thread_input_t input;
+   bool skip;
+
+   /* The emulation thread writes out[cur] while busy, the
+    * main thread presents the other one. */
+   emu_thread_output_t out[2];
+   unsigned cur;
+
+   /* Written by the emulation thread while busy, replayed on
+    * the main thread by rarch_emu_thread_sync(). */
+   emu_thread_environ_t env_queue[EMU_THREAD_ENVIRON_MAX];
+   unsigned env_count;
+
+   /* Main thread copy of the cached frame, for when it still
+    * points at a buffer handed back to the emulation thread. */
+   void *cache;
+   size_t cache_size;
+} emu_thread_t;
+
+static emu_thread_t *emu_thread;
+
+static void emu_thread_video_refresh(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   emu_thread_output_t *out = &emu_thread->out[emu_thread->cur];
+   size_t size              = pitch * height;
+
+   if (emu_thread->skip)
+      return;
+
+   out->has_frame  = true;
+   out->frame_dupe = !data;
+   out->width      = width;
+   out->height     = height;
+   out->pitch      = pitch;
+
+   if (!data)
+      return;
+
+   if (size > out->frame_size)
+   {
+      void *frame = realloc(out->frame, size);
+
+      if (!frame)
+      {
+         out->has_frame = false;
+         return;
+      }
+
+      out->frame      = frame;
+      out->frame_size = size;
+   }
+
+   memcpy(out->frame, data, size);
+}
+
+static bool emu_thread_audio_reserve(emu_thread_output_t *out, size_t samples)
+{
+   int16_t *audio   = NULL;
+   size_t want      = out->audio_samples + samples;
+   size_t new_size  = out->audio_size ? out->audio_size : 4096;
+
+   if (want <= out->audio_size)
+      return true;
+
+   while (new_size < want)
+      new_size *= 2;
+
+   if (!(audio = (int16_t*)realloc(out->audio, new_size * sizeof(int16_t))))
+      return false;
+
+   out->audio      = audio;
+   out->audio_size = new_size;
+   return true;
+}
+
+static void emu_thread_audio_sample(int16_t left, int16_t right)
+{
+   emu_thread_output_t *out = &emu_thread->out[emu_thread->cur];
+
+   if (emu_thread->skip || !emu_thread_audio_reserve(out, 2))
+      return;
+
+   out->audio[out->audio_samples++] = left;
+   out->audio[out->audio_samples++] = right;
+}
+
+static size_t emu_thread_audio_sample_batch(const int16_t *data, size_t frames)
+{
+   emu_thread_output_t *out = &emu_thread->out[emu_thread->cur];
+
+   if (emu_thread->skip || !emu_thread_audio_reserve(out, frames << 1))
+      return frames;
+
+   memcpy(out->audio + out->audio_samples, data,
+         (frames << 1) * sizeof(int16_t));
+   out->audio_samples += frames << 1;
+
+   return frames;
+}
+
+static void emu_thread_input_poll(void)
+{
+   /* Polled by the main thread when taking the snapshot. */
+}
+
+static int16_t emu_thread_input_state(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   const emu_thread_input_t *input = &emu_thread->input;
+
+   if (port >= MAX_USERS)
+      return 0;
+
+   switch (device & RETRO_DEVICE_MASK)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         if (id < EMU_THREAD_JOYPAD_IDS)
+            return input->joypad[port][id];
+         break;
+      case RETRO_DEVICE_ANALOG:
+         if (idx < 2 && id < 2)
+            return input->analog[port][idx][id];
+         break;
+      case RETRO_DEVICE_MOUSE:
+         if (id < EMU_THREAD_MOUSE_IDS)
+            return input->mouse[port][id];
+         break;
+      case RETRO_DEVICE_LIGHTGUN:
+         if (id < EMU_THREAD_LIGHTGUN_IDS)
+            return input->lightgun[port][id];
+         break;
+      case RETRO_DEVICE_POINTER:
+         if (idx == 0 && id < EMU_THREAD_POINTER_IDS)
+            return input->pointer[port][id];
+         break;
+      case RETRO_DEVICE_KEYBOARD:
+         if (port == 0 && id < RETROK_LAST)
+            return (input->keys[id >> 5] >> (id & 31)) & 1;
+         break;
+   }
+
+   return 0;
+}
+
+/**
+ * emu_thread_snapshot_input:
+ * @input           : snapshot to fill in.
+ *
+ * Polls input and reads everything the core could ask for
+ * through the regular input_state callback, so remapping,
+ * turbo and overlays apply as usual.
+ **/
+static void emu_thread_snapshot_input(emu_thread_input_t *input)
+{
+   unsigned port, i, j;
+   driver_t *driver         = driver_get_ptr();
+   settings_t *settings     = config_get_ptr();
+   retro_input_state_t read = driver->retro_ctx.state_cb;
+   unsigned users           = settings->input.max_users;
+
+   if (users > MAX_USERS)
+      users = MAX_USERS;
+
+   memset(input, 0, sizeof(*input));
+
+   driver->retro_ctx.poll_cb();
+
+   for (port = 0; port < users; port++)
+   {
+      for (i = 0; i < EMU_THREAD_JOYPAD_IDS; i++)
+         input->joypad[port][i] = read(port, RETRO_DEVICE_JOYPAD, 0, i);
+      for (i = 0; i < 2; i++)
+         for (j = 0; j < 2; j++)
+            input->analog[port][i][j] = read(port, RETRO_DEVICE_ANALOG, i, j);
+      for (i = 0; i < EMU_THREAD_MOUSE_IDS; i++)
+         input->mouse[port][i] = read(port, RETRO_DEVICE_MOUSE, 0, i);
+      for (i = 0; i < EMU_THREAD_LIGHTGUN_IDS; i++)
+         input->lightgun[port][i] = read(port, RETRO_DEVICE_LIGHTGUN, 0, i);
+      for (i = 0; i < EMU_THREAD_POINTER_IDS; i++)
+         input->pointer[port][i] = read(port, RETRO_DEVICE_POINTER, 0, i);
+   }
+
+   for (i = 0; i < RETROK_LAST; i++)
+      if (read(0, RETRO_DEVICE_KEYBOARD, 0, i))
+         input->keys[i >> 5] |= 1u << (i & 31);
+}
+
+/**
+ * emu_thread_keep_cached_frame:
+ * @thr             : emulation thread.
+ * @out             : output about to be written by the emulation thread.
+ *
+ * The menu, pause and screenshots read the cached frame at
+ * any time. If no frame was presented since @out was, the
+ * cache still points at it, so it is moved to a copy the
+ * emulation thread never touches.
+ **/
+static void emu_thread_keep_cached_frame(emu_thread_t *thr,
+      emu_thread_output_t *out)
+{
+   global_t *global = global_get_ptr();
+   size_t size      = global->frame_cache.pitch * global->frame_cache.height;
+
+   if (!out->frame || global->frame_cache.data != out->frame)
+      return;
+
+   if (size > out->frame_size)
+      size = out->frame_size;
+
+   if (size > thr->cache_size)
+   {
+      void *cache = realloc(thr->cache, size);
+
+      if (!cache)
+      {
+         global->frame_cache.data = NULL;
+         return;
+      }
+
+      thr->cache      = cache;
+      thr->cache_size = size;
+   }
+
+   memcpy(thr->cache, out->frame, size);
+   global->frame_cache.data = thr->cache;
+}
+
+/**
+ * emu_thread_environ_replay:
+ * @thr             : emulation thread, idle.
+ *
+ * Runs the environment calls the core deferred during its
+ * last frame, on the calling thread.
+ **/
+static void emu_thread_environ_replay(emu_thread_t *thr)
+{
+   unsigned i;
+   emu_thread_environ_t queue[EMU_THREAD_ENVIRON_MAX];
+   unsigned count = thr->env_count;
+
+   if (!count)
+      return;
+
+   /* A replayed call may end up syncing again. */
+   memcpy(queue, thr->env_queue, count * sizeof(*queue));
+   thr->env_count = 0;
+
+   for (i = 0; i < count; i++)
+      rarch_environment_cb(queue[i].cmd, &queue[i].data);
+}
+
+/**
+ * emu_thread_present:
+ * @out             : output of a finished frame.
+ *
+ * Hands the output of a frame to the regular video and
+ * audio callbacks, on the calling thread.
+ **/
+static void emu_thread_present(emu_thread_output_t *out)
+{
+   driver_t *driver  = driver_get_ptr();
+   size_t frames     = out->audio_samples >> 1;
+   const int16_t *in = out->audio;
+
+   if (out->has_frame)
+      driver->retro_ctx.frame_cb(out->frame_dupe ? NULL : out->frame,
+            out->width, out->height, out->pitch);
+
+   while (frames)
+   {
+      size_t written = driver->retro_ctx.sample_batch_cb(in, frames);
+
+      if (!written)
+         break;
+
+      in     += written << 1;
+      frames -= written;
+   }
+
+   out->has_frame     = false;
+   out->audio_samples = 0;
+}
+
+static void emu_thread_loop(void *data)
+{
+   emu_thread_t *thr = (emu_thread_t*)data;
+
+   rarch_perf_trace_thread_name("emu");
+
+   slock_lock(thr->lock);
+
+   for (;;)
+   {
+      while (thr->alive && !thr->busy)
+         scond_wait(thr->cond_run, thr->lock);
+
+      if (!thr->alive)
+         break;
+
+      slock_unlock(thr->lock);
+
+      lock_autosave();
+      {
+         RARCH_PERFORMANCE_INIT(emu_thread_run);
+         RARCH_PERFORMANCE_START(emu_thread_run);
+         pretro_run();
+         RARCH_PERFORMANCE_STOP(emu_thread_run);
+      }
+      unlock_autosave();
+
+      slock_lock(thr->lock);
+      thr->busy = false;
+      scond_signal(thr->cond_done);
+   }
+
+   slock_unlock(thr->lock);
+
+   rarch_perf_thread_exit();
+}
+
+static void emu_thread_free(emu_thread_t *thr)
+{
+   unsigned i;
+   global_t *global = global_get_ptr();
+
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      slock_lock(thr->lock);
+      thr->alive = false;
+      scond_signal(thr->cond_run);
+      slock_unlock(thr->lock);
+
+      sthread_join(thr->thread);
+   }
+
+   if (thr->lock)
+      slock_free(thr->lock);
+   if (thr->cond_run)
+      scond_free(thr->cond_run);
+   if (thr->cond_done)
+      scond_free(thr->cond_done);
+
+   for (i = 0; i < 2; i++)
+   {
+      /* The last presented frame is cached for reinits and
+       * screenshots; it must not outlive its buffer. */
+      if (thr->out[i].frame && global->frame_cache.data == thr->out[i].frame)
+         global->frame_cache.data = NULL;
+
+      free(thr->out[i].frame);
+      free(thr->out[i].audio);
+   }
+
+   if (thr->cache && global->frame_cache.data == thr->cache)
+      global->frame_cache.data = NULL;
+   free(thr->cache);
+
+   free(thr);
+}
+
+static emu_thread_t *emu_thread_new(void)
+{
+   emu_thread_t *thr = (emu_thread_t*)calloc(1, sizeof(*thr));
+
+   if (!thr)
+      return NULL;
+
+   thr->lock      = slock_new();
+   thr->cond_run  = scond_new();
+   thr->cond_done = scond_new();
+
+   if (!thr->lock || !thr->cond_run || !thr->cond_done)
+      goto error;
+
+   thr->alive = true;
+
+   if (!(thr->thread = sthread_create(emu_thread_loop, thr)))
+      goto error;
+
+   RARCH_LOG("Emulation thread started.\n");
+
+   return thr;
+
+error:
+   thr->alive = false;
+   emu_thread_free(thr);
+   return NULL;
+}
+
+void rarch_emu_thread_sync(void)
+{
+   if (!emu_thread)
+      return;
+
+   slock_lock(emu_thread->lock);
+   while (emu_thread->busy)
+      scond_wait(emu_thread->cond_done, emu_thread->lock);
+   slock_unlock(emu_thread->lock);
+
+   emu_thread_environ_replay(emu_thread);
+}
+
+bool rarch_emu_thread_defer_environ(unsigned cmd, const void *data)
+{
+   unsigned i;
+   size_t size = 0;
+
+   /* Nothing but the core may call in while a frame is in flight. */
+   if (!emu_thread || !emu_thread->busy)
+      return false;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_SET_ROTATION:
+         size = sizeof(unsigned);
+         break;
+      case RETRO_ENVIRONMENT_SET_GEOMETRY:
+         size = sizeof(struct retro_game_geometry);
+         break;
+      case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+         size = sizeof(struct retro_system_av_info);
+         break;
+      default:
+         return false;
+   }
+
+   /* Only the latest call of each kind matters; it moves to
+    * the back, so the calls still apply in the order last made. */
+   for (i = 0; i < emu_thread->env_count; i++)
+   {
+      if (emu_thread->env_queue[i].cmd != cmd)
+         continue;
+
+      memmove(&emu_thread->env_queue[i], &emu_thread->env_queue[i + 1],
+            (emu_thread->env_count - i - 1) * sizeof(emu_thread->env_queue[0]));
+      emu_thread->env_count--;
+      break;
+   }
+
+   emu_thread->env_queue[emu_thread->env_count].cmd = cmd;
+   memcpy(&emu_thread->env_queue[emu_thread->env_count].data, data, size);
+   emu_thread->env_count++;
+
+   return true;
+}
+
+bool rarch_emu_thread_init(void)
+{
+   if (!emu_thread)
+      emu_thread = emu_thread_new();
+
+   return emu_thread != NULL;
+}
+
+void rarch_emu_thread_run(bool skip)
+{
+   unsigned prev;
+
+   if (!emu_thread)
+      return;
+
+   rarch_emu_thread_sync();
+
+   /* Only touched while the emulation thread is idle. */
+   emu_thread_snapshot_input(&emu_thread->input);
+   emu_thread->skip = skip;
+
+   prev             = emu_thread->cur;
+   emu_thread->cur ^= 1;
+
+   emu_thread_keep_cached_frame(emu_thread, &emu_thread->out[emu_thread->cur]);
+
+   /* Put back after the core was last run in place, or by
+    * rewind, which resets the audio callbacks every frame. */
+   pretro_set_video_refresh(emu_thread_video_refresh);
+   pretro_set_audio_sample(emu_thread_audio_sample);
+   pretro_set_audio_sample_batch(emu_thread_audio_sample_batch);
+   pretro_set_input_poll(emu_thread_input_poll);
+   pretro_set_input_state(emu_thread_input_state);
+
+   slock_lock(emu_thread->lock);
+   emu_thread->busy = true;
+   scond_signal(emu_thread->cond_run);
+   slock_unlock(emu_thread->lock);
+
+   emu_thread_present(&emu_thread->out[prev]);
+}
+
+void rarch_emu_thread_flush(void)
+{
+   driver_t *driver = driver_get_ptr();
+
+   if (!emu_thread)
+      return;
+
+   rarch_emu_thread_sync();
+
+   emu_thread_present(&emu_thread->out[emu_thread->cur]);
+
+   pretro_set_input_poll(driver->retro_ctx.poll_cb);
+   pretro_set_input_state(driver->retro_ctx.state_cb);
+   retro_set_runahead_callbacks(true, true);
+}
+
+void rarch_emu_thread_deinit(void)
+{
+   if (!emu_thread)
+      return;
+
+   rarch_emu_thread_flush();
+   emu_thread_free(emu_thread);
+   emu_thread = NULL;
+
+   RARCH_LOG("Emulation thread stopped.\n");
+}
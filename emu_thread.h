@@ -0,0 +1,94 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_EMU_THREAD_H
+#define __RARCH_EMU_THREAD_H
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * rarch_emu_thread_init:
+ *
+ * Starts the emulation thread, unless it is already running.
+ *
+ * Returns: true (1) if the emulation thread is running,
+ * otherwise false (0).
+ **/
+bool rarch_emu_thread_init(void);
+
+/**
+ * rarch_emu_thread_run:
+ * @skip            : drop the video and audio of this frame.
+ *
+ * Runs one frame of the core on the emulation thread, which
+ * must have been started with rarch_emu_thread_init().
+ *
+ * Input is read on the calling thread and handed over as a
+ * snapshot. The core's video and audio output is copied and
+ * handed back; while the new frame runs, the output of the
+ * previous one is presented on the calling thread. Frames
+ * are thus shown one frame later than when run in place.
+ **/
+void rarch_emu_thread_run(bool skip);
+
+/**
+ * rarch_emu_thread_sync:
+ *
+ * Waits for the frame in flight, if any, to finish. Must be
+ * called before anything else touches the core.
+ **/
+void rarch_emu_thread_sync(void);
+
+/**
+ * rarch_emu_thread_defer_environ:
+ * @cmd             : environment command.
+ * @data            : its argument.
+ *
+ * Environment calls that reach the video driver must not
+ * race the main thread presenting the previous frame. Made
+ * by the core on the emulation thread, they are queued and
+ * run by rarch_emu_thread_sync() once the frame is done.
+ *
+ * Returns: true (1) if the call was queued, otherwise
+ * false (0) and the caller handles it as usual.
+ **/
+bool rarch_emu_thread_defer_environ(unsigned cmd, const void *data);
+
+/**
+ * rarch_emu_thread_flush:
+ *
+ * Waits for the frame in flight, presents what is left of
+ * its output and puts the regular libretro callbacks back,
+ * so the core can be run in place again.
+ **/
+void rarch_emu_thread_flush(void);
+
+/**
+ * rarch_emu_thread_deinit:
+ *
+ * Flushes and stops the emulation thread, if it is running.
+ **/
+void rarch_emu_thread_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -94,6 +94,8 @@ void main_exit(args_type() args)
 
    global->system.shutdown         = false;
 
+   rarch_benchmark_report();
+
    main_exit_save_config();
 
    if (global->main_is_init)
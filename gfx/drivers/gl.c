@@ -2215,6 +2215,7 @@ static void gl_begin_debug(gl_t *gl)
 static void *gl_init(const video_info_t *video, const input_driver_t **input, void **input_data)
 {
    unsigned win_width, win_height;
+   bool ret                           = false;
    bool force_smooth                  = false;
    gl_t *gl                           = NULL;
    const gfx_ctx_driver_t *ctx_driver = NULL;
@@ -2346,7 +2347,11 @@ static void *gl_init(const video_info_t *video, const input_driver_t **input, vo
             gl->shader->ident);
    }
 
-   if (!gl_shader_init(gl))
+   rarch_startup_phase_begin("shader_init");
+   ret = gl_shader_init(gl);
+   rarch_startup_phase_end();
+
+   if (!ret)
    {
       RARCH_ERR("[GL]: Shader initialization failed.\n");
       gl->ctx_driver->destroy(gl);
@@ -30,79 +30,144 @@ struct rarch_soft_plug
    dylib_t lib;
 #endif
    const struct softfilter_implementation *impl;
+   /* SOFTFILTER_FLAG_* bits; API version 2 plugs predate them. */
+   unsigned flags;
 };
 
+/* Packets are cut finer than there are threads, so the pool 
+ * can even out rows which cost more than others. */
+#define SOFTFILTER_PACKETS_PER_THREAD 4
+#define SOFTFILTER_MIN_PACKET_ROWS 8
+
+#define SOFTFILTER_MAX_PASSES 8
+
+/* Consecutive passes of a chain are run band by band, so the 
+ * intermediate rows stay in cache instead of going through 
+ * whole frames. A band is sized so the intermediate rows of all 
+ * its passes fit in SOFTFILTER_BAND_BYTES. 
+ *
+ * Each pass also filters SOFTFILTER_BAND_HALO rows beyond the 
+ * band on either side, and only the rows it needs are kept. 
+ * This keeps the cut between bands invisible for filters looking 
+ * at neighbouring rows; the bundled ones look two rows away 
+ * at most. Filters flagged SOFTFILTER_FLAG_WHOLE_FRAME are 
+ * never run in bands. */
+#define SOFTFILTER_BAND_BYTES (256 * 1024)
+#define SOFTFILTER_MIN_BAND_ROWS 16
+#define SOFTFILTER_BAND_HALO 2
+
 #ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
+#include <rthreads/rthreads_pool.h>
 
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
+/* One pool is shared by all softfilters. It is created by the 
+ * first filter and sized for it. */
+static sthread_pool_t *softfilter_pool;
+static unsigned softfilter_pool_refs;
 
-static void filter_thread_loop(void *data)
+static sthread_pool_t *softfilter_pool_ref(unsigned threads)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
-
-   for (;;)
+   if (!softfilter_pool)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
+      /* The thread processing the frame takes part as well. */
+      softfilter_pool = sthread_pool_new(threads - 1);
+      if (!softfilter_pool)
+         return NULL;
+   }
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+   softfilter_pool_refs++;
+   return softfilter_pool;
+}
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
+static void softfilter_pool_unref(void)
+{
+   if (--softfilter_pool_refs)
+      return;
+
+   sthread_pool_free(softfilter_pool);
+   softfilter_pool = NULL;
 }
 #endif
 
-struct rarch_softfilter
+struct softfilter_pass
 {
-   config_file_t *conf;
-
    const struct softfilter_implementation *impl;
    void *impl_data;
+   unsigned flags;
+
+   /* Kept to create the filter again once its bands are known. */
+   char key[64];
+   unsigned in_fmt, out_fmt;
+
+   struct softfilter_work_packet *packets;
+   unsigned num_packets;
+
+   enum retro_pixel_format out_pix_fmt;
+   unsigned max_width, max_height;
+   unsigned max_out_width, max_out_height;
+
+   /* Vertical scale, 0 if the pass needs whole frames. */
+   unsigned scale;
+
+   /* Output of the pass for one band. */
+   uint8_t *band;
+   size_t band_stride;
+
+   /* Output of the pass for a whole frame, if the next pass 
+    * does not run in the same bands. */
+   uint8_t *frame;
+   size_t frame_stride;
+};
+
+/* A run of passes, processed in bands of band_rows input rows. 
+ * A single pass, or one needing whole frames, has band_rows 0. */
+struct softfilter_segment
+{
+   unsigned first;
+   unsigned count;
+   unsigned band_rows;
+};
+
+struct rarch_softfilter
+{
+   config_file_t *conf;
 
    struct rarch_soft_plug *plugs;
    unsigned num_plugs;
 
    unsigned max_width, max_height;
    enum retro_pixel_format pix_fmt, out_pix_fmt;
-
-   struct softfilter_work_packet *packets;
+   softfilter_simd_mask_t cpu_features;
    unsigned threads;
 
+   struct softfilter_pass *passes;
+   unsigned num_passes;
+
+   struct softfilter_segment *segments;
+   unsigned num_segments;
+
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   sthread_pool_t *pool;
 #endif
 };
 
-static const struct softfilter_implementation *
-softfilter_find_implementation(rarch_softfilter_t *filt, const char *ident)
+#ifdef HAVE_THREADS
+static void softfilter_pool_task(void *data, unsigned idx)
+{
+   struct softfilter_pass *pass = (struct softfilter_pass*)data;
+   pass->packets[idx].work(pass->impl_data,
+         pass->packets[idx].thread_data);
+}
+#endif
+
+static const struct rarch_soft_plug *
+softfilter_find_plug(rarch_softfilter_t *filt, const char *ident)
 {
    unsigned i;
 
    for (i = 0; i < filt->num_plugs; i++)
    {
       if (!strcmp(filt->plugs[i].impl->short_ident, ident))
-         return filt->plugs[i].impl;
+         return &filt->plugs[i];
    }
 
    return NULL;
@@ -117,45 +182,118 @@ static const struct softfilter_config softfilter_config = {
    config_userdata_free,
 };
 
-static bool create_softfilter_graph(rarch_softfilter_t *filt,
-      enum retro_pixel_format in_pixel_format,
-      unsigned max_width, unsigned max_height,
-      softfilter_simd_mask_t cpu_features,
-      unsigned threads)
+static unsigned softfilter_bpp(enum retro_pixel_format fmt)
+{
+   return fmt == RETRO_PIXEL_FORMAT_XRGB8888 ?
+      SOFTFILTER_BPP_XRGB8888 : SOFTFILTER_BPP_RGB565;
+}
+
+/* Filters read a little past the rows they are given, as they 
+ * would in a core's frame. Intermediate buffers get spare rows 
+ * around them, so this stays within the allocation. */
+static uint8_t *softfilter_alloc_rows(size_t stride, unsigned rows)
+{
+   uint8_t *buf = (uint8_t*)calloc(rows + 2 * SOFTFILTER_BAND_HALO, stride);
+   if (!buf)
+      return NULL;
+   return buf + SOFTFILTER_BAND_HALO * stride;
+}
+
+static void softfilter_free_rows(uint8_t *buf, size_t stride)
+{
+   if (buf)
+      free(buf - SOFTFILTER_BAND_HALO * stride);
+}
+
+/* Packets to split @rows input rows into: enough for the pool 
+ * to even out uneven rows, but at least SOFTFILTER_MIN_PACKET_ROWS 
+ * rows each, and no fewer than @min_packets. */
+static unsigned softfilter_packets_for_rows(unsigned threads,
+      unsigned rows, unsigned min_packets)
+{
+   unsigned packets = threads;
+#ifdef HAVE_THREADS
+   packets = threads * SOFTFILTER_PACKETS_PER_THREAD;
+   if (packets > rows / SOFTFILTER_MIN_PACKET_ROWS)
+      packets = rows / SOFTFILTER_MIN_PACKET_ROWS;
+   if (packets < min_packets)
+      packets = min_packets;
+#endif
+   return packets;
+}
+
+/* The filter splits its work into as many packets as it is 
+ * told to use threads. */
+static bool softfilter_pass_instantiate(rarch_softfilter_t *filt,
+      struct softfilter_pass *pass, unsigned packets)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i;
-   char key[64], name[64];
    struct config_file_userdata userdata;
 
-   snprintf(key, sizeof(key), "filter");
+   userdata.conf = filt->conf;
+   /* Index-specific configs take priority over ident-specific. */
+   userdata.prefix[0] = pass->key; 
+   userdata.prefix[1] = pass->impl->short_ident;
+
+   pass->impl_data = pass->impl->create(
+         &softfilter_config, pass->in_fmt, pass->out_fmt,
+         pass->max_width, pass->max_height,
+         packets, filt->cpu_features, &userdata);
+   if (!pass->impl_data)
+   {
+      RARCH_ERR("Failed to create softfilter state.\n");
+      return false;
+   }
 
-   if (!config_get_array(filt->conf, key, name, sizeof(name)))
+   packets = pass->impl->query_num_threads(pass->impl_data);
+   if (!packets)
    {
-      RARCH_ERR("Could not find 'filter' array in config.\n");
+      RARCH_ERR("Invalid number of threads.\n");
       return false;
    }
 
-   if (filt->num_plugs == 0)
+   free(pass->packets);
+   pass->packets = (struct softfilter_work_packet*)
+      calloc(packets, sizeof(*pass->packets));
+   if (!pass->packets)
    {
-      RARCH_ERR("No filter plugs found. Exiting...\n");
+      RARCH_ERR("Failed to allocate softfilter packets.\n");
+      return false;
+   }
+   pass->num_packets = packets;
+
+   return true;
+}
+
+static bool create_softfilter_pass(rarch_softfilter_t *filt,
+      struct softfilter_pass *pass, const char *key,
+      enum retro_pixel_format in_pixel_format,
+      unsigned max_width, unsigned max_height)
+{
+   unsigned input_fmts, input_fmt, output_fmts, output_fmt;
+   unsigned out_width, out_height;
+   char name[64];
+   const struct rarch_soft_plug *plug = NULL;
+
+   if (!config_get_array(filt->conf, key, name, sizeof(name)))
+   {
+      RARCH_ERR("Could not find '%s' array in config.\n", key);
       return false;
    }
 
-   filt->impl = softfilter_find_implementation(filt, name);
-   if (!filt->impl)
+   plug = softfilter_find_plug(filt, name);
+   if (!plug)
    {
       RARCH_ERR("Could not find implementation.\n");
       return false;
    }
 
-   userdata.conf = filt->conf;
-   /* Index-specific configs take priority over ident-specific. */
-   userdata.prefix[0] = key; 
-   userdata.prefix[1] = filt->impl->short_ident;
+   pass->impl  = plug->impl;
+   pass->flags = plug->flags;
+
+   strlcpy(pass->key, key, sizeof(pass->key));
 
    /* Simple assumptions. */
-   filt->pix_fmt = in_pixel_format;
-   input_fmts = filt->impl->query_input_formats();
+   input_fmts = pass->impl->query_input_formats();
 
    switch (in_pixel_format)
    {
@@ -175,75 +313,245 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-   output_fmts = filt->impl->query_output_formats(input_fmt);
+   output_fmts = pass->impl->query_output_formats(input_fmt);
    /* If we have a match of input/output formats, use that. */
    if (output_fmts & input_fmt)
-      filt->out_pix_fmt = in_pixel_format;
+   {
+      output_fmt        = input_fmt;
+      pass->out_pix_fmt = in_pixel_format;
+   }
    else if (output_fmts & SOFTFILTER_FMT_XRGB8888)
-      filt->out_pix_fmt = RETRO_PIXEL_FORMAT_XRGB8888;
+   {
+      output_fmt        = SOFTFILTER_FMT_XRGB8888;
+      pass->out_pix_fmt = RETRO_PIXEL_FORMAT_XRGB8888;
+   }
    else if (output_fmts & SOFTFILTER_FMT_RGB565)
-      filt->out_pix_fmt = RETRO_PIXEL_FORMAT_RGB565;
+   {
+      output_fmt        = SOFTFILTER_FMT_RGB565;
+      pass->out_pix_fmt = RETRO_PIXEL_FORMAT_RGB565;
+   }
    else
    {
       RARCH_ERR("Did not find suitable output format for softfilter.\n");
       return false;
    }
 
-   filt->max_width = max_width;
-   filt->max_height = max_height;
+   pass->max_width  = max_width;
+   pass->max_height = max_height;
+   pass->in_fmt     = input_fmt;
+   pass->out_fmt    = output_fmt;
 
-   filt->impl_data = filt->impl->create(
-         &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads : 
-         rarch_get_cpu_cores(), cpu_features,
-         &userdata);
-   if (!filt->impl_data)
-   {
-      RARCH_ERR("Failed to create softfilter state.\n");
+   if (!softfilter_pass_instantiate(filt, pass,
+            softfilter_packets_for_rows(filt->threads, max_height,
+               filt->threads)))
       return false;
+
+   pass->impl->query_output_size(pass->impl_data,
+         &pass->max_out_width, &pass->max_out_height,
+         max_width, max_height);
+
+   /* Bands need every input row to map to a whole number of 
+    * output rows. */
+   pass->scale = pass->max_out_height / max_height;
+   pass->impl->query_output_size(pass->impl_data,
+         &out_width, &out_height, max_width, 1);
+   if (pass->max_out_height != pass->scale * max_height ||
+         out_height != pass->scale)
+      pass->scale = 0;
+
+   /* Packets are split for whole frames; within a band of a few 
+    * rows they would get a row or none, and their borders would 
+    * be taken for frame edges. */
+   if (pass->flags & SOFTFILTER_FLAG_WHOLE_FRAME)
+      pass->scale = 0;
+
+   RARCH_LOG("[SoftFilter]: Pass '%s': %u work packets, %ux%u max output.\n",
+         pass->impl->short_ident, pass->num_packets,
+         pass->max_out_width, pass->max_out_height);
+
+   return true;
+}
+
+/**
+ * create_softfilter_segment:
+ * @filt                 : Softfilter handle.
+ * @seg                  : Segment, with first and count set.
+ *
+ * Picks the band height of a run of passes and allocates the 
+ * band buffers of its passes.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool create_softfilter_segment(rarch_softfilter_t *filt,
+      struct softfilter_segment *seg)
+{
+   int k;
+   unsigned rows, scale = 1;
+   size_t row_bytes     = 0;
+   struct softfilter_pass *passes = &filt->passes[seg->first];
+
+   if (seg->count < 2)
+      return true;
+
+   /* Bytes of band output, per input row of the segment. */
+   for (k = 0; k < (int)seg->count; k++)
+   {
+      scale     *= passes[k].scale;
+      row_bytes += passes[k].max_out_width * 
+         softfilter_bpp(passes[k].out_pix_fmt) * scale;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   seg->band_rows = SOFTFILTER_BAND_BYTES / row_bytes;
+   if (seg->band_rows < SOFTFILTER_MIN_BAND_ROWS)
+      seg->band_rows = SOFTFILTER_MIN_BAND_ROWS;
+   if (seg->band_rows > passes[0].max_height)
+      seg->band_rows = passes[0].max_height;
+
+   /* Work out the rows each pass covers for a band, halo 
+    * included, from the last pass back. */
+   rows = seg->band_rows * scale;
+   for (k = seg->count - 1; k >= 0; k--)
    {
-      RARCH_ERR("Invalid number of threads.\n");
-      return false;
+      unsigned packets;
+      struct softfilter_pass *pass = &passes[k];
+
+      rows = rows / pass->scale + 2 * SOFTFILTER_BAND_HALO + 2;
+
+      /* The packets were cut for whole frames. A band only has a 
+       * few rows, so create the filter again with fewer packets. */
+      packets = softfilter_packets_for_rows(filt->threads, rows, 1);
+      if (packets < pass->num_packets)
+      {
+         pass->impl->destroy(pass->impl_data);
+         pass->impl_data = NULL;
+
+         if (!softfilter_pass_instantiate(filt, pass, packets))
+            return false;
+
+         RARCH_LOG("[SoftFilter]: Pass %u: %u work packets per band.\n",
+               (unsigned)(seg->first + k), pass->num_packets);
+      }
+
+      pass->band_stride = pass->max_out_width * 
+         softfilter_bpp(pass->out_pix_fmt);
+      pass->band = softfilter_alloc_rows(pass->band_stride,
+            rows * pass->scale);
+      if (!pass->band)
+         return false;
    }
 
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   RARCH_LOG("[SoftFilter]: Passes %u-%u run in bands of %u rows.\n",
+         seg->first, seg->first + seg->count - 1, seg->band_rows);
+
+   return true;
+}
+
+static bool create_softfilter_graph(rarch_softfilter_t *filt,
+      enum retro_pixel_format in_pixel_format,
+      unsigned max_width, unsigned max_height,
+      softfilter_simd_mask_t cpu_features,
+      unsigned threads)
+{
+   unsigned i, num_passes = 0;
+   bool chain = config_get_uint(filt->conf, "filters", &num_passes);
+   enum retro_pixel_format pix_fmt = in_pixel_format;
+
+   if (!chain)
+      num_passes = 1;
 
-   filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
-   if (!filt->packets)
+   if (!num_passes || num_passes > SOFTFILTER_MAX_PASSES)
    {
-      RARCH_ERR("Failed to allocate softfilter packets.\n");
+      RARCH_ERR("Invalid number of filters: %u.\n", num_passes);
+      return false;
+   }
+
+   if (filt->num_plugs == 0)
+   {
+      RARCH_ERR("No filter plugs found. Exiting...\n");
       return false;
    }
 
+   filt->pix_fmt    = in_pixel_format;
+   filt->max_width  = max_width;
+   filt->max_height = max_height;
+
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = rarch_get_cpu_cores();
+   if (!threads)
+      threads = 1;
+
+   filt->cpu_features = cpu_features;
+   filt->threads      = threads;
+
 #ifdef HAVE_THREADS
-   filt->thread_data = (struct filter_thread_data*)
-      calloc(threads, sizeof(*filt->thread_data));
-   if (!filt->thread_data)
+   filt->pool = softfilter_pool_ref(threads);
+   RARCH_LOG("Using %u threads for softfilter.\n",
+         sthread_pool_threads(filt->pool));
+#endif
+
+   filt->passes = (struct softfilter_pass*)
+      calloc(num_passes, sizeof(*filt->passes));
+   filt->segments = (struct softfilter_segment*)
+      calloc(num_passes, sizeof(*filt->segments));
+   if (!filt->passes || !filt->segments)
       return false;
-   filt->threads = threads;
 
-   for (i = 0; i < threads; i++)
+   for (i = 0; i < num_passes; i++)
    {
-      filt->thread_data[i].userdata = filt->impl_data;
-      filt->thread_data[i].done = true;
+      char key[64];
+      struct softfilter_pass *pass = &filt->passes[i];
 
-      filt->thread_data[i].lock = slock_new();
-      if (!filt->thread_data[i].lock)
-         return false;
-      filt->thread_data[i].cond = scond_new();
-      if (!filt->thread_data[i].cond)
+      if (chain)
+         snprintf(key, sizeof(key), "filter%u", i);
+      else
+         strlcpy(key, "filter", sizeof(key));
+
+      if (!create_softfilter_pass(filt, pass, key, pix_fmt,
+               max_width, max_height))
          return false;
-      filt->thread_data[i].thread = sthread_create(
-            filter_thread_loop, &filt->thread_data[i]);
-      if (!filt->thread_data[i].thread)
+
+      filt->num_passes++;
+      pix_fmt    = pass->out_pix_fmt;
+      max_width  = pass->max_out_width;
+      max_height = pass->max_out_height;
+   }
+
+   filt->out_pix_fmt = pix_fmt;
+
+   /* Group the passes into runs sharing bands. */
+   for (i = 0; i < filt->num_passes; )
+   {
+      struct softfilter_segment *seg = 
+         &filt->segments[filt->num_segments++];
+
+      seg->first = i;
+      seg->count = 1;
+
+      if (filt->passes[i].scale)
+      {
+         while (i + seg->count < filt->num_passes &&
+               filt->passes[i + seg->count].scale)
+            seg->count++;
+      }
+
+      if (!create_softfilter_segment(filt, seg))
          return false;
+
+      i += seg->count;
+
+      /* The last pass of a run hands a whole frame on. */
+      if (i < filt->num_passes)
+      {
+         struct softfilter_pass *pass = &filt->passes[i - 1];
+
+         pass->frame_stride = pass->max_out_width * 
+            softfilter_bpp(pass->out_pix_fmt);
+         pass->frame = softfilter_alloc_rows(pass->frame_stride,
+               pass->max_out_height);
+         if (!pass->frame)
+            return false;
+      }
    }
-#endif
 
    return true;
 }
@@ -281,8 +589,13 @@ static bool append_softfilter_plugs(rarch_softfilter_t *filt,
          continue;
       }
 
-      if (impl->api_version != SOFTFILTER_API_VERSION)
+      /* Version 2 lacks the flags; such filters may look 
+       * anywhere in the frame, so they get whole frames. */
+      if (impl->api_version != SOFTFILTER_API_VERSION
+            && impl->api_version != 2)
       {
+         RARCH_WARN("[SoftFilter]: %s has unknown API version %u, skipped.\n",
+               list->elems[i].data, impl->api_version);
          dylib_close(lib);
          continue;
       }
@@ -301,6 +614,8 @@ static bool append_softfilter_plugs(rarch_softfilter_t *filt,
       filt->plugs = new_plugs;
       filt->plugs[filt->num_plugs].lib = lib;
       filt->plugs[filt->num_plugs].impl = impl;
+      filt->plugs[filt->num_plugs].flags = impl->api_version == 2
+         ? SOFTFILTER_FLAG_WHOLE_FRAME : impl->flags;
       filt->num_plugs++;
    }
 
@@ -353,6 +668,7 @@ static bool append_softfilter_plugs(rarch_softfilter_t *filt,
       filt->plugs[i].impl = soft_plugs_builtin[i](mask);
       if (!filt->plugs[i].impl)
          return false;
+      filt->plugs[i].flags = filt->plugs[i].impl->flags;
    }
 
    return true;
@@ -436,9 +752,18 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    if (!filt)
       return;
 
-   free(filt->packets);
-   if (filt->impl && filt->impl_data)
-      filt->impl->destroy(filt->impl_data);
+   for (i = 0; i < filt->num_passes; i++)
+   {
+      struct softfilter_pass *pass = &filt->passes[i];
+
+      free(pass->packets);
+      softfilter_free_rows(pass->band, pass->band_stride);
+      softfilter_free_rows(pass->frame, pass->frame_stride);
+      if (pass->impl && pass->impl_data)
+         pass->impl->destroy(pass->impl_data);
+   }
+   free(filt->passes);
+   free(filt->segments);
 
 #ifdef HAVE_DYLIB
    for (i = 0; i < filt->num_plugs; i++)
@@ -450,19 +775,8 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
 #endif
 
 #ifdef HAVE_THREADS
-   for (i = 0; i < filt->threads; i++)
-   {
-      if (!filt->thread_data[i].thread)
-         continue;
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].die = true;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-      sthread_join(filt->thread_data[i].thread);
-      slock_free(filt->thread_data[i].lock);
-      scond_free(filt->thread_data[i].cond);
-   }
-   free(filt->thread_data);
+   if (filt->pool)
+      softfilter_pool_unref();
 #endif
    free(filt);
 }
@@ -478,9 +792,22 @@ void rarch_softfilter_get_output_size(rarch_softfilter_t *filt,
       unsigned *out_width, unsigned *out_height,
       unsigned width, unsigned height)
 {
-   if (filt && filt->impl && filt->impl->query_output_size)
-      filt->impl->query_output_size(filt->impl_data, out_width,
-            out_height, width, height);
+   unsigned i;
+
+   if (!filt)
+      return;
+
+   for (i = 0; i < filt->num_passes; i++)
+   {
+      const struct softfilter_pass *pass = &filt->passes[i];
+
+      if (pass->impl->query_output_size)
+         pass->impl->query_output_size(pass->impl_data,
+               &width, &height, width, height);
+   }
+
+   *out_width  = width;
+   *out_height = height;
 }
 
 enum retro_pixel_format rarch_softfilter_get_output_format(
@@ -489,44 +816,162 @@ enum retro_pixel_format rarch_softfilter_get_output_format(
    return filt->out_pix_fmt;
 }
 
-void rarch_softfilter_process(rarch_softfilter_t *filt,
+static void softfilter_process_pass(rarch_softfilter_t *filt,
+      struct softfilter_pass *pass,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
    unsigned i;
 
-   if (filt && filt->impl && filt->impl->get_work_packets)
-      filt->impl->get_work_packets(filt->impl_data, filt->packets,
+   if (pass->impl->get_work_packets)
+      pass->impl->get_work_packets(pass->impl_data, pass->packets,
             output, output_stride, input, width, height, input_stride);
-   
+
 #ifdef HAVE_THREADS
-   /* Fire off workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Firing off filter thread %u ...\n", i);
+   (void)i;
+   sthread_pool_run(filt->pool, softfilter_pool_task, pass,
+         pass->num_packets);
+#else
+   for (i = 0; i < pass->num_packets; i++)
+      pass->packets[i].work(pass->impl_data, pass->packets[i].thread_data);
 #endif
-      filt->thread_data[i].packet = &filt->packets[i];
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].done = false;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-   }
+}
 
-   /* Wait for workers */
-   for (i = 0; i < filt->threads; i++)
+/**
+ * softfilter_process_bands:
+ * @filt                 : Softfilter handle.
+ * @seg                  : Run of passes to process.
+ *
+ * Runs the passes of @seg band by band. For each band, every 
+ * pass filters the rows the next one needs into its band 
+ * buffer, and the rows of the last pass are copied to @output.
+ **/
+static void softfilter_process_bands(rarch_softfilter_t *filt,
+      const struct softfilter_segment *seg,
+      uint8_t *output, size_t output_stride,
+      const uint8_t *input, unsigned width, unsigned height, size_t input_stride)
+{
+   int k;
+   unsigned y, scale = 1;
+   unsigned in_first[SOFTFILTER_MAX_PASSES];
+   unsigned in_last[SOFTFILTER_MAX_PASSES];
+   struct softfilter_pass *passes = &filt->passes[seg->first];
+   struct softfilter_pass *last   = &passes[seg->count - 1];
+
+   for (k = 0; k < (int)seg->count; k++)
+      scale *= passes[k].scale;
+
+   for (y = 0; y < height; y += seg->band_rows)
    {
-#if 0
-      RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-      slock_lock(filt->thread_data[i].lock);
-      while (!filt->thread_data[i].done)
-         scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-      slock_unlock(filt->thread_data[i].lock);
+      unsigned band_width, band_height, rows;
+      const uint8_t *src = NULL;
+      size_t src_stride  = 0;
+      unsigned y_end     = y + seg->band_rows;
+      unsigned first     = y * scale;
+      unsigned end;
+      unsigned in_height = height * scale;
+
+      if (y_end > height)
+         y_end = height;
+      end = y_end * scale;
+
+      /* Rows each pass has to filter, from the last pass back. */
+      for (k = seg->count - 1; k >= 0; k--)
+      {
+         unsigned pass_scale = passes[k].scale;
+
+         in_height /= pass_scale;
+         first      = first / pass_scale;
+         end        = (end + pass_scale - 1) / pass_scale;
+
+         first = first > SOFTFILTER_BAND_HALO ?
+            first - SOFTFILTER_BAND_HALO : 0;
+         end  += SOFTFILTER_BAND_HALO;
+         if (end > in_height)
+            end = in_height;
+
+         in_first[k] = first;
+         in_last[k]  = end;
+      }
+
+      src        = input + in_first[0] * input_stride;
+      src_stride = input_stride;
+      band_width = width;
+
+      for (k = 0; k < (int)seg->count; k++)
+      {
+         struct softfilter_pass *pass = &passes[k];
+
+         rows = in_last[k] - in_first[k];
+         softfilter_process_pass(filt, pass,
+               pass->band, pass->band_stride,
+               src, band_width, rows, src_stride);
+         pass->impl->query_output_size(pass->impl_data,
+               &band_width, &band_height, band_width, rows);
+
+         if (pass == last)
+            break;
+
+         /* The next pass starts a few rows into this band. */
+         src = pass->band + (in_first[k + 1] - 
+               in_first[k] * pass->scale) * pass->band_stride;
+         src_stride = pass->band_stride;
+      }
+
+      /* Keep only the rows of this band. */
+      first = y * scale;
+      src   = last->band + (first - 
+            in_first[seg->count - 1] * last->scale) * last->band_stride;
+
+      for (rows = first; rows < y_end * scale; rows++)
+      {
+         memcpy(output + rows * output_stride, src,
+               band_width * softfilter_bpp(last->out_pix_fmt));
+         src += last->band_stride;
+      }
    }
-#else
-   for (i = 0; i < filt->threads; i++)
-      filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
-#endif
 }
 
+void rarch_softfilter_process(rarch_softfilter_t *filt,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height, size_t input_stride)
+{
+   unsigned i;
+
+   if (!filt)
+      return;
+
+   for (i = 0; i < filt->num_segments; i++)
+   {
+      const struct softfilter_segment *seg = &filt->segments[i];
+      struct softfilter_pass *last = 
+         &filt->passes[seg->first + seg->count - 1];
+      void *dst         = output;
+      size_t dst_stride = output_stride;
+      unsigned j;
+
+      if (i + 1 < filt->num_segments)
+      {
+         dst        = last->frame;
+         dst_stride = last->frame_stride;
+      }
+
+      if (seg->band_rows)
+         softfilter_process_bands(filt, seg,
+               (uint8_t*)dst, dst_stride,
+               (const uint8_t*)input, width, height, input_stride);
+      else
+         softfilter_process_pass(filt, last, dst, dst_stride,
+               input, width, height, input_stride);
+
+      for (j = seg->first; j < seg->first + seg->count; j++)
+      {
+         const struct softfilter_pass *pass = &filt->passes[j];
+         pass->impl->query_output_size(pass->impl_data,
+               &width, &height, width, height);
+      }
+
+      input        = dst;
+      input_stride = dst_stride;
+   }
+}
@@ -37,6 +37,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <boolean.h>
+#include <retro_inline.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TWOXBR_SIMD SOFTFILTER_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TWOXBR_SIMD SOFTFILTER_SIMD_NEON
+#endif
+
+/* The per-pixel filter is big enough that GCC would otherwise
+ * leave it out of line, which costs more than the filter on
+ * flat content. */
+#if defined(__GNUC__)
+#define TWOXBR_PIXEL_INLINE INLINE __attribute__((always_inline))
+#else
+#define TWOXBR_PIXEL_INLINE INLINE
+#endif
 
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation twoxbr_get_implementation
@@ -67,6 +86,12 @@ struct filter_data
    uint16_t RGBtoYUV[65536];
    uint16_t tbl_5_to_8[32];
    uint16_t tbl_6_to_8[64];
+   /* Products of df8()'s YUV conversion, indexed by the
+    * absolute difference of a channel. */
+   double y_r[256], y_g[256], y_b[256];
+   double u_r[256], u_g[256], u_b[256];
+   double v_r[256], v_g[256], v_b[256];
+   bool simd;
 };
  
 static unsigned twoxbr_generic_input_fmts(void)
@@ -218,6 +243,19 @@ static void SetupFormat(void * data)
       v = ((r << 1) - (g << 1) - (b >> 1));
       filt->RGBtoYUV[c] = y + u + v;
    }
+
+   for (c = 0; c < 256; c++)
+   {
+      filt->y_r[c] =  0.299*c;
+      filt->y_g[c] =  0.587*c;
+      filt->y_b[c] =  0.114*c;
+      filt->u_r[c] = -0.169*c;
+      filt->u_g[c] =  0.331*c;
+      filt->u_b[c] =  0.500*c;
+      filt->v_r[c] =  0.500*c;
+      filt->v_g[c] =  0.419*c;
+      filt->v_b[c] =  0.081*c;
+   }
 }
  
 static void *twoxbr_generic_create(const struct softfilter_config *config,
@@ -225,7 +263,6 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
-   (void)simd;
    (void)config;
    (void)userdata;
  
@@ -244,6 +281,10 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
 
    SetupFormat(filt);
 
+#ifdef TWOXBR_SIMD
+   filt->simd = (simd & TWOXBR_SIMD) != 0;
+#endif
+
    return filt;
 }
  
@@ -417,11 +458,15 @@ static void twoxbr_generic_destroy(void *data)
  
 
 
-float df8(uint32_t A, uint32_t B,
-      uint32_t pg_red_mask, uint32_t pg_green_mask, uint32_t pg_blue_mask)
+/* df8() and eq8() take the YUV difference of two XRGB8888 pixels
+ * through the per-channel product tables set up in SetupFormat(),
+ * summed in the same order as the products would be. */
+static INLINE void yuv8(const struct filter_data *filt,
+      uint32_t A, uint32_t B,
+      uint32_t pg_red_mask, uint32_t pg_green_mask, uint32_t pg_blue_mask,
+      uint32_t *y, uint32_t *u, uint32_t *v)
 {
    uint32_t r, g, b;
-   uint32_t y, u, v;
 
 #ifdef MSB_FIRST
    r = abs((int)(((A & pg_red_mask  )>>24) - ((B & pg_red_mask  )>> 24)));
@@ -433,32 +478,29 @@ float df8(uint32_t A, uint32_t B,
    r = abs((int)(((A & pg_red_mask        ) -  (B & pg_red_mask         ))));
 #endif
 
-   y = fabs(0.299*r + 0.587*g + 0.114*b);
-   u = fabs(-0.169*r - 0.331*g + 0.500*b);
-   v = fabs(0.500*r - 0.419*g - 0.081*b);
+   *y = fabs(filt->y_r[r] + filt->y_g[g] + filt->y_b[b]);
+   *u = fabs(filt->u_r[r] - filt->u_g[g] + filt->u_b[b]);
+   *v = fabs(filt->v_r[r] - filt->v_g[g] - filt->v_b[b]);
+}
+
+static INLINE float df8(const struct filter_data *filt,
+      uint32_t A, uint32_t B,
+      uint32_t pg_red_mask, uint32_t pg_green_mask, uint32_t pg_blue_mask)
+{
+   uint32_t y, u, v;
+
+   yuv8(filt, A, B, pg_red_mask, pg_green_mask, pg_blue_mask, &y, &u, &v);
 
    return 48*y + 7*u + 6*v;
 }
 
-int eq8(uint32_t A, uint32_t B,
+static INLINE int eq8(const struct filter_data *filt,
+      uint32_t A, uint32_t B,
       uint32_t pg_red_mask, uint32_t pg_green_mask, uint32_t pg_blue_mask)
 {
-    uint32_t r, g, b;
     uint32_t y, u, v;
-   
-#ifdef MSB_FIRST
-   r = abs((int)(((A & pg_red_mask  )>>24) - ((B & pg_red_mask  )>> 24)));
-   g = abs((int)(((A & pg_green_mask  )>>16) - ((B & pg_green_mask  )>> 16)));
-   b = abs((int)(((A & pg_blue_mask  )>>8 ) - ((B & pg_blue_mask  )>> 8 )));
-#else
-   b = abs((int)(((A & pg_blue_mask  )>>16) - ((B & pg_blue_mask  )>> 16)));
-   g = abs((int)(((A & pg_green_mask)>>8  ) - ((B & pg_green_mask )>>  8)));
-   r = abs((int)(((A & pg_red_mask        ) -  (B & pg_red_mask         ))));
-#endif
-   
-    y = fabs(0.299*r + 0.587*g + 0.114*b);
-    u = fabs(-0.169*r - 0.331*g + 0.500*b);
-    v = fabs(0.500*r - 0.419*g - 0.081*b);
+
+    yuv8(filt, A, B, pg_red_mask, pg_green_mask, pg_blue_mask, &y, &u, &v);
 
     return ((48 >= y) && (7 >= u) && (6 >= v)) ? 1 : 0;
 }
@@ -502,14 +544,14 @@ int eq8(uint32_t A, uint32_t B,
      ex   = (PE!=PH && PE!=PF); \
      if ( ex )\
      {\
-          e = (df8(PE,PC, pg_red_mask, pg_green_mask, pg_blue_mask ) + df8(PE,PG, pg_red_mask, pg_green_mask, pg_blue_mask) + \
-                df8(_PI,H5, pg_red_mask, pg_green_mask, pg_blue_mask ) + df8(_PI,F4, pg_red_mask, pg_green_mask, pg_blue_mask))+(4 * (df8(PH,PF, pg_red_mask, pg_green_mask, pg_blue_mask))); \
-          i = (df8(PH,PD, pg_red_mask, pg_green_mask, pg_blue_mask) + df8(PH,I5, pg_red_mask, pg_green_mask, pg_blue_mask) + \
-                df8(PF,I4, pg_red_mask, pg_green_mask, pg_blue_mask) + df8(PF,PB, pg_red_mask, pg_green_mask, pg_blue_mask))+(4 * (df8(PE,_PI, pg_red_mask, pg_green_mask, pg_blue_mask))); \
-          if ((e<i)  && ( (!eq8(PF,PB, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(PF,PC, pg_red_mask, pg_green_mask, pg_blue_mask)) || (!eq8(PH,PD, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(PH,PG, pg_red_mask, pg_green_mask, pg_blue_mask)) || (eq8(PE,_PI, pg_red_mask, pg_green_mask, pg_blue_mask) && ((!eq8(PF,F4, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(PF,I4, pg_red_mask, pg_green_mask, pg_blue_mask)) || (!eq8(PH,H5, pg_red_mask, pg_green_mask,pg_blue_mask) && !eq8(PH,I5, pg_red_mask, pg_green_mask, pg_blue_mask)))) || eq8(PE,PG, pg_red_mask, pg_green_mask, pg_blue_mask) || eq8(PE,PC, pg_red_mask, pg_green_mask, pg_blue_mask)) )\
+          e = (df8(Z, PE,PC, pg_red_mask, pg_green_mask, pg_blue_mask ) + df8(Z, PE,PG, pg_red_mask, pg_green_mask, pg_blue_mask) + \
+                df8(Z, _PI,H5, pg_red_mask, pg_green_mask, pg_blue_mask ) + df8(Z, _PI,F4, pg_red_mask, pg_green_mask, pg_blue_mask))+(4 * (df8(Z, PH,PF, pg_red_mask, pg_green_mask, pg_blue_mask))); \
+          i = (df8(Z, PH,PD, pg_red_mask, pg_green_mask, pg_blue_mask) + df8(Z, PH,I5, pg_red_mask, pg_green_mask, pg_blue_mask) + \
+                df8(Z, PF,I4, pg_red_mask, pg_green_mask, pg_blue_mask) + df8(Z, PF,PB, pg_red_mask, pg_green_mask, pg_blue_mask))+(4 * (df8(Z, PE,_PI, pg_red_mask, pg_green_mask, pg_blue_mask))); \
+          if ((e<i)  && ( (!eq8(Z, PF,PB, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(Z, PF,PC, pg_red_mask, pg_green_mask, pg_blue_mask)) || (!eq8(Z, PH,PD, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(Z, PH,PG, pg_red_mask, pg_green_mask, pg_blue_mask)) || (eq8(Z, PE,_PI, pg_red_mask, pg_green_mask, pg_blue_mask) && ((!eq8(Z, PF,F4, pg_red_mask, pg_green_mask, pg_blue_mask) && !eq8(Z, PF,I4, pg_red_mask, pg_green_mask, pg_blue_mask)) || (!eq8(Z, PH,H5, pg_red_mask, pg_green_mask,pg_blue_mask) && !eq8(Z, PH,I5, pg_red_mask, pg_green_mask, pg_blue_mask)))) || eq8(Z, PE,PG, pg_red_mask, pg_green_mask, pg_blue_mask) || eq8(Z, PE,PC, pg_red_mask, pg_green_mask, pg_blue_mask)) )\
           {\
-              ke=df8(PF,PG, pg_red_mask, pg_green_mask, pg_blue_mask); ki=df8(PH,PC, pg_red_mask, pg_green_mask, pg_blue_mask); \
-              ex2 = (PE!=PC && PB!=PC); ex3 = (PE!=PG && PD!=PG); px = (df8(PE,PF, pg_red_mask, pg_green_mask, pg_blue_mask) <= df8(PE,PH, pg_red_mask, pg_green_mask, pg_blue_mask)) ? PF : PH; \
+              ke=df8(Z, PF,PG, pg_red_mask, pg_green_mask, pg_blue_mask); ki=df8(Z, PH,PC, pg_red_mask, pg_green_mask, pg_blue_mask); \
+              ex2 = (PE!=PC && PB!=PC); ex3 = (PE!=PG && PD!=PG); px = (df8(Z, PE,PF, pg_red_mask, pg_green_mask, pg_blue_mask) <= df8(Z, PE,PH, pg_red_mask, pg_green_mask, pg_blue_mask)) ? PF : PH; \
               if ( ((ke<<1)<=ki) && ex3 && (ke>=(ki<<1)) && ex2 ) \
               {\
                      LEFT_UP_2_8888_2X(N3, N2, N1, px)\
@@ -529,7 +571,7 @@ int eq8(uint32_t A, uint32_t B,
           }\
           else if (e<=i)\
           {\
-               ALPHA_BLEND_128_W( E[N3], ((df8(PE,PF, pg_red_mask, pg_green_mask, pg_blue_mask) <= df8(PE,PH, pg_red_mask, pg_green_mask, pg_blue_mask)) ? PF : PH)); \
+               ALPHA_BLEND_128_W( E[N3], ((df8(Z, PE,PF, pg_red_mask, pg_green_mask, pg_blue_mask) <= df8(Z, PE,PH, pg_red_mask, pg_green_mask, pg_blue_mask)) ? PF : PH)); \
           }\
      }\
  
@@ -544,68 +586,279 @@ int eq8(uint32_t A, uint32_t B,
          out[0] = E[0]; \
          out[1] = E[1]; \
          out[dst_stride] = E[2]; \
-         out[dst_stride + 1] = E[3]; \
-         ++in; \
-         out += 2
+         out[dst_stride + 1] = E[3]
 #endif
  
  
-static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
-      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+static TWOXBR_PIXEL_INLINE void twoxbr_pixel_xrgb8888(struct filter_data *filt,
+      const uint32_t *in, uint32_t *out,
+      unsigned nextline, unsigned dst_stride)
 {
-   unsigned nextline, finish;
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
    uint32_t pg_lbmask        = PG_LBMASK8888;
    uint32_t pg_alpha_mask    = ALPHA_MASK8888;
-   struct filter_data *filt = (struct filter_data*)data;
+   uint32_t E[4];
+   uint32_t ex, e, i, ke, ki, ex2, ex3, px;
+   uint32_t A1 = *(in - nextline - nextline - 1);
+   uint32_t B1 = *(in - nextline - nextline);
+   uint32_t C1 = *(in - nextline - nextline + 1);
+   uint32_t A0 = *(in - nextline - 2);
+   uint32_t PA = *(in - nextline - 1);
+   uint32_t PB = *(in - nextline);
+   uint32_t PC = *(in - nextline + 1);
+   uint32_t C4 = *(in - nextline + 2);
+   uint32_t D0 = *(in - 2);
+   uint32_t PD = *(in - 1);
+   uint32_t PE = *(in);
+   uint32_t PF = *(in + 1);
+   uint32_t F4 = *(in + 2);
+   uint32_t G0 = *(in + nextline - 2);
+   uint32_t PG = *(in + nextline - 1);
+   uint32_t PH = *(in + nextline);
+   uint32_t _PI = *(in + nextline + 1);
+   uint32_t I4 = *(in + nextline + 2);
+   uint32_t G5 = *(in + nextline + nextline - 1);
+   uint32_t H5 = *(in + nextline + nextline);
+   uint32_t I5 = *(in + nextline + nextline + 1);
+
+   /*
+    * Map of the pixels:          A1 B1 C1
+    *                          A0 PA PB PC C4
+    *                          D0 PD PE PF F4
+    *                          G0 PG PH _PI I4
+    *                             G5 H5 I5
+    */
+
+   twoxbr_function(FILTRO_RGB8888, filt);
+}
+
+static TWOXBR_PIXEL_INLINE void twoxbr_pixel_rgb565(struct filter_data *filt,
+      const uint16_t *in, uint16_t *out,
+      unsigned nextline, unsigned dst_stride)
+{
+   uint16_t pg_red_mask   = RED_MASK565;
+   uint16_t pg_green_mask = GREEN_MASK565;
+   uint16_t pg_blue_mask  = BLUE_MASK565;
+   uint16_t pg_lbmask     = PG_LBMASK565;
+   uint16_t E[4];
+   uint16_t ex, e, i, ke, ki, ex2, ex3, px;
+   uint16_t A1 = *(in - nextline - nextline - 1);
+   uint16_t B1 = *(in - nextline - nextline);
+   uint16_t C1 = *(in - nextline - nextline + 1);
+   uint16_t A0 = *(in - nextline - 2);
+   uint16_t PA = *(in - nextline - 1);
+   uint16_t PB = *(in - nextline);
+   uint16_t PC = *(in - nextline + 1);
+   uint16_t C4 = *(in - nextline + 2);
+   uint16_t D0 = *(in - 2);
+   uint16_t PD = *(in - 1);
+   uint16_t PE = *(in);
+   uint16_t PF = *(in + 1);
+   uint16_t F4 = *(in + 2);
+   uint16_t G0 = *(in + nextline - 2);
+   uint16_t PG = *(in + nextline - 1);
+   uint16_t PH = *(in + nextline);
+   uint16_t _PI = *(in + nextline + 1);
+   uint16_t I4 = *(in + nextline + 2);
+   uint16_t G5 = *(in + nextline + nextline - 1);
+   uint16_t H5 = *(in + nextline + nextline);
+   uint16_t I5 = *(in + nextline + nextline + 1);
+
+   /*
+    * Map of the pixels:          A1 B1 C1
+    *                          A0 PA PB PC C4
+    *                          D0 PD PE PF F4
+    *                          G0 PG PH _PI I4
+    *                             G5 H5 I5
+    */
+
+   twoxbr_function(FILTRO_RGB565, filt);
+}
 
-   (void)filt;
+/* A corner of the output is only ever blended when the two
+ * neighbours next to it (PB, PF, PH, PD) both differ from PE.
+ * The SIMD kernels find the pixels of a vector for which that
+ * holds at no corner and write them out as plain 2x2 copies of
+ * PE. They return a mask of those pixels, the C code does the
+ * others. */
+#if defined(__SSE2__)
+static INLINE unsigned twoxbr_flat_xrgb8888_simd(const uint32_t *in,
+      uint32_t *out, unsigned nextline, unsigned dst_stride)
+{
+   unsigned k;
+   __m128i pe   = _mm_loadu_si128((const __m128i*)in);
+   __m128i pb   = _mm_cmpeq_epi32(pe,
+         _mm_loadu_si128((const __m128i*)(in - nextline)));
+   __m128i pd   = _mm_cmpeq_epi32(pe,
+         _mm_loadu_si128((const __m128i*)(in - 1)));
+   __m128i pf   = _mm_cmpeq_epi32(pe,
+         _mm_loadu_si128((const __m128i*)(in + 1)));
+   __m128i ph   = _mm_cmpeq_epi32(pe,
+         _mm_loadu_si128((const __m128i*)(in + nextline)));
+   __m128i flat = _mm_and_si128(
+         _mm_and_si128(_mm_or_si128(ph, pf), _mm_or_si128(pf, pb)),
+         _mm_and_si128(_mm_or_si128(pb, pd), _mm_or_si128(pd, ph)));
+   unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(flat));
+
+   if (mask == 0xf)
+   {
+      __m128i lo = _mm_unpacklo_epi32(pe, pe);
+      __m128i hi = _mm_unpackhi_epi32(pe, pe);
+      _mm_storeu_si128((__m128i*)out, lo);
+      _mm_storeu_si128((__m128i*)(out + 4), hi);
+      _mm_storeu_si128((__m128i*)(out + dst_stride), lo);
+      _mm_storeu_si128((__m128i*)(out + dst_stride + 4), hi);
+      return mask;
+   }
+
+   for (k = 0; k < 4; k++)
+      if (mask & (1 << k))
+         out[2 * k] = out[2 * k + 1] = out[dst_stride + 2 * k] =
+            out[dst_stride + 2 * k + 1] = in[k];
+
+   return mask;
+}
+
+static INLINE unsigned twoxbr_flat_rgb565_simd(const uint16_t *in,
+      uint16_t *out, unsigned nextline, unsigned dst_stride)
+{
+   unsigned k;
+   __m128i pe   = _mm_loadu_si128((const __m128i*)in);
+   __m128i pb   = _mm_cmpeq_epi16(pe,
+         _mm_loadu_si128((const __m128i*)(in - nextline)));
+   __m128i pd   = _mm_cmpeq_epi16(pe,
+         _mm_loadu_si128((const __m128i*)(in - 1)));
+   __m128i pf   = _mm_cmpeq_epi16(pe,
+         _mm_loadu_si128((const __m128i*)(in + 1)));
+   __m128i ph   = _mm_cmpeq_epi16(pe,
+         _mm_loadu_si128((const __m128i*)(in + nextline)));
+   __m128i flat = _mm_and_si128(
+         _mm_and_si128(_mm_or_si128(ph, pf), _mm_or_si128(pf, pb)),
+         _mm_and_si128(_mm_or_si128(pb, pd), _mm_or_si128(pd, ph)));
+   unsigned mask = _mm_movemask_epi8(
+         _mm_packs_epi16(flat, _mm_setzero_si128()));
+
+   if (mask == 0xff)
+   {
+      __m128i lo = _mm_unpacklo_epi16(pe, pe);
+      __m128i hi = _mm_unpackhi_epi16(pe, pe);
+      _mm_storeu_si128((__m128i*)out, lo);
+      _mm_storeu_si128((__m128i*)(out + 8), hi);
+      _mm_storeu_si128((__m128i*)(out + dst_stride), lo);
+      _mm_storeu_si128((__m128i*)(out + dst_stride + 8), hi);
+      return mask;
+   }
+
+   for (k = 0; k < 8; k++)
+      if (mask & (1 << k))
+         out[2 * k] = out[2 * k + 1] = out[dst_stride + 2 * k] =
+            out[dst_stride + 2 * k + 1] = in[k];
+
+   return mask;
+}
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+static INLINE unsigned twoxbr_flat_xrgb8888_simd(const uint32_t *in,
+      uint32_t *out, unsigned nextline, unsigned dst_stride)
+{
+   static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+   unsigned k, mask;
+   uint32x2_t bits;
+   uint32x4_t pe   = vld1q_u32(in);
+   uint32x4_t pb   = vceqq_u32(pe, vld1q_u32(in - nextline));
+   uint32x4_t pd   = vceqq_u32(pe, vld1q_u32(in - 1));
+   uint32x4_t pf   = vceqq_u32(pe, vld1q_u32(in + 1));
+   uint32x4_t ph   = vceqq_u32(pe, vld1q_u32(in + nextline));
+   uint32x4_t flat = vandq_u32(
+         vandq_u32(vorrq_u32(ph, pf), vorrq_u32(pf, pb)),
+         vandq_u32(vorrq_u32(pb, pd), vorrq_u32(pd, ph)));
+
+   flat = vandq_u32(flat, vld1q_u32(lane_bits));
+   bits = vorr_u32(vget_low_u32(flat), vget_high_u32(flat));
+   mask = vget_lane_u32(bits, 0) | vget_lane_u32(bits, 1);
+
+   if (mask == 0xf)
+   {
+      uint32x4x2_t line;
+      line.val[0] = pe;
+      line.val[1] = pe;
+      vst2q_u32(out, line);
+      vst2q_u32(out + dst_stride, line);
+      return mask;
+   }
+
+   for (k = 0; k < 4; k++)
+      if (mask & (1 << k))
+         out[2 * k] = out[2 * k + 1] = out[dst_stride + 2 * k] =
+            out[dst_stride + 2 * k + 1] = in[k];
+
+   return mask;
+}
+
+static INLINE unsigned twoxbr_flat_rgb565_simd(const uint16_t *in,
+      uint16_t *out, unsigned nextline, unsigned dst_stride)
+{
+   static const uint16_t lane_bits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+   unsigned k, mask;
+   uint32x2_t bits;
+   uint16x8_t pe   = vld1q_u16(in);
+   uint16x8_t pb   = vceqq_u16(pe, vld1q_u16(in - nextline));
+   uint16x8_t pd   = vceqq_u16(pe, vld1q_u16(in - 1));
+   uint16x8_t pf   = vceqq_u16(pe, vld1q_u16(in + 1));
+   uint16x8_t ph   = vceqq_u16(pe, vld1q_u16(in + nextline));
+   uint16x8_t flat = vandq_u16(
+         vandq_u16(vorrq_u16(ph, pf), vorrq_u16(pf, pb)),
+         vandq_u16(vorrq_u16(pb, pd), vorrq_u16(pd, ph)));
+
+   flat = vandq_u16(flat, vld1q_u16(lane_bits));
+   bits = vreinterpret_u32_u16(
+         vorr_u16(vget_low_u16(flat), vget_high_u16(flat)));
+   mask = vget_lane_u32(bits, 0) | vget_lane_u32(bits, 1);
+   mask = (mask | (mask >> 16)) & 0xff;
+
+   if (mask == 0xff)
+   {
+      uint16x8x2_t line;
+      line.val[0] = pe;
+      line.val[1] = pe;
+      vst2q_u16(out, line);
+      vst2q_u16(out + dst_stride, line);
+      return mask;
+   }
+
+   for (k = 0; k < 8; k++)
+      if (mask & (1 << k))
+         out[2 * k] = out[2 * k + 1] = out[dst_stride + 2 * k] =
+            out[dst_stride + 2 * k + 1] = in[k];
+
+   return mask;
+}
+#endif
+
+static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   unsigned nextline, x;
+   unsigned flat = 0;
+   struct filter_data *filt = (struct filter_data*)data;
 
    nextline = (last) ? 0 : src_stride;
    
    for (; height; height--)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
- 
-      for (finish = width; finish; finish -= 1)
+      for (x = 0; x < width; x++)
       {
-         uint32_t E[4];
-         uint32_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint32_t A1 = *(in - nextline - nextline - 1);
-         uint32_t B1 = *(in - nextline - nextline);
-         uint32_t C1 = *(in - nextline - nextline + 1);
-         uint32_t A0 = *(in - nextline - 2);
-         uint32_t PA = *(in - nextline - 1);
-         uint32_t PB = *(in - nextline);
-         uint32_t PC = *(in - nextline + 1);
-         uint32_t C4 = *(in - nextline + 2);
-         uint32_t D0 = *(in - 2);
-         uint32_t PD = *(in - 1);
-         uint32_t PE = *(in);
-         uint32_t PF = *(in + 1);
-         uint32_t F4 = *(in + 2);
-         uint32_t G0 = *(in + nextline - 2);
-         uint32_t PG = *(in + nextline - 1);
-         uint32_t PH = *(in + nextline);
-         uint32_t _PI = *(in + nextline + 1);
-         uint32_t I4 = *(in + nextline + 2);
-         uint32_t G5 = *(in + nextline + nextline - 1);
-         uint32_t H5 = *(in + nextline + nextline);
-         uint32_t I5 = *(in + nextline + nextline + 1);
- 
-         /*
-          * Map of the pixels:          A1 B1 C1
-          *                          A0 PA PB PC C4
-          *                          D0 PD PE PF F4
-          *                          G0 PG PH _PI I4
-          *                             G5 H5 I5
-          */
- 
-         twoxbr_function(FILTRO_RGB8888, filt);
+#ifdef TWOXBR_SIMD
+         if (filt->simd && !(x & 3))
+            flat = (x + 4 <= width) ? twoxbr_flat_xrgb8888_simd(src + x,
+                  dst + 2 * x, nextline, dst_stride) : 0;
+         if (flat & (1 << (x & 3)))
+            continue;
+#endif
+         twoxbr_pixel_xrgb8888(filt, src + x, dst + 2 * x,
+               nextline, dst_stride);
       }
  
       src += src_stride;
@@ -617,57 +870,25 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
       int first, int last, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   uint16_t pg_red_mask, pg_green_mask, pg_blue_mask, pg_lbmask;
-   unsigned nextline, finish;
+   unsigned nextline, x;
+   unsigned flat = 0;
    struct filter_data *filt = (struct filter_data*)data;
 
-   pg_red_mask   = RED_MASK565;
-   pg_green_mask = GREEN_MASK565;
-   pg_blue_mask  = BLUE_MASK565;
-   pg_lbmask     = PG_LBMASK565;
    nextline = (last) ? 0 : src_stride;
-   
  
    for (; height; height--)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
- 
-      for (finish = width; finish; finish -= 1)
+      for (x = 0; x < width; x++)
       {
-         uint16_t E[4];
-         uint16_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint16_t A1 = *(in - nextline - nextline - 1);
-         uint16_t B1 = *(in - nextline - nextline);
-         uint16_t C1 = *(in - nextline - nextline + 1);
-         uint16_t A0 = *(in - nextline - 2);
-         uint16_t PA = *(in - nextline - 1);
-         uint16_t PB = *(in - nextline);
-         uint16_t PC = *(in - nextline + 1);
-         uint16_t C4 = *(in - nextline + 2);
-         uint16_t D0 = *(in - 2);
-         uint16_t PD = *(in - 1);
-         uint16_t PE = *(in);
-         uint16_t PF = *(in + 1);
-         uint16_t F4 = *(in + 2);
-         uint16_t G0 = *(in + nextline - 2);
-         uint16_t PG = *(in + nextline - 1);
-         uint16_t PH = *(in + nextline);
-         uint16_t _PI = *(in + nextline + 1);
-         uint16_t I4 = *(in + nextline + 2);
-         uint16_t G5 = *(in + nextline + nextline - 1);
-         uint16_t H5 = *(in + nextline + nextline);
-         uint16_t I5 = *(in + nextline + nextline + 1);
- 
-         /*
-          * Map of the pixels:          A1 B1 C1
-          *                          A0 PA PB PC C4
-          *                          D0 PD PE PF F4
-          *                          G0 PG PH _PI I4
-          *                             G5 H5 I5
-          */
- 
-         twoxbr_function(FILTRO_RGB565, filt);
+#ifdef TWOXBR_SIMD
+         if (filt->simd && !(x & 7))
+            flat = (x + 8 <= width) ? twoxbr_flat_rgb565_simd(src + x,
+                  dst + 2 * x, nextline, dst_stride) : 0;
+         if (flat & (1 << (x & 7)))
+            continue;
+#endif
+         twoxbr_pixel_rgb565(filt, src + x, dst + 2 * x,
+               nextline, dst_stride);
       }
  
       src += src_stride;
@@ -758,6 +979,7 @@ static const struct softfilter_implementation twoxbr_generic = {
    SOFTFILTER_API_VERSION,
    "2xBR",
    "2xbr",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
  
 const struct softfilter_implementation *softfilter_get_implementation(
@@ -374,6 +374,7 @@ static const struct softfilter_implementation twoxsai_generic = {
    SOFTFILTER_API_VERSION,
    "2xSaI",
    "2xsai",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
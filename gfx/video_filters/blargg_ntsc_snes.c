@@ -19,9 +19,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <boolean.h>
+#include <retro_inline.h>
 #include "snes_ntsc/snes_ntsc.h"
 #include "snes_ntsc/snes_ntsc.c"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation blargg_ntsc_snes_get_implementation
 #define softfilter_thread_data blargg_ntsc_snes_softfilter_thread_data
@@ -41,12 +48,18 @@ struct softfilter_thread_data
    int last;
 };
 
+typedef void (*blargg_ntsc_snes_blit_t)(snes_ntsc_t const *ntsc,
+      SNES_NTSC_IN_T const *input, long in_row_width,
+      int burst_phase, int in_width, int in_height,
+      void *rgb_out, long out_pitch, int first, int last);
+
 struct filter_data
 {
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
    struct snes_ntsc_t *ntsc;
+   blargg_ntsc_snes_blit_t blit;
    int burst;
    int burst_toggle;
 };
@@ -116,13 +129,189 @@ static void blargg_ntsc_snes_initialize(void *data,
    filt->burst_toggle = (setup.merge_fields ? 0 : 1);
 }
 
+/* The SIMD blitters are snes_ntsc_blit() turned around: every
+ * output pixel is the sum of six kernel entries, and the seven
+ * output pixels of a chunk are built as two vectors of four, the
+ * last lane of the second one being thrown away. With n0..n2 the
+ * kernels of the chunk's input pixels, c0..c2 those of the chunk
+ * before and p1, p2 those of the chunk before that:
+ *
+ * out[0..3] = n0[0..3] + c0[7..10] + c1[19..22] + c2[31..34] +
+ *             p2[38..41] + n1[12..15] (lanes 2, 3) +
+ *             p1[26..29] (lanes 0, 1)
+ * out[4..7] = n0[4..7] + c0[11..14] + n1[16..19] + c1[23..26] +
+ *             n2[28..31] + c2[35..38]
+ *
+ * Hires frames still go through snes_ntsc_blit_hires(). */
+#if defined(__SSE2__)
+#define BLARGG_NTSC_LOAD(kernel, i) \
+   _mm_loadu_si128((const __m128i*)((kernel) + (i)))
+
+static INLINE __m128i blargg_ntsc_snes_rgb565_sse2(__m128i raw)
+{
+   __m128i sub   = _mm_and_si128(_mm_srli_epi32(raw, 8),
+         _mm_set1_epi32(snes_ntsc_clamp_mask));
+   __m128i clamp = _mm_sub_epi32(_mm_set1_epi32(snes_ntsc_clamp_add), sub);
+
+   raw   = _mm_or_si128(raw, clamp);
+   clamp = _mm_sub_epi32(clamp, sub);
+   raw   = _mm_and_si128(raw, clamp);
+
+   raw = _mm_or_si128(_mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(raw, 12), _mm_set1_epi32(0xF800)),
+            _mm_and_si128(_mm_srli_epi32(raw,  7), _mm_set1_epi32(0x07E0))),
+         _mm_and_si128(_mm_srli_epi32(raw,  3), _mm_set1_epi32(0x001F)));
+
+   /* Sign-extend, so the saturating pack keeps all 16 bits. */
+   return _mm_srai_epi32(_mm_slli_epi32(raw, 16), 16);
+}
+
+static INLINE __m128i blargg_ntsc_snes_chunk_sse2(
+      const snes_ntsc_rgb_t *n0, const snes_ntsc_rgb_t *n1,
+      const snes_ntsc_rgb_t *n2, const snes_ntsc_rgb_t *c0,
+      const snes_ntsc_rgb_t *c1, const snes_ntsc_rgb_t *c2,
+      const snes_ntsc_rgb_t *p1, const snes_ntsc_rgb_t *p2)
+{
+   const __m128i lanes01 = _mm_set_epi32(0, 0, -1, -1);
+   __m128i lo = _mm_add_epi32(BLARGG_NTSC_LOAD(n0, 0), BLARGG_NTSC_LOAD(c0, 7));
+   __m128i hi = _mm_add_epi32(BLARGG_NTSC_LOAD(n0, 4), BLARGG_NTSC_LOAD(c0, 11));
+
+   lo = _mm_add_epi32(lo, BLARGG_NTSC_LOAD(c1, 19));
+   lo = _mm_add_epi32(lo, BLARGG_NTSC_LOAD(c2, 31));
+   lo = _mm_add_epi32(lo, BLARGG_NTSC_LOAD(p2, 38));
+   lo = _mm_add_epi32(lo, _mm_andnot_si128(lanes01, BLARGG_NTSC_LOAD(n1, 12)));
+   lo = _mm_add_epi32(lo, _mm_and_si128(lanes01, BLARGG_NTSC_LOAD(p1, 26)));
+
+   hi = _mm_add_epi32(hi, BLARGG_NTSC_LOAD(n1, 16));
+   hi = _mm_add_epi32(hi, BLARGG_NTSC_LOAD(c1, 23));
+   hi = _mm_add_epi32(hi, BLARGG_NTSC_LOAD(n2, 28));
+   hi = _mm_add_epi32(hi, BLARGG_NTSC_LOAD(c2, 35));
+
+   return _mm_packs_epi32(blargg_ntsc_snes_rgb565_sse2(lo),
+         blargg_ntsc_snes_rgb565_sse2(hi));
+}
+
+#define BLARGG_NTSC_CHUNK(out, n0, n1, n2, c0, c1, c2, p1, p2) \
+   _mm_storeu_si128((__m128i*)(out), \
+         blargg_ntsc_snes_chunk_sse2(n0, n1, n2, c0, c1, c2, p1, p2))
+#define blargg_ntsc_snes_blit_simd blargg_ntsc_snes_blit_sse2
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define BLARGG_NTSC_LOAD(kernel, i) vld1q_u32((kernel) + (i))
+
+static INLINE uint16x4_t blargg_ntsc_snes_rgb565_neon(uint32x4_t raw)
+{
+   uint32x4_t sub   = vandq_u32(vshrq_n_u32(raw, 8),
+         vdupq_n_u32(snes_ntsc_clamp_mask));
+   uint32x4_t clamp = vsubq_u32(vdupq_n_u32(snes_ntsc_clamp_add), sub);
+
+   raw   = vorrq_u32(raw, clamp);
+   clamp = vsubq_u32(clamp, sub);
+   raw   = vandq_u32(raw, clamp);
+
+   raw = vorrq_u32(vorrq_u32(
+            vandq_u32(vshrq_n_u32(raw, 12), vdupq_n_u32(0xF800)),
+            vandq_u32(vshrq_n_u32(raw,  7), vdupq_n_u32(0x07E0))),
+         vandq_u32(vshrq_n_u32(raw,  3), vdupq_n_u32(0x001F)));
+
+   return vmovn_u32(raw);
+}
+
+static INLINE uint16x8_t blargg_ntsc_snes_chunk_neon(
+      const snes_ntsc_rgb_t *n0, const snes_ntsc_rgb_t *n1,
+      const snes_ntsc_rgb_t *n2, const snes_ntsc_rgb_t *c0,
+      const snes_ntsc_rgb_t *c1, const snes_ntsc_rgb_t *c2,
+      const snes_ntsc_rgb_t *p1, const snes_ntsc_rgb_t *p2)
+{
+   const uint32x4_t lanes01 = vcombine_u32(vdup_n_u32(~0u), vdup_n_u32(0));
+   uint32x4_t lo = vaddq_u32(BLARGG_NTSC_LOAD(n0, 0), BLARGG_NTSC_LOAD(c0, 7));
+   uint32x4_t hi = vaddq_u32(BLARGG_NTSC_LOAD(n0, 4), BLARGG_NTSC_LOAD(c0, 11));
+
+   lo = vaddq_u32(lo, BLARGG_NTSC_LOAD(c1, 19));
+   lo = vaddq_u32(lo, BLARGG_NTSC_LOAD(c2, 31));
+   lo = vaddq_u32(lo, BLARGG_NTSC_LOAD(p2, 38));
+   lo = vaddq_u32(lo, vbicq_u32(BLARGG_NTSC_LOAD(n1, 12), lanes01));
+   lo = vaddq_u32(lo, vandq_u32(BLARGG_NTSC_LOAD(p1, 26), lanes01));
+
+   hi = vaddq_u32(hi, BLARGG_NTSC_LOAD(n1, 16));
+   hi = vaddq_u32(hi, BLARGG_NTSC_LOAD(c1, 23));
+   hi = vaddq_u32(hi, BLARGG_NTSC_LOAD(n2, 28));
+   hi = vaddq_u32(hi, BLARGG_NTSC_LOAD(c2, 35));
+
+   return vcombine_u16(blargg_ntsc_snes_rgb565_neon(lo),
+         blargg_ntsc_snes_rgb565_neon(hi));
+}
+
+#define BLARGG_NTSC_CHUNK(out, n0, n1, n2, c0, c1, c2, p1, p2) \
+   vst1q_u16((out), \
+         blargg_ntsc_snes_chunk_neon(n0, n1, n2, c0, c1, c2, p1, p2))
+#define blargg_ntsc_snes_blit_simd blargg_ntsc_snes_blit_neon
+#endif
+
+#ifdef BLARGG_NTSC_CHUNK
+static void blargg_ntsc_snes_blit_simd(snes_ntsc_t const *ntsc,
+      SNES_NTSC_IN_T const *input, long in_row_width,
+      int burst_phase, int in_width, int in_height,
+      void *rgb_out, long out_pitch, int first, int last)
+{
+   int chunk_count = (in_width - 1) / snes_ntsc_in_chunk;
+
+   (void)first;
+   (void)last;
+
+   for (; in_height; --in_height)
+   {
+      int n;
+      uint16_t tail[8];
+      SNES_NTSC_IN_T const *line_in = input;
+      uint16_t *line_out = (uint16_t*)rgb_out;
+      char const *ktable = (char const*)ntsc->table +
+         burst_phase * (snes_ntsc_burst_size * sizeof(snes_ntsc_rgb_t));
+      const snes_ntsc_rgb_t *black =
+         SNES_NTSC_IN_FORMAT(ktable, snes_ntsc_black);
+      const snes_ntsc_rgb_t *c0 = black;
+      const snes_ntsc_rgb_t *c1 = black;
+      const snes_ntsc_rgb_t *c2 = SNES_NTSC_IN_FORMAT(ktable, line_in[0]);
+      const snes_ntsc_rgb_t *p1 = black;
+      const snes_ntsc_rgb_t *p2 = black;
+
+      ++line_in;
+
+      for (n = chunk_count; n; --n)
+      {
+         const snes_ntsc_rgb_t *n0 = SNES_NTSC_IN_FORMAT(ktable, line_in[0]);
+         const snes_ntsc_rgb_t *n1 = SNES_NTSC_IN_FORMAT(ktable, line_in[1]);
+         const snes_ntsc_rgb_t *n2 = SNES_NTSC_IN_FORMAT(ktable, line_in[2]);
+
+         /* The eighth pixel is overwritten by the next chunk. */
+         BLARGG_NTSC_CHUNK(line_out, n0, n1, n2, c0, c1, c2, p1, p2);
+
+         p1 = c1;
+         p2 = c2;
+         c0 = n0;
+         c1 = n1;
+         c2 = n2;
+
+         line_in  += 3;
+         line_out += 7;
+      }
+
+      /* Finish final pixels, without writing past the row. */
+      BLARGG_NTSC_CHUNK(tail, black, black, black, c0, c1, c2, p1, p2);
+      memcpy(line_out, tail, 7 * sizeof(*line_out));
+
+      burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
+      input += in_row_width;
+      rgb_out = (char*)rgb_out + out_pitch;
+   }
+}
+#endif
+
 static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *config,
       unsigned in_fmt, unsigned out_fmt,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
-   (void)simd;
-
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
    if (!filt)
       return NULL;
@@ -138,6 +327,15 @@ static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *con
 
    blargg_ntsc_snes_initialize(filt, config, userdata);
 
+   filt->blit = snes_ntsc_blit;
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      filt->blit = blargg_ntsc_snes_blit_sse2;
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+   if (simd & SOFTFILTER_SIMD_NEON)
+      filt->blit = blargg_ntsc_snes_blit_neon;
+#endif
+
    return filt;
 }
 
@@ -170,7 +368,7 @@ static void blargg_ntsc_snes_render_rgb565(void *data, int width, int height,
 {
    struct filter_data *filt = (struct filter_data*)data;
    if(width <= 256)
-      snes_ntsc_blit(filt->ntsc, input, pitch, filt->burst,
+      filt->blit(filt->ntsc, input, pitch, filt->burst,
             width, height, output, outpitch * 2, first, last);
    else
       snes_ntsc_blit_hires(filt->ntsc, input, pitch, filt->burst,
@@ -251,6 +449,7 @@ static const struct softfilter_implementation blargg_ntsc_snes_generic = {
    SOFTFILTER_API_VERSION,
    "Blargg NTSC SNES",
    "blargg_ntsc_snes",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
@@ -176,6 +176,7 @@ static const struct softfilter_implementation darken = {
    SOFTFILTER_API_VERSION,
    "Darken",
    "darken",
+   0,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
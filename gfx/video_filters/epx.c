@@ -438,6 +438,7 @@ static const struct softfilter_implementation epx_generic = {
    SOFTFILTER_API_VERSION,
    "EPX",
    "epx",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
@@ -282,6 +282,7 @@ static const struct softfilter_implementation lq2x_generic = {
    SOFTFILTER_API_VERSION,
    "LQ2x",
    "lq2x",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
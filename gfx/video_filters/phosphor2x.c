@@ -21,6 +21,14 @@
 #include <math.h>
 #include <retro_inline.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PHOSPHOR2X_SIMD SOFTFILTER_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PHOSPHOR2X_SIMD SOFTFILTER_SIMD_NEON
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation phosphor2x_get_implementation
 #define softfilter_thread_data phosphor2x_softfilter_thread_data
@@ -56,6 +64,12 @@ struct filter_data
    float phosphor_bloom_565[64];
    float scan_range_8888[256];
    float scan_range_565[64];
+   /* Bled value of a component, indexed by the component. */
+   uint8_t bleed_8888[256];
+   uint8_t bleed_green_8888[256];
+   uint8_t bleed_565[64];
+   uint8_t bleed_green_565[64];
+   bool simd;
 };
 
 
@@ -105,17 +119,258 @@ static INLINE unsigned max_component_rgb565(uint32_t color)
    return max;
 }
 
-static void blit_linear_line_xrgb8888(uint32_t * out,
+/* The SIMD kernels handle as much of a line as they can and
+ * return the number of pixels done; the C code finishes it. */
+#if defined(__SSE2__)
+static unsigned blit_linear_line_xrgb8888_simd(uint32_t *out,
       const uint32_t *in, unsigned width)
 {
    unsigned i;
+   const __m128i mask = _mm_set1_epi32(0x7f7f7f7f);
+
+   /* Stops short of the last pixel, which is blended
+    * against black. */
+   for (i = 0; i + 4 < width; i += 4)
+   {
+      __m128i a   = _mm_loadu_si128((const __m128i*)(in + i));
+      __m128i b   = _mm_loadu_si128((const __m128i*)(in + i + 1));
+      __m128i mid = _mm_add_epi32(
+            _mm_and_si128(_mm_srli_epi32(a, 1), mask),
+            _mm_and_si128(_mm_srli_epi32(b, 1), mask));
+
+      _mm_storeu_si128((__m128i*)(out + (i << 1)),
+            _mm_unpacklo_epi32(a, mid));
+      _mm_storeu_si128((__m128i*)(out + (i << 1) + 4),
+            _mm_unpackhi_epi32(a, mid));
+   }
+
+   return i;
+}
+
+static unsigned blit_linear_line_rgb565_simd(uint16_t *out,
+      const uint16_t *in, unsigned width)
+{
+   unsigned i;
+   const __m128i mask = _mm_set1_epi16((short)0xF7DE);
+
+   for (i = 0; i + 8 < width; i += 8)
+   {
+      __m128i a   = _mm_loadu_si128((const __m128i*)(in + i));
+      __m128i b   = _mm_loadu_si128((const __m128i*)(in + i + 1));
+      __m128i mid = _mm_add_epi16(
+            _mm_srli_epi16(_mm_and_si128(a, mask), 1),
+            _mm_srli_epi16(_mm_and_si128(b, mask), 1));
+
+      _mm_storeu_si128((__m128i*)(out + (i << 1)),
+            _mm_unpacklo_epi16(a, mid));
+      _mm_storeu_si128((__m128i*)(out + (i << 1) + 8),
+            _mm_unpackhi_epi16(a, mid));
+   }
+
+   return i;
+}
+
+static unsigned scanlines_xrgb8888_simd(const float *scan_range,
+      uint32_t *scan_out, const uint32_t *in, unsigned width)
+{
+   unsigned x;
+   const __m128i mask = _mm_set1_epi32(0xff);
+
+   for (x = 0; x + 4 <= width; x += 4)
+   {
+      int max[4];
+      __m128 scale;
+      __m128i pix = _mm_loadu_si128((const __m128i*)(in + x));
+      __m128i r   = _mm_and_si128(_mm_srli_epi32(pix, 16), mask);
+      __m128i g   = _mm_and_si128(_mm_srli_epi32(pix,  8), mask);
+      __m128i b   = _mm_and_si128(pix, mask);
+
+      _mm_storeu_si128((__m128i*)max,
+            _mm_max_epi16(_mm_max_epi16(r, g), b));
+      scale = _mm_setr_ps(scan_range[max[0]], scan_range[max[1]],
+            scan_range[max[2]], scan_range[max[3]]);
+
+      r = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(r)));
+      g = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(g)));
+      b = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(b)));
+
+      _mm_storeu_si128((__m128i*)(scan_out + x), _mm_or_si128(
+               _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(g, 8)), b));
+   }
+
+   return x;
+}
+
+static unsigned scanlines_rgb565_simd(const float *scan_range,
+      uint16_t *scan_out, const uint16_t *in, unsigned width)
+{
+   unsigned x;
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i mask_rb = _mm_set1_epi32(0x3e);
+   const __m128i mask_g  = _mm_set1_epi32(0x3f);
+
+   for (x = 0; x + 4 <= width; x += 4)
+   {
+      int max[4];
+      __m128 scale;
+      __m128i pix = _mm_unpacklo_epi16(
+            _mm_loadl_epi64((const __m128i*)(in + x)), zero);
+      __m128i r   = _mm_and_si128(_mm_srli_epi32(pix, 10), mask_rb);
+      __m128i g   = _mm_and_si128(_mm_srli_epi32(pix,  5), mask_g);
+      __m128i b   = _mm_and_si128(_mm_slli_epi32(pix,  1), mask_rb);
+
+      _mm_storeu_si128((__m128i*)max,
+            _mm_max_epi16(_mm_max_epi16(r, g), b));
+      scale = _mm_setr_ps(scan_range[max[0]], scan_range[max[1]],
+            scan_range[max[2]], scan_range[max[3]]);
+
+      r = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(r)));
+      g = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(g)));
+      b = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(b)));
+
+      pix = _mm_or_si128(_mm_or_si128(
+               _mm_slli_epi32(_mm_and_si128(r, mask_rb), 10),
+               _mm_slli_epi32(_mm_and_si128(g, mask_g),   5)),
+            _mm_srli_epi32(_mm_and_si128(b, mask_rb), 1));
+      /* Sign-extend, so the saturating pack keeps all 16 bits. */
+      pix = _mm_srai_epi32(_mm_slli_epi32(pix, 16), 16);
+      _mm_storel_epi64((__m128i*)(scan_out + x), _mm_packs_epi32(pix, pix));
+   }
+
+   return x;
+}
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+static unsigned blit_linear_line_xrgb8888_simd(uint32_t *out,
+      const uint32_t *in, unsigned width)
+{
+   unsigned i;
+   const uint32x4_t mask = vdupq_n_u32(0x7f7f7f7f);
+
+   for (i = 0; i + 4 < width; i += 4)
+   {
+      uint32x4x2_t line;
+      uint32x4_t a = vld1q_u32(in + i);
+      uint32x4_t b = vld1q_u32(in + i + 1);
+
+      line.val[0] = a;
+      line.val[1] = vaddq_u32(vandq_u32(vshrq_n_u32(a, 1), mask),
+            vandq_u32(vshrq_n_u32(b, 1), mask));
+      vst2q_u32(out + (i << 1), line);
+   }
+
+   return i;
+}
+
+static unsigned blit_linear_line_rgb565_simd(uint16_t *out,
+      const uint16_t *in, unsigned width)
+{
+   unsigned i;
+   const uint16x8_t mask = vdupq_n_u16(0xF7DE);
+
+   for (i = 0; i + 8 < width; i += 8)
+   {
+      uint16x8x2_t line;
+      uint16x8_t a = vld1q_u16(in + i);
+      uint16x8_t b = vld1q_u16(in + i + 1);
+
+      line.val[0] = a;
+      line.val[1] = vaddq_u16(vshrq_n_u16(vandq_u16(a, mask), 1),
+            vshrq_n_u16(vandq_u16(b, mask), 1));
+      vst2q_u16(out + (i << 1), line);
+   }
+
+   return i;
+}
+
+static unsigned scanlines_xrgb8888_simd(const float *scan_range,
+      uint32_t *scan_out, const uint32_t *in, unsigned width)
+{
+   unsigned x;
+   const uint32x4_t mask = vdupq_n_u32(0xff);
+
+   for (x = 0; x + 4 <= width; x += 4)
+   {
+      uint32_t max[4];
+      float scales[4];
+      float32x4_t scale;
+      uint32x4_t pix = vld1q_u32(in + x);
+      uint32x4_t r   = vandq_u32(vshrq_n_u32(pix, 16), mask);
+      uint32x4_t g   = vandq_u32(vshrq_n_u32(pix,  8), mask);
+      uint32x4_t b   = vandq_u32(pix, mask);
+
+      vst1q_u32(max, vmaxq_u32(vmaxq_u32(r, g), b));
+      scales[0] = scan_range[max[0]];
+      scales[1] = scan_range[max[1]];
+      scales[2] = scan_range[max[2]];
+      scales[3] = scan_range[max[3]];
+      scale = vld1q_f32(scales);
+
+      r = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(r)));
+      g = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(g)));
+      b = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(b)));
+
+      vst1q_u32(scan_out + x, vorrq_u32(
+               vorrq_u32(vshlq_n_u32(r, 16), vshlq_n_u32(g, 8)), b));
+   }
+
+   return x;
+}
+
+static unsigned scanlines_rgb565_simd(const float *scan_range,
+      uint16_t *scan_out, const uint16_t *in, unsigned width)
+{
+   unsigned x;
+   const uint32x4_t mask_rb = vdupq_n_u32(0x3e);
+   const uint32x4_t mask_g  = vdupq_n_u32(0x3f);
+
+   for (x = 0; x + 4 <= width; x += 4)
+   {
+      uint32_t max[4];
+      float scales[4];
+      float32x4_t scale;
+      uint32x4_t pix = vmovl_u16(vld1_u16(in + x));
+      uint32x4_t r   = vandq_u32(vshrq_n_u32(pix, 10), mask_rb);
+      uint32x4_t g   = vandq_u32(vshrq_n_u32(pix,  5), mask_g);
+      uint32x4_t b   = vandq_u32(vshlq_n_u32(pix,  1), mask_rb);
+
+      vst1q_u32(max, vmaxq_u32(vmaxq_u32(r, g), b));
+      scales[0] = scan_range[max[0]];
+      scales[1] = scan_range[max[1]];
+      scales[2] = scan_range[max[2]];
+      scales[3] = scan_range[max[3]];
+      scale = vld1q_f32(scales);
+
+      r = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(r)));
+      g = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(g)));
+      b = vcvtq_u32_f32(vmulq_f32(scale, vcvtq_f32_u32(b)));
+
+      pix = vorrq_u32(vorrq_u32(
+               vshlq_n_u32(vandq_u32(r, mask_rb), 10),
+               vshlq_n_u32(vandq_u32(g, mask_g),   5)),
+            vshrq_n_u32(vandq_u32(b, mask_rb), 1));
+      vst1_u16(scan_out + x, vmovn_u32(pix));
+   }
+
+   return x;
+}
+#endif
+
+static void blit_linear_line_xrgb8888(const struct filter_data *filt,
+      uint32_t * out, const uint32_t *in, unsigned width)
+{
+   unsigned i, done = 0;
+
+#ifdef PHOSPHOR2X_SIMD
+   if (filt->simd)
+      done = blit_linear_line_xrgb8888_simd(out, in, width);
+#endif
 
    /* Splat pixels out on the line. */
-   for (i = 0; i < width; i++)
+   for (i = done; i < width; i++)
       out[i << 1] = in[i];
 
    /* Blend in-between pixels. */
-   for (i = 1; i < (width << 1) - 1; i += 2)
+   for (i = (done << 1) + 1; i < (width << 1) - 1; i += 2)
       out[i] = blend_pixels_xrgb8888(out[i - 1], out[i + 1]);
 
    /* Blend edge pixels against black. */
@@ -124,17 +379,22 @@ static void blit_linear_line_xrgb8888(uint32_t * out,
       blend_pixels_xrgb8888(out[(width << 1) - 1], 0);
 }
 
-static void blit_linear_line_rgb565(uint16_t * out,
-      const uint16_t *in, unsigned width)
+static void blit_linear_line_rgb565(const struct filter_data *filt,
+      uint16_t * out, const uint16_t *in, unsigned width)
 {
-   unsigned i;
+   unsigned i, done = 0;
+
+#ifdef PHOSPHOR2X_SIMD
+   if (filt->simd)
+      done = blit_linear_line_rgb565_simd(out, in, width);
+#endif
 
    /* Splat pixels out on the line. */
-   for (i = 0; i < width; i++)
+   for (i = done; i < width; i++)
       out[i << 1] = in[i];
 
    /* Blend in-between pixels. */
-   for (i = 1; i < (width << 1) - 1; i += 2)
+   for (i = (done << 1) + 1; i < (width << 1) - 1; i += 2)
       out[i] = 
          blend_pixels_rgb565(out[i - 1], out[i + 1]);
 
@@ -154,18 +414,14 @@ static void bleed_phosphors_xrgb8888(void *data,
    for (x = 0; x < width; x += 2)
    {
       unsigned r = red_xrgb8888(scanline[x]);
-      unsigned r_set = clamp8(r * filt->phosphor_bleed * 
-            filt->phosphor_bloom_8888[r]);
-      set_red_xrgb8888(scanline[x + 1], r_set);
+      set_red_xrgb8888(scanline[x + 1], filt->bleed_8888[r]);
    }
 
    /* Green phosphor */
    for (x = 0; x < width; x++)
    {
       unsigned g = green_xrgb8888(scanline[x]);
-      unsigned g_set = clamp8((g >> 1) + 0.5 * g * 
-            filt->phosphor_bleed * filt->phosphor_bloom_8888[g]);
-      set_green_xrgb8888(scanline[x], g_set);
+      set_green_xrgb8888(scanline[x], filt->bleed_green_8888[g]);
    }
 
    /* Blue phosphor */
@@ -173,9 +429,7 @@ static void bleed_phosphors_xrgb8888(void *data,
    for (x = 1; x < width; x += 2)
    {
       unsigned b = blue_xrgb8888(scanline[x]);
-      unsigned b_set = clamp8(b * filt->phosphor_bleed * 
-            filt->phosphor_bloom_8888[b]);
-      set_blue_xrgb8888(scanline[x + 1], b_set);
+      set_blue_xrgb8888(scanline[x + 1], filt->bleed_8888[b]);
    }
 }
 
@@ -189,18 +443,14 @@ static void bleed_phosphors_rgb565(void *data,
    for (x = 0; x < width; x += 2)
    {
       unsigned r = red_rgb565(scanline[x]);
-      unsigned r_set = clamp6(r * filt->phosphor_bleed * 
-            filt->phosphor_bloom_565[r]);
-      set_red_rgb565(scanline[x + 1], r_set);
+      set_red_rgb565(scanline[x + 1], filt->bleed_565[r]);
    }
 
    /* Green phosphor */
    for (x = 0; x < width; x++)
    {
       unsigned g = green_rgb565(scanline[x]);
-      unsigned g_set = clamp6((g >> 1) + 0.5 * g * 
-            filt->phosphor_bleed * filt->phosphor_bloom_565[g]);
-      set_green_rgb565(scanline[x], g_set);
+      set_green_rgb565(scanline[x], filt->bleed_green_565[g]);
    }
 
    /* Blue phosphor */
@@ -208,9 +458,7 @@ static void bleed_phosphors_rgb565(void *data,
    for (x = 1; x < width; x += 2)
    {
       unsigned b = blue_rgb565(scanline[x]);
-      unsigned b_set = clamp6(b * filt->phosphor_bleed * 
-            filt->phosphor_bloom_565[b]);
-      set_blue_rgb565(scanline[x + 1], b_set);
+      set_blue_rgb565(scanline[x + 1], filt->bleed_565[b]);
    }
 }
 
@@ -238,7 +486,6 @@ static void *phosphor2x_generic_create(const struct softfilter_config *config,
    unsigned i;
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
 
-   (void)simd;
    (void)out_fmt;
    (void)max_width;
    (void)max_height;
@@ -277,6 +524,10 @@ static void *phosphor2x_generic_create(const struct softfilter_config *config,
       filt->scan_range_8888[i] = 
          filt->scanrange_low + i * 
          (filt->scanrange_high - filt->scanrange_low) / 255.0f;
+      filt->bleed_8888[i] = clamp8(i * filt->phosphor_bleed * 
+            filt->phosphor_bloom_8888[i]);
+      filt->bleed_green_8888[i] = clamp8((i >> 1) + 0.5 * i * 
+            filt->phosphor_bleed * filt->phosphor_bloom_8888[i]);
    }
    for (i = 0; i < 64; i++)
    {
@@ -286,8 +537,16 @@ static void *phosphor2x_generic_create(const struct softfilter_config *config,
       filt->scan_range_565[i] = 
          filt->scanrange_low + i * 
          (filt->scanrange_high - filt->scanrange_low) / 31.0f;
+      filt->bleed_565[i] = clamp6(i * filt->phosphor_bleed * 
+            filt->phosphor_bloom_565[i]);
+      filt->bleed_green_565[i] = clamp6((i >> 1) + 0.5 * i * 
+            filt->phosphor_bleed * filt->phosphor_bloom_565[i]);
    }
 
+#ifdef PHOSPHOR2X_SIMD
+   filt->simd = (simd & PHOSPHOR2X_SIMD) != 0;
+#endif
+
    return filt;
 }
 
@@ -334,7 +593,7 @@ static void phosphor2x_generic_xrgb8888(void *data,
       out_line = (uint32_t*)(dst + y * (dst_stride) * 2);
 
       /* Bilinear stretch horizontally. */
-      blit_linear_line_xrgb8888(out_line, in_line, width);
+      blit_linear_line_xrgb8888(filt, out_line, in_line, width);
 
       /* Mask 'n bleed phosphors */
       bleed_phosphors_xrgb8888(filt, out_line, width << 1);
@@ -343,7 +602,14 @@ static void phosphor2x_generic_xrgb8888(void *data,
 
       scan_out = (uint32_t*)out_line + (dst_stride);
 
-      for (x = 0; x < (width << 1); x++)
+      x = 0;
+#ifdef PHOSPHOR2X_SIMD
+      if (filt->simd)
+         x = scanlines_xrgb8888_simd(filt->scan_range_8888,
+               scan_out, out_line, width << 1);
+#endif
+
+      for (; x < (width << 1); x++)
       {
          unsigned max = max_component_xrgb8888(out_line[x]);
          set_red_xrgb8888(scan_out[x],  
@@ -381,7 +647,7 @@ static void phosphor2x_generic_rgb565(void *data,
       const uint16_t *in_line = (const uint16_t*)(src + y * (src_stride));
 
       /* Bilinear stretch horizontally. */
-      blit_linear_line_rgb565(out_line, in_line, width);
+      blit_linear_line_rgb565(filt, out_line, in_line, width);
 
       /* Mask 'n bleed phosphors. */
       bleed_phosphors_rgb565(filt, out_line, width << 1);
@@ -389,7 +655,14 @@ static void phosphor2x_generic_rgb565(void *data,
       /* Apply scanlines. */
       scan_out = (uint16_t*)(out_line + (dst_stride));
 
-      for (x = 0; x < (width << 1); x++)
+      x = 0;
+#ifdef PHOSPHOR2X_SIMD
+      if (filt->simd)
+         x = scanlines_rgb565_simd(filt->scan_range_565,
+               scan_out, out_line, width << 1);
+#endif
+
+      for (; x < (width << 1); x++)
       {
          unsigned max = max_component_rgb565(out_line[x]);
          set_red_rgb565(scan_out[x],   
@@ -488,6 +761,7 @@ static const struct softfilter_implementation phosphor2x_generic = {
    SOFTFILTER_API_VERSION,
    "Phosphor2x",
    "phosphor2x",
+   0,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
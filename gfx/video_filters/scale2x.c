@@ -247,6 +247,7 @@ static const struct softfilter_implementation scale2x_generic = {
    SOFTFILTER_API_VERSION,
    "Scale2x",
    "scale2x",
+   SOFTFILTER_FLAG_WHOLE_FRAME,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
@@ -133,7 +133,10 @@ statement in a block (unless you're using C++). */
 /* private */
 enum { snes_ntsc_entry_size = 128 };
 enum { snes_ntsc_palette_size = 0x2000 };
-typedef unsigned long snes_ntsc_rgb_t;
+/* Only the low 30 bits of an entry are ever used. 32 bits wide
+on every host, so LP64 builds don't carry an 8 MB table around and
+entries can be loaded four to a SIMD register. */
+typedef unsigned int snes_ntsc_rgb_t;
 struct snes_ntsc_t {
 	snes_ntsc_rgb_t table [snes_ntsc_palette_size] [snes_ntsc_entry_size];
 };
@@ -92,7 +92,15 @@ typedef const struct softfilter_implementation
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd);
 
-#define SOFTFILTER_API_VERSION  2
+#define SOFTFILTER_API_VERSION  3
+
+/* Implementation flags */
+
+/* The filter must be given whole frames, as it keeps state from 
+ * one frame to the next, or handles the first and last rows of 
+ * a frame as edges. Otherwise, passes of a chain may be run in 
+ * bands of a few rows. */
+#define SOFTFILTER_FLAG_WHOLE_FRAME (1 << 0)
 
 /* Required base color formats */
 
@@ -171,13 +179,16 @@ struct softfilter_implementation
    softfilter_query_output_size_t query_output_size;
    softfilter_get_work_packets_t get_work_packets;
 
-   /* Must be SOFTFILTER_API_VERSION. */
+   /* Must be SOFTFILTER_API_VERSION. Version 2 plugs, which
+    * lack flags, are still loaded and given whole frames. */
    unsigned api_version;
    /* Human readable identifier of implementation. */
    const char *ident;
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+   /* SOFTFILTER_FLAG_* bits. */
+   unsigned flags;
 };
 
 #ifdef __cplusplus
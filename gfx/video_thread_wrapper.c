@@ -19,6 +19,7 @@
 #include "../performance.h"
 #include "../runloop.h"
 #include <file/dir_list.h>
+#include <rthreads/rthreads_atomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
@@ -84,12 +85,129 @@ static void thread_update_driver_state(thread_video_t *thr)
    }
 }
 
+/**
+ * thread_handle_packet:
+ * @thr                  : Threaded video handle.
+ * @pkt                  : Command taken from the ring.
+ *
+ * Runs a fire-and-forget command on the driver thread.
+ **/
+static void thread_handle_packet(thread_video_t *thr,
+      const struct thread_packet *pkt)
+{
+   switch (pkt->type)
+   {
+      case CMD_SET_ROTATION:
+         if (thr->driver && thr->driver->set_rotation)
+            thr->driver->set_rotation(thr->driver_data, pkt->data.i);
+         break;
+
+#ifdef HAVE_OVERLAY
+      case CMD_OVERLAY_ENABLE:
+         if (thr->overlay && thr->overlay->enable)
+            thr->overlay->enable(thr->driver_data, pkt->data.b);
+         break;
+
+      case CMD_OVERLAY_TEX_GEOM:
+         if (thr->overlay && thr->overlay->tex_geom)
+            thr->overlay->tex_geom(thr->driver_data,
+                  pkt->data.rect.index,
+                  pkt->data.rect.x,
+                  pkt->data.rect.y,
+                  pkt->data.rect.w,
+                  pkt->data.rect.h);
+         break;
+
+      case CMD_OVERLAY_VERTEX_GEOM:
+         if (thr->overlay && thr->overlay->vertex_geom)
+            thr->overlay->vertex_geom(thr->driver_data,
+                  pkt->data.rect.index,
+                  pkt->data.rect.x,
+                  pkt->data.rect.y,
+                  pkt->data.rect.w,
+                  pkt->data.rect.h);
+         break;
+
+      case CMD_OVERLAY_FULL_SCREEN:
+         if (thr->overlay && thr->overlay->full_screen)
+            thr->overlay->full_screen(thr->driver_data, pkt->data.b);
+         break;
+#endif
+
+      case CMD_POKE_SET_VIDEO_MODE:
+         if (thr->poke && thr->poke->set_video_mode)
+            thr->poke->set_video_mode(thr->driver_data,
+                  pkt->data.new_mode.width,
+                  pkt->data.new_mode.height,
+                  pkt->data.new_mode.fullscreen);
+         break;
+
+      case CMD_POKE_SET_FILTERING:
+         if (thr->poke && thr->poke->set_filtering)
+            thr->poke->set_filtering(thr->driver_data,
+                  pkt->data.filtering.index,
+                  pkt->data.filtering.smooth);
+         break;
+
+      case CMD_POKE_GET_VIDEO_OUTPUT_PREV:
+         if (thr->poke && thr->poke->get_video_output_prev)
+            thr->poke->get_video_output_prev(thr->driver_data);
+         break;
+
+      case CMD_POKE_GET_VIDEO_OUTPUT_NEXT:
+         if (thr->poke && thr->poke->get_video_output_next)
+            thr->poke->get_video_output_next(thr->driver_data);
+         break;
+
+      case CMD_POKE_SET_ASPECT_RATIO:
+         if (thr->poke && thr->poke->set_aspect_ratio)
+            thr->poke->set_aspect_ratio(thr->driver_data, pkt->data.i);
+         break;
+
+      default:
+         break;
+   }
+}
+
+/**
+ * thread_run_packets:
+ * @thr                  : Threaded video handle.
+ *
+ * Runs all commands queued in the ring, in order.
+ **/
+static void thread_run_packets(thread_video_t *thr)
+{
+   for (;;)
+   {
+      struct thread_packet pkt;
+
+      slock_lock(thr->lock);
+      if (thr->ring.head == thr->ring.tail)
+      {
+         slock_unlock(thr->lock);
+         return;
+      }
+
+      /* Wake up the caller if it waits for room. */
+      if (thr->ring.tail - thr->ring.head == THREAD_CMD_RING_SIZE)
+         scond_signal(thr->cond_cmd);
+
+      pkt = thr->ring.packets[thr->ring.head % THREAD_CMD_RING_SIZE];
+      thr->ring.head++;
+      slock_unlock(thr->lock);
+
+      thread_handle_packet(thr, &pkt);
+   }
+}
+
 static void thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
    unsigned i = 0;
    (void)i;
 
+   rarch_perf_trace_thread_name("video");
+
    for (;;)
    {
       enum thread_cmd send_cmd;
@@ -97,9 +215,11 @@ static void thread_loop(void *data)
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_NONE && !thr->frame.updated)
+      while (thr->send_cmd == CMD_NONE &&
+            thr->ring.head == thr->ring.tail &&
+            !(satomic_load(&thr->frame.pending) & THREAD_FRAME_FRESH))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
+      if (satomic_load(&thr->frame.pending) & THREAD_FRAME_FRESH)
          updated = true;
 
       /* To avoid race condition where send_cmd is updated 
@@ -108,6 +228,10 @@ static void thread_loop(void *data)
       send_cmd = thr->send_cmd;
       slock_unlock(thr->lock);
 
+      /* Commands queued before a reply-bound command or a frame 
+       * must have run by then. */
+      thread_run_packets(thr);
+
       switch (send_cmd)
       {
          case CMD_INIT:
@@ -125,15 +249,10 @@ static void thread_loop(void *data)
                   thr->driver->free(thr->driver_data);
             }
             thr->driver_data = NULL;
+            rarch_perf_thread_exit();
             thread_reply(thr, CMD_FREE);
             return;
 
-         case CMD_SET_ROTATION:
-            if (thr->driver && thr->driver->set_rotation)
-               thr->driver->set_rotation(thr->driver_data, thr->cmd_data.i);
-            thread_reply(thr, CMD_SET_ROTATION);
-            break;
-
          case CMD_READ_VIEWPORT:
          {
             struct video_viewport vp = {0};
@@ -192,12 +311,6 @@ static void thread_loop(void *data)
             break;
 
 #ifdef HAVE_OVERLAY
-         case CMD_OVERLAY_ENABLE:
-            if (thr->overlay && thr->overlay->enable)
-               thr->overlay->enable(thr->driver_data, thr->cmd_data.b);
-            thread_reply(thr, CMD_OVERLAY_ENABLE);
-            break;
-
          case CMD_OVERLAY_LOAD:
 
             if (thr->overlay && thr->overlay->load)
@@ -218,53 +331,8 @@ static void thread_loop(void *data)
             thread_reply(thr, CMD_OVERLAY_LOAD);
 
             break;
-
-         case CMD_OVERLAY_TEX_GEOM:
-            if (thr->overlay && thr->overlay->tex_geom)
-               thr->overlay->tex_geom(thr->driver_data,
-                     thr->cmd_data.rect.index,
-                     thr->cmd_data.rect.x,
-                     thr->cmd_data.rect.y,
-                     thr->cmd_data.rect.w,
-                     thr->cmd_data.rect.h);
-            thread_reply(thr, CMD_OVERLAY_TEX_GEOM);
-            break;
-
-         case CMD_OVERLAY_VERTEX_GEOM:
-            if (thr->overlay && thr->overlay->vertex_geom)
-               thr->overlay->vertex_geom(thr->driver_data,
-                     thr->cmd_data.rect.index,
-                     thr->cmd_data.rect.x,
-                     thr->cmd_data.rect.y,
-                     thr->cmd_data.rect.w,
-                     thr->cmd_data.rect.h);
-            thread_reply(thr, CMD_OVERLAY_VERTEX_GEOM);
-            break;
-
-         case CMD_OVERLAY_FULL_SCREEN:
-            if (thr->overlay && thr->overlay->full_screen)
-               thr->overlay->full_screen(thr->driver_data,
-                     thr->cmd_data.b);
-            thread_reply(thr, CMD_OVERLAY_FULL_SCREEN);
-            break;
 #endif
 
-         case CMD_POKE_SET_VIDEO_MODE:
-            if (thr->poke && thr->poke->set_video_mode)
-               thr->poke->set_video_mode(thr->driver_data,
-                     thr->cmd_data.new_mode.width,
-                     thr->cmd_data.new_mode.height,
-                     thr->cmd_data.new_mode.fullscreen);
-            thread_reply(thr, CMD_POKE_SET_VIDEO_MODE);
-            break;
-         case CMD_POKE_SET_FILTERING:
-            if (thr->poke && thr->poke->set_filtering)
-               thr->poke->set_filtering(thr->driver_data,
-                     thr->cmd_data.filtering.index,
-                     thr->cmd_data.filtering.smooth);
-            thread_reply(thr, CMD_POKE_SET_FILTERING);
-            break;
-
          case CMD_POKE_GET_VIDEO_OUTPUT_SIZE:
             if (thr->poke && thr->poke->get_video_output_size)
                thr->poke->get_video_output_size(thr->driver_data,
@@ -273,24 +341,6 @@ static void thread_loop(void *data)
             thread_reply(thr, CMD_POKE_GET_VIDEO_OUTPUT_SIZE);
             break;
 
-         case CMD_POKE_GET_VIDEO_OUTPUT_PREV:
-            if (thr->poke && thr->poke->get_video_output_prev)
-               thr->poke->get_video_output_prev(thr->driver_data);
-            thread_reply(thr, CMD_POKE_GET_VIDEO_OUTPUT_PREV);
-            break;
-
-         case CMD_POKE_GET_VIDEO_OUTPUT_NEXT:
-            if (thr->poke && thr->poke->get_video_output_next)
-               thr->poke->get_video_output_next(thr->driver_data);
-            thread_reply(thr, CMD_POKE_GET_VIDEO_OUTPUT_NEXT);
-            break;
-
-         case CMD_POKE_SET_ASPECT_RATIO:
-            thr->poke->set_aspect_ratio(thr->driver_data,
-                  thr->cmd_data.i);
-            thread_reply(thr, CMD_POKE_SET_ASPECT_RATIO);
-            break;
-
          case CMD_POKE_SET_OSD_MSG:
             if (thr->poke && thr->poke->set_osd_msg)
                thr->poke->set_osd_msg(thr->driver_data,
@@ -336,15 +386,23 @@ static void thread_loop(void *data)
          bool focus = false;
          bool has_windowed = true;
          struct video_viewport vp = {0};
+         const struct thread_frame_slot *slot = NULL;
+
+         /* Take the newest frame and hand back the one shown last. */
+         thr->frame.read = satomic_exchange(&thr->frame.pending,
+               thr->frame.read) & THREAD_FRAME_INDEX;
+         slot = &thr->frame.slots[thr->frame.read];
 
          slock_lock(thr->frame.lock);
 
          thread_update_driver_state(thr);
 
+         rarch_perf_trace_begin("video_frame");
          if (thr->driver && thr->driver->frame)
             ret = thr->driver->frame(thr->driver_data,
-               thr->frame.buffer, thr->frame.width, thr->frame.height,
-               thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL);
+               slot->dupe ? NULL : slot->buffer, slot->width, slot->height,
+               slot->pitch, *slot->msg ? slot->msg : NULL);
+         rarch_perf_trace_end("video_frame");
 
          slock_unlock(thr->frame.lock);
 
@@ -364,7 +422,6 @@ static void thread_loop(void *data)
          thr->alive = alive;
          thr->focus = focus;
          thr->has_windowed = has_windowed;
-         thr->frame.updated = false;
          thr->vp = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
@@ -383,9 +440,51 @@ static void thread_send_cmd(thread_video_t *thr, enum thread_cmd cmd)
 
 static void thread_wait_reply(thread_video_t *thr, enum thread_cmd cmd)
 {
+   retro_time_t start = rarch_get_time_usec();
+
+   RARCH_PERFORMANCE_INIT(thr_wait_reply);
+   RARCH_PERFORMANCE_START(thr_wait_reply);
+
    slock_lock(thr->lock);
    while (cmd != thr->reply_cmd)
       scond_wait(thr->cond_cmd, thr->lock);
+   thr->wait_time += rarch_get_time_usec() - start;
+   thr->wait_count++;
+   slock_unlock(thr->lock);
+
+   RARCH_PERFORMANCE_STOP(thr_wait_reply);
+}
+
+/**
+ * thread_push_packet:
+ * @thr                  : Threaded video handle.
+ * @pkt                  : Command to queue.
+ *
+ * Queues a command which needs no reply and returns without 
+ * waiting for it to run. Only blocks if the ring is full.
+ **/
+static void thread_push_packet(thread_video_t *thr,
+      const struct thread_packet *pkt)
+{
+   slock_lock(thr->lock);
+
+   if (thr->ring.tail - thr->ring.head == THREAD_CMD_RING_SIZE)
+   {
+      retro_time_t start = rarch_get_time_usec();
+
+      while (thr->ring.tail - thr->ring.head == THREAD_CMD_RING_SIZE)
+         scond_wait(thr->cond_cmd, thr->lock);
+      thr->wait_time += rarch_get_time_usec() - start;
+      thr->wait_count++;
+   }
+
+   thr->ring.packets[thr->ring.tail % THREAD_CMD_RING_SIZE] = *pkt;
+
+   /* The thread only sleeps on an empty ring. */
+   if (thr->ring.head == thr->ring.tail)
+      scond_signal(thr->cond_thread);
+   thr->ring.tail++;
+
    slock_unlock(thr->lock);
 }
 
@@ -449,9 +548,11 @@ static bool thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, unsigned pitch, const char *msg)
 {
    unsigned copy_stride;
-   const uint8_t *src  = NULL;
-   uint8_t *dst        = NULL;
-   thread_video_t *thr = (thread_video_t*)data;
+   int pending;
+   struct thread_frame_slot *slot = NULL;
+   const uint8_t *src             = NULL;
+   uint8_t *dst                   = NULL;
+   thread_video_t *thr            = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the 
     * driver thread, so just render directly. */
@@ -471,11 +572,6 @@ static bool thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32 
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
-
-   slock_lock(thr->lock);
-
    if (!thr->nonblock)
    {
       settings_t *settings = config_get_ptr();
@@ -484,8 +580,12 @@ static bool thread_frame(void *data, const void *frame_,
          roundf(1000000LL / settings->video.refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
-      /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      /* Pace to the display: give the thread up to a refresh 
+       * period to pick up the previous frame before replacing it.
+       * Ideally, use absolute time, but that is only a good idea 
+       * on POSIX. */
+      slock_lock(thr->lock);
+      while (satomic_load(&thr->frame.pending) & THREAD_FRAME_FRESH)
       {
          retro_time_t current = rarch_get_time_usec();
          retro_time_t delta = target - current;
@@ -496,43 +596,72 @@ static bool thread_frame(void *data, const void *frame_,
          if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
             break;
       }
+      slock_unlock(thr->lock);
+   }
+
+   /* A dupe only repeats what the thread shows next; published
+    * over a real frame it hasn't picked up yet, it would drop
+    * that frame. */
+   if (!frame_ && (satomic_load(&thr->frame.pending) & THREAD_FRAME_FRESH))
+   {
+      RARCH_PERFORMANCE_STOP(thr_frame);
+      thr->last_time = rarch_get_time_usec();
+      return true;
    }
 
-   /* Drop frame if updated flag is still set, as thread is 
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* The write slot belongs to us alone, so filling it needs 
+    * no lock. */
+   slot       = &thr->frame.slots[thr->frame.write];
+   slot->dupe = !frame_;
+
+   if (frame_)
    {
-      if (src)
+      src = (const uint8_t*)frame_;
+      dst = slot->buffer;
+
+      if (pitch == copy_stride)
+         memcpy(dst, src, copy_stride * height);
+      else
       {
          unsigned h;
          for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
       }
+   }
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.pitch  = copy_stride;
+   slot->width  = width;
+   slot->height = height;
+   slot->pitch  = copy_stride;
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   if (msg)
+      strlcpy(slot->msg, msg, sizeof(slot->msg));
+   else
+      *slot->msg = '\0';
 
-      scond_signal(thr->cond_thread);
+   /* Publish the slot. If the thread has not picked up the 
+    * previous frame yet, it is superseded and its slot reused. */
+   pending = satomic_exchange(&thr->frame.pending,
+         thr->frame.write | THREAD_FRAME_FRESH);
+   thr->frame.write = pending & THREAD_FRAME_INDEX;
 
-#if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
-   }
-   else
+   /* Only we set FRESH, so it can't have come back since the
+    * check above. */
+   rarch_assert(frame_ || !(pending & THREAD_FRAME_FRESH));
+
+   if (pending & THREAD_FRAME_FRESH)
       thr->miss_count++;
+   thr->hit_count++;
 
+   slock_lock(thr->lock);
+   scond_signal(thr->cond_thread);
+
+#if defined(HAVE_MENU)
+   if (thr->texture.enable)
+   {
+      while (satomic_load(&thr->frame.pending) & THREAD_FRAME_FRESH)
+         scond_wait(thr->cond_cmd, thr->lock);
+   }
+#endif
    slock_unlock(thr->lock);
 
    RARCH_PERFORMANCE_STOP(thr_frame);
@@ -551,6 +680,7 @@ static void thread_set_nonblock_state(void *data, bool state)
 static bool thread_init(thread_video_t *thr, const video_info_t *info,
       const input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
 
    thr->lock                 = slock_new();
@@ -569,12 +699,20 @@ static bool thread_init(thread_video_t *thr, const video_info_t *info,
    max_size                  = info->input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info->rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
-   thr->frame.buffer        = (uint8_t*)malloc(max_size);
 
-   if (!thr->frame.buffer)
-      return false;
+   for (i = 0; i < THREAD_FRAME_SLOTS; i++)
+   {
+      thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
+
+      if (!thr->frame.slots[i].buffer)
+         return false;
+
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   thr->frame.write   = 0;
+   thr->frame.read    = 1;
+   thr->frame.pending = 2;
 
    thr->last_time       = rarch_get_time_usec();
    thr->thread          = sthread_create(thread_loop, thr);
@@ -608,14 +746,15 @@ static bool thread_set_shader(void *data,
 
 static void thread_set_rotation(void *data, unsigned rotation)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
 
-   thr->cmd_data.i = rotation;
-   thread_send_cmd(thr, CMD_SET_ROTATION);
-   thread_wait_reply(thr, CMD_SET_ROTATION);
+   pkt.type   = CMD_SET_ROTATION;
+   pkt.data.i = rotation;
+   thread_push_packet(thr, &pkt);
 }
 
 /* This value is set async as stalling on the video driver for 
@@ -653,6 +792,7 @@ static bool thread_read_viewport(void *data, uint8_t *buffer)
 
 static void thread_free(void *data)
 {
+   unsigned i;
    thread_video_t *thr = (thread_video_t*)data;
    if (!thr)
       return;
@@ -664,7 +804,8 @@ static void thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
-   free(thr->frame.buffer);
+   for (i = 0; i < THREAD_FRAME_SLOTS; i++)
+      free(thr->frame.slots[i].buffer);
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -673,8 +814,10 @@ static void thread_free(void *data)
    free(thr->alpha_mod);
    slock_free(thr->alpha_lock);
 
-   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
+   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames superseded: %u.\n",
          thr->hit_count, thr->miss_count);
+   RARCH_LOG("Threaded video stats: Blocked on video thread %u times, %.3f ms in total.\n",
+         thr->wait_count, thr->wait_time / 1000.0);
 
    free(thr);
 }
@@ -682,13 +825,14 @@ static void thread_free(void *data)
 #ifdef HAVE_OVERLAY
 static void thread_overlay_enable(void *data, bool state)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.b = state;
-   thread_send_cmd(thr, CMD_OVERLAY_ENABLE);
-   thread_wait_reply(thr, CMD_OVERLAY_ENABLE);
+   pkt.type   = CMD_OVERLAY_ENABLE;
+   pkt.data.b = state;
+   thread_push_packet(thr, &pkt);
 }
 
 static bool thread_overlay_load(void *data,
@@ -710,42 +854,47 @@ static bool thread_overlay_load(void *data,
 static void thread_overlay_tex_geom(void *data,
       unsigned idx, float x, float y, float w, float h)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.rect.index = idx;
-   thr->cmd_data.rect.x = x;
-   thr->cmd_data.rect.y = y;
-   thr->cmd_data.rect.w = w;
-   thr->cmd_data.rect.h = h;
-   thread_send_cmd(thr, CMD_OVERLAY_TEX_GEOM);
-   thread_wait_reply(thr, CMD_OVERLAY_TEX_GEOM);
+   pkt.type            = CMD_OVERLAY_TEX_GEOM;
+   pkt.data.rect.index = idx;
+   pkt.data.rect.x     = x;
+   pkt.data.rect.y     = y;
+   pkt.data.rect.w     = w;
+   pkt.data.rect.h     = h;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_overlay_vertex_geom(void *data,
       unsigned idx, float x, float y, float w, float h)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.rect.index = idx;
-   thr->cmd_data.rect.x = x;
-   thr->cmd_data.rect.y = y;
-   thr->cmd_data.rect.w = w;
-   thr->cmd_data.rect.h = h;
-   thread_send_cmd(thr, CMD_OVERLAY_VERTEX_GEOM);
-   thread_wait_reply(thr, CMD_OVERLAY_VERTEX_GEOM);
+   pkt.type            = CMD_OVERLAY_VERTEX_GEOM;
+   pkt.data.rect.index = idx;
+   pkt.data.rect.x     = x;
+   pkt.data.rect.y     = y;
+   pkt.data.rect.w     = w;
+   pkt.data.rect.h     = h;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_overlay_full_screen(void *data, bool enable)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
-   thr->cmd_data.b = enable;
-   thread_send_cmd(thr, CMD_OVERLAY_FULL_SCREEN);
-   thread_wait_reply(thr, CMD_OVERLAY_FULL_SCREEN);
+   if (!thr)
+      return;
+   pkt.type   = CMD_OVERLAY_FULL_SCREEN;
+   pkt.data.b = enable;
+   thread_push_packet(thr, &pkt);
 }
 
 /* We cannot wait for this to complete. Totally blocks the main thread. */
@@ -784,27 +933,29 @@ static void thread_get_overlay_interface(void *data,
 static void thread_set_video_mode(void *data, unsigned width, unsigned height,
       bool fullscreen)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.new_mode.width      = width;
-   thr->cmd_data.new_mode.height     = height;
-   thr->cmd_data.new_mode.fullscreen = fullscreen;
-   thread_send_cmd(thr, CMD_POKE_SET_VIDEO_MODE);
-   thread_wait_reply(thr, CMD_POKE_SET_VIDEO_MODE);
+   pkt.type                     = CMD_POKE_SET_VIDEO_MODE;
+   pkt.data.new_mode.width      = width;
+   pkt.data.new_mode.height     = height;
+   pkt.data.new_mode.fullscreen = fullscreen;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_set_filtering(void *data, unsigned idx, bool smooth)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.filtering.index  = idx;
-   thr->cmd_data.filtering.smooth = smooth;
-   thread_send_cmd(thr, CMD_POKE_SET_FILTERING);
-   thread_wait_reply(thr, CMD_POKE_SET_FILTERING);
+   pkt.type                  = CMD_POKE_SET_FILTERING;
+   pkt.data.filtering.index  = idx;
+   pkt.data.filtering.smooth = smooth;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_get_video_output_size(void *data,
@@ -822,33 +973,36 @@ static void thread_get_video_output_size(void *data,
 
 static void thread_get_video_output_prev(void *data)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thread_send_cmd(thr, CMD_POKE_GET_VIDEO_OUTPUT_PREV);
-   thread_wait_reply(thr, CMD_POKE_GET_VIDEO_OUTPUT_PREV);
+   pkt.type = CMD_POKE_GET_VIDEO_OUTPUT_PREV;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_get_video_output_next(void *data)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thread_send_cmd(thr, CMD_POKE_GET_VIDEO_OUTPUT_NEXT);
-   thread_wait_reply(thr, CMD_POKE_GET_VIDEO_OUTPUT_NEXT);
+   pkt.type = CMD_POKE_GET_VIDEO_OUTPUT_NEXT;
+   thread_push_packet(thr, &pkt);
 }
 
 static void thread_set_aspect_ratio(void *data, unsigned aspectratio_idx)
 {
+   struct thread_packet pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (!thr)
       return;
-   thr->cmd_data.i = aspectratio_idx;
-   thread_send_cmd(thr, CMD_POKE_SET_ASPECT_RATIO);
-   thread_wait_reply(thr, CMD_POKE_SET_ASPECT_RATIO);
+   pkt.type   = CMD_POKE_SET_ASPECT_RATIO;
+   pkt.data.i = aspectratio_idx;
+   thread_push_packet(thr, &pkt);
 }
 
 #if defined(HAVE_MENU)
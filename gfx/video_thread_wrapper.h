@@ -22,6 +22,12 @@
 #include <boolean.h>
 #include <rthreads/rthreads.h>
 
+#define THREAD_FRAME_SLOTS 3
+#define THREAD_FRAME_INDEX 0x3
+#define THREAD_FRAME_FRESH 0x4
+
+#define THREAD_CMD_RING_SIZE 64
+
 enum thread_cmd
 {
    CMD_NONE = 0,
@@ -57,6 +63,46 @@ enum thread_cmd
    CMD_DUMMY = INT_MAX
 };
 
+/* Fire-and-forget command, queued in thread_video_t::ring. */
+struct thread_packet
+{
+   enum thread_cmd type;
+   union
+   {
+      bool b;
+      int i;
+
+      struct
+      {
+         unsigned index;
+         float x, y, w, h;
+      } rect;
+
+      struct
+      {
+         unsigned width;
+         unsigned height;
+         bool fullscreen;
+      } new_mode;
+
+      struct
+      {
+         unsigned index;
+         bool smooth;
+      } filtering;
+   } data;
+};
+
+struct thread_frame_slot
+{
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   bool dupe; /* Show the previous frame again. */
+   char msg[PATH_MAX_LENGTH];
+};
+
 typedef struct thread_video
 {
    slock_t *lock;
@@ -102,6 +148,19 @@ typedef struct thread_video
    unsigned hit_count;
    unsigned miss_count;
 
+   /* Commands which need no reply are queued here and run by 
+    * the thread in order, ahead of the next reply-bound command 
+    * or frame. Protected by lock. */
+   struct
+   {
+      struct thread_packet packets[THREAD_CMD_RING_SIZE];
+      unsigned head;
+      unsigned tail;
+   } ring;
+
+   retro_time_t wait_time; /* Total time blocked on the thread. */
+   unsigned wait_count;
+
    float *alpha_mod;
    unsigned alpha_mods;
    bool alpha_update;
@@ -187,16 +246,18 @@ typedef struct thread_video
    struct video_viewport vp;
    struct video_viewport read_vp; /* Last viewport reported to caller. */
 
+   /* Frames are handed over through three slots. The caller
+    * fills frame.write, the driver thread renders frame.read,
+    * and frame.pending holds the slot in between. Swapping a
+    * slot with frame.pending is the only shared access. */
    struct
    {
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      bool updated;
+      struct thread_frame_slot slots[THREAD_FRAME_SLOTS];
+      unsigned write;
+      unsigned read;
+      volatile int pending; /* Slot index, | THREAD_FRAME_FRESH. */
       bool within_thread;
-      char msg[PATH_MAX_LENGTH];
    } frame;
 
    video_driver_t video_thread;
@@ -57,6 +57,7 @@ PERFORMANCE
 #endif
 
 #include "../performance.c"
+#include "../performance/cpu_cores.c"
 
 /*============================================================
 COMPATIBILITY
@@ -665,9 +666,11 @@ THREAD
 #include "../thread/xenon_sdl_threads.c"
 #elif defined(HAVE_THREADS)
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/rthreads_pool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #include "../autosave.c"
+#include "../emu_thread.c"
 #endif
 
 
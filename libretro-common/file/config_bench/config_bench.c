@@ -0,0 +1,154 @@
+/* Startup benchmark for config_file.
+ *
+ * Parses a retroarch.cfg and every .info file of a directory the
+ * way RetroArch does at startup, then looks up every key that
+ * config_load and core_info_list_new would ask for.
+ *
+ * Usage: config_bench <retroarch.cfg> [info directory] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <file/dir_list.h>
+#include <string/string_list.h>
+
+/* Provided by the frontend, path expansion is not measured here. */
+void fill_pathname_expand_special(char *out_path,
+      const char *in_path, size_t size)
+{
+   strlcpy(out_path, in_path, size);
+}
+
+void fill_pathname_abbreviate_special(char *out_path,
+      const char *in_path, size_t size)
+{
+   strlcpy(out_path, in_path, size);
+}
+
+static const char *info_keys[] = {
+   "display_name", "corename", "systemname", "manufacturer",
+   "firmware_count", "supported_extensions", "authors", "permissions",
+   "license", "categories", "database", "notes", "supports_no_game",
+   "firmware0_path", "firmware0_desc", "firmware0_opt",
+};
+
+static double elapsed_ms(clock_t start)
+{
+   return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/* Looks up every key in the file, plus as many misses. */
+static unsigned bench_lookup_all(config_file_t *conf)
+{
+   char buf[4096], miss[256];
+   unsigned found = 0;
+   struct config_file_entry entry;
+
+   if (!config_get_entry_list_head(conf, &entry))
+      return 0;
+
+   do
+   {
+      snprintf(miss, sizeof(miss), "%s_missing", entry.key);
+      found += config_get_array(conf, entry.key, buf, sizeof(buf));
+      found += config_get_array(conf, miss, buf, sizeof(buf));
+   } while (config_get_entry_list_next(&entry));
+
+   return found;
+}
+
+static double bench_cfg(const char *path, unsigned iterations,
+      unsigned *lookups)
+{
+   unsigned i;
+   clock_t start = clock();
+
+   for (i = 0; i < iterations; i++)
+   {
+      config_file_t *conf = config_file_new(path);
+      if (!conf)
+      {
+         fprintf(stderr, "Could not open %s.\n", path);
+         exit(1);
+      }
+
+      *lookups = bench_lookup_all(conf);
+      config_file_free(conf);
+   }
+
+   return elapsed_ms(start) / iterations;
+}
+
+static double bench_info(const char *dir, unsigned iterations,
+      size_t *files)
+{
+   unsigned i;
+   size_t j, k;
+   clock_t start;
+   struct string_list *list = dir_list_new(dir, "info", false);
+
+   if (!list)
+   {
+      fprintf(stderr, "Could not list %s.\n", dir);
+      exit(1);
+   }
+
+   *files = list->size;
+   start  = clock();
+
+   for (i = 0; i < iterations; i++)
+   {
+      for (j = 0; j < list->size; j++)
+      {
+         char buf[4096];
+         config_file_t *conf = config_file_new(list->elems[j].data);
+
+         if (!conf)
+            continue;
+
+         for (k = 0; k < sizeof(info_keys) / sizeof(info_keys[0]); k++)
+            config_get_array(conf, info_keys[k], buf, sizeof(buf));
+
+         config_file_free(conf);
+      }
+   }
+
+   dir_list_free(list);
+   return elapsed_ms(start) / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+   double ms;
+   unsigned lookups    = 0;
+   unsigned iterations = 100;
+   size_t files        = 0;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s <retroarch.cfg> [info directory] [iterations]\n",
+            argv[0]);
+      return 1;
+   }
+
+   if (argc > 3)
+      iterations = strtoul(argv[3], NULL, 0);
+   if (!iterations)
+      iterations = 1;
+
+   ms = bench_cfg(argv[1], iterations, &lookups);
+   printf("cfg:  %8.3f ms per load (%u keys found)\n", ms, lookups);
+
+   if (argc > 2)
+   {
+      ms = bench_info(argv[2], iterations, &files);
+      printf("info: %8.3f ms per pass (%u files)\n", ms, (unsigned)files);
+   }
+
+   return 0;
+}
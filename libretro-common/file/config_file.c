@@ -31,7 +31,6 @@
 #include <compat/msvc.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
-#include <string/string_list.h>
 
 #if !defined(_WIN32) && !defined(__CELLOS_LV2__) && !defined(_XBOX)
 #include <sys/param.h> /* PATH_MAX */
@@ -44,47 +43,217 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+#define CONFIG_ARENA_BLOCK_SIZE 4096
+#define CONFIG_ARENA_ALIGN(x) (((x) + 7) & ~(size_t)7)
+#define CONFIG_INDEX_MIN_SIZE 64
+
+struct config_arena_block
+{
+   struct config_arena_block *next;
+   size_t size;
+   size_t used;
+};
+
+#define CONFIG_ARENA_HEADER CONFIG_ARENA_ALIGN(sizeof(struct config_arena_block))
 
 static config_file_t *config_file_new_internal(const char *path, unsigned depth);
 void config_file_free(config_file_t *conf);
 
-static char *getaline(FILE *file)
+static void *config_arena_alloc(config_file_t *conf, size_t size)
 {
-   char* newline = (char*)malloc(9);
-   char* newline_tmp = NULL;
-   size_t cur_size = 8;
-   size_t idx = 0;
-   int in = getc(file);
+   void *ptr                        = NULL;
+   struct config_arena_block *block = conf->arena;
 
-   if (!newline)
-      return NULL;
+   size = CONFIG_ARENA_ALIGN(size);
 
-   while (in != EOF && in != '\n')
+   if (!block || block->size - block->used < size)
    {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         newline_tmp = (char*)realloc(newline, cur_size + 1);
+      bool oversized    = size > CONFIG_ARENA_BLOCK_SIZE - CONFIG_ARENA_HEADER;
+      size_t block_size = oversized ?
+         size + CONFIG_ARENA_HEADER : CONFIG_ARENA_BLOCK_SIZE;
 
-         if (!newline_tmp)
-         {
-            free(newline);
-            return NULL;
-         }
+      block = (struct config_arena_block*)malloc(block_size);
+      if (!block)
+         return NULL;
+
+      block->size = block_size;
+      block->used = CONFIG_ARENA_HEADER;
 
-         newline = newline_tmp;
+      /* Oversized blocks are full right away, keep
+       * filling the current block after them. */
+      if (oversized && conf->arena)
+      {
+         block->next       = conf->arena->next;
+         conf->arena->next = block;
       }
+      else
+      {
+         block->next = conf->arena;
+         conf->arena = block;
+      }
+   }
+
+   ptr          = (char*)block + block->used;
+   block->used += size;
+   return ptr;
+}
+
+static char *config_arena_strndup(config_file_t *conf,
+      const char *str, size_t len)
+{
+   char *dst = (char*)config_arena_alloc(conf, len + 1);
+   if (!dst)
+      return NULL;
+
+   memcpy(dst, str, len);
+   dst[len] = '\0';
+   return dst;
+}
 
-      newline[idx++] = in;
-      in = getc(file);
+/* Moves all arena blocks of child into parent. */
+static void config_arena_adopt(config_file_t *parent, config_file_t *child)
+{
+   struct config_arena_block *last = child->arena;
+
+   if (!last)
+      return;
+
+   while (last->next)
+      last = last->next;
+
+   if (parent->arena)
+   {
+      last->next          = parent->arena->next;
+      parent->arena->next = child->arena;
    }
-   newline[idx] = '\0';
-   return newline; 
+   else
+      parent->arena = child->arena;
+
+   child->arena = NULL;
+}
+
+static uint32_t config_hash_key(const char *key)
+{
+   uint32_t hash = 5381;
+
+   while (*key)
+      hash = (hash << 5) + hash + (uint8_t)*key++;
+
+   return hash;
+}
+
+/* Appends entry to the end of its bucket. Buckets are kept in
+ * list order so the first match is also the first list entry. */
+static void config_index_link(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   struct config_entry_list **link =
+      &conf->index[entry->hash & (conf->index_size - 1)];
+
+   while (*link)
+      link = &(*link)->hash_next;
+
+   entry->hash_next = NULL;
+   *link            = entry;
 }
 
+static bool config_index_rebuild(config_file_t *conf)
+{
+   struct config_entry_list *entry  = NULL;
+   struct config_entry_list **index = NULL;
+   size_t size                      = CONFIG_INDEX_MIN_SIZE;
+
+   while (size < conf->entry_count)
+      size *= 2;
+
+   if (size != conf->index_size)
+   {
+      index = (struct config_entry_list**)calloc(size, sizeof(*index));
+      if (!index)
+         return false;
+
+      free(conf->index);
+      conf->index      = index;
+      conf->index_size = size;
+   }
+   else
+      memset(conf->index, 0, size * sizeof(*conf->index));
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      config_index_link(conf, entry);
+
+   return true;
+}
+
+static void config_index_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   if (++conf->entry_count > conf->index_size)
+      config_index_rebuild(conf);
+   else
+      config_index_link(conf, entry);
+}
+
+static struct config_entry_list *config_get_entry(
+      const config_file_t *conf, const char *key)
+{
+   uint32_t hash;
+   struct config_entry_list *entry = NULL;
+
+   if (!conf->index)
+      return NULL;
+
+   hash = config_hash_key(key);
+
+   for (entry = conf->index[hash & (conf->index_size - 1)];
+         entry; entry = entry->hash_next)
+   {
+      if (entry->hash == hash && strcmp(key, entry->key) == 0)
+         return entry;
+   }
+
+   return NULL;
+}
+
+static void config_append_entry(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   entry->next = NULL;
+
+   if (conf->entries)
+      conf->tail->next = entry;
+   else
+      conf->entries = entry;
+   conf->tail = entry;
+
+   config_index_add(conf, entry);
+}
+
+static struct config_entry_list *config_add_entry(config_file_t *conf,
+      const char *key, size_t key_len, const char *value)
+{
+   struct config_entry_list *entry = (struct config_entry_list*)
+      config_arena_alloc(conf, sizeof(*entry));
+
+   if (!entry)
+      return NULL;
+
+   entry->readonly = false;
+   entry->key      = config_arena_strndup(conf, key, key_len);
+   entry->value    = config_arena_strndup(conf, value, strlen(value));
+
+   if (!entry->key || !entry->value)
+      return NULL;
+
+   entry->hash = config_hash_key(entry->key);
+   config_append_entry(conf, entry);
+   return entry;
+}
+
+/* Returns a pointer into line, which is modified in place. */
 static char *extract_value(char *line, bool is_value)
 {
-   char *save = NULL, *tok = NULL;
+   char *save = NULL;
 
    if (is_value)
    {
@@ -106,62 +275,32 @@ static char *extract_value(char *line, bool is_value)
    if (*line == '"')
    {
       line++;
-      tok = strtok_r(line, "\"", &save);
-      if (!tok)
-         return NULL;
-      return strdup(tok);
+      return strtok_r(line, "\"", &save);
    }
    else if (*line == '\0') /* Nothing */
       return NULL;
 
    /* We don't have that. Read until next space. */
-   tok = strtok_r(line, " \n\t\f\r\v", &save);
-   if (tok)
-      return strdup(tok);
-   return NULL;
-}
-
-static void set_list_readonly(struct config_entry_list *list)
-{
-   while (list)
-   {
-      list->readonly = true;
-      list = list->next;
-   }
+   return strtok_r(line, " \n\t\f\r\v", &save);
 }
 
 /* Move semantics? */
 static void add_child_list(config_file_t *parent, config_file_t *child)
 {
-   if (parent->entries)
-   {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
+   struct config_entry_list *entry = child->entries;
 
-      set_list_readonly(child->entries);
-      head->next = child->entries;
-   }
-   else
+   while (entry)
    {
-      set_list_readonly(child->entries);
-      parent->entries = child->entries;
+      struct config_entry_list *next = entry->next;
+
+      entry->readonly = true;
+      config_append_entry(parent, entry);
+      entry = next;
    }
 
+   config_arena_adopt(parent, child);
    child->entries = NULL;
-
-   /* Rebase tail. */
-   if (parent->entries)
-   {
-      struct config_entry_list *head = 
-         (struct config_entry_list*)parent->entries;
-
-      while (head->next)
-         head = head->next;
-      parent->tail = head;
-   }
-   else
-      parent->tail = NULL;
+   child->tail    = NULL;
 }
 
 static void add_include_list(config_file_t *conf, const char *path)
@@ -215,15 +354,11 @@ static void add_sub_conf(config_file_t *conf, char *line)
    sub_conf = (config_file_t*)
       config_file_new_internal(real_path, conf->include_depth + 1);
    if (!sub_conf)
-   {
-      free(path);
       return;
-   }
 
    /* Pilfer internal list. */
    add_child_list(conf, sub_conf);
    config_file_free(sub_conf);
-   free(path);
 }
 
 static char *strip_comment(char *str)
@@ -265,23 +400,15 @@ static char *strip_comment(char *str)
    return str;
 }
 
-static bool parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line)
+static bool parse_line(config_file_t *conf, char *line)
 {
-   char* comment = NULL;
-   char* key = (char*)malloc(9);
-   char* key_tmp = NULL;
-   size_t cur_size = 8;
-   size_t idx = 0;
-
-   if (!key)
-      return false;
+   char *comment   = NULL;
+   char *key       = NULL;
+   char *value     = NULL;
+   size_t key_len  = 0;
 
    if (!line || !*line)
-   {
-      free(key);
       return false;
-   }
 
    comment = strip_comment(line);
 
@@ -292,7 +419,6 @@ static bool parse_line(config_file_t *conf,
       if (strstr(comment, "include ") == comment)
       {
          add_sub_conf(conf, comment + strlen("include "));
-         free(key);
          return false;
       }
    }
@@ -305,36 +431,54 @@ static bool parse_line(config_file_t *conf,
    while (isspace(*line))
       line++;
 
+   key = line;
    while (isgraph(*line))
-   {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp = (char*)realloc(key, cur_size + 1);
-
-         if (!key_tmp)
-         {
-            free(key);
-            return false;
-         }
+      line++;
+   key_len = line - key;
 
-         key = key_tmp;
-      }
+   value = extract_value(line, true);
+   if (!value)
+      return false;
 
-      key[idx++] = *line++;
-   }
-   key[idx] = '\0';
-   list->key = key;
+   return config_add_entry(conf, key, key_len, value) != NULL;
+}
 
-   list->value = extract_value(line, true);
-   if (!list->value)
+/* Parses a whole buffer, one entry per line. Modifies buf. */
+static void config_file_parse(config_file_t *conf, char *buf)
+{
+   while (buf)
    {
-      list->key = NULL;
-      free(key);
-      return false;
+      char *line = buf;
+
+      buf = strchr(buf, '\n');
+      if (buf)
+         *buf++ = '\0';
+
+      parse_line(conf, line);
    }
+}
 
-   return true;
+static char *config_file_read_all(FILE *file)
+{
+   long len;
+   size_t read_len;
+   char *buf = NULL;
+
+   if (fseek(file, 0, SEEK_END) != 0)
+      return NULL;
+
+   len = ftell(file);
+   if (len < 0 || fseek(file, 0, SEEK_SET) != 0)
+      return NULL;
+
+   buf = (char*)malloc(len + 1);
+   if (!buf)
+      return NULL;
+
+   /* Text mode can shrink the file while reading it. */
+   read_len      = fread(buf, 1, len, file);
+   buf[read_len] = '\0';
+   return buf;
 }
 
 bool config_append_file(config_file_t *conf, const char *path)
@@ -345,9 +489,17 @@ bool config_append_file(config_file_t *conf, const char *path)
 
    if (new_conf->tail)
    {
+      if (!conf->entries)
+         conf->tail = new_conf->tail;
+
       new_conf->tail->next = conf->entries;
       conf->entries        = new_conf->entries; /* Pilfer. */
+      conf->entry_count   += new_conf->entry_count;
       new_conf->entries    = NULL;
+      new_conf->tail       = NULL;
+
+      config_arena_adopt(conf, new_conf);
+      config_index_rebuild(conf);
    }
 
    config_file_free(new_conf);
@@ -358,6 +510,7 @@ static config_file_t *config_file_new_internal(
       const char *path, unsigned depth)
 {
    FILE *file = NULL;
+   char *buf  = NULL;
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
    if (!conf)
       return NULL;
@@ -382,48 +535,24 @@ static config_file_t *config_file_new_internal(
       return NULL;
    }
 
-   while (!feof(file))
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-         calloc(1, sizeof(*list));
-      char *line = NULL;
-
-      if (!list)
-      {
-         config_file_free(conf);
-         fclose(file);
-         return NULL;
-      }
-
-      line = getaline(file);
-
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
-
-         free(line);
-      }
+   buf = config_file_read_all(file);
+   fclose(file);
 
-      if (list != conf->tail)
-         free(list);
+   if (!buf)
+   {
+      config_file_free(conf);
+      return NULL;
    }
-   fclose(file);
+
+   config_file_parse(conf, buf);
+   free(buf);
 
    return conf;
 }
 
 config_file_t *config_file_new_from_string(const char *from_string)
 {
-   size_t i;
-   struct string_list *lines = NULL;
+   char *buf = NULL;
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
    if (!conf)
       return NULL;
@@ -433,42 +562,13 @@ config_file_t *config_file_new_from_string(const char *from_string)
 
    conf->path = NULL;
    conf->include_depth = 0;
-   
-   lines = string_split(from_string, "\n");
-   if (!lines)
-      return conf;
-
-   for (i = 0; i < lines->size; i++)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-         calloc(1, sizeof(*list));
-      char* line = lines->elems[i].data;
-
-      if (!list)
-      {
-         string_list_free(lines);
-         config_file_free(conf);
-         return NULL;
-      }
 
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
-   }
+   buf = strdup(from_string);
+   if (!buf)
+      return conf;
 
-   string_list_free(lines);
+   config_file_parse(conf, buf);
+   free(buf);
 
    return conf;
 }
@@ -481,18 +581,15 @@ config_file_t *config_file_new(const char *path)
 void config_file_free(config_file_t *conf)
 {
    struct config_include_list *inc_tmp = NULL;
-   struct config_entry_list *tmp = NULL;
+   struct config_arena_block *block    = NULL;
    if (!conf)
       return;
 
-   tmp = conf->entries;
-   while (tmp)
+   block = conf->arena;
+   while (block)
    {
-      struct config_entry_list *hold = NULL;
-      free(tmp->key);
-      free(tmp->value);
-      hold = tmp;
-      tmp = tmp->next;
+      struct config_arena_block *hold = block;
+      block = block->next;
       free(hold);
    }
 
@@ -506,182 +603,136 @@ void config_file_free(config_file_t *conf)
       free(hold);
    }
 
+   free(conf->index);
    free(conf->path);
    free(conf);
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         *in = strtod(list->value, NULL);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   *in = strtod(entry->value, NULL);
+   return true;
 }
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         /* strtof() is C99/POSIX. Just use the more portable kind. */
-         *in = (float)strtod(list->value, NULL);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   /* strtof() is C99/POSIX. Just use the more portable kind. */
+   *in = (float)strtod(entry->value, NULL);
+   return true;
 }
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   struct config_entry_list *list = conf->entries;
+   int val;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         int val;
-         errno = 0;
-         val = strtol(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         return false;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   errno = 0;
+   val = strtol(entry->value, NULL, 0);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   struct config_entry_list *list = conf->entries;
+   uint64_t val;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         uint64_t val;
-         errno = 0;
-         val = strtoull(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         return false;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   errno = 0;
+   val = strtoull(entry->value, NULL, 0);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   struct config_entry_list *list = conf->entries;
+   unsigned val;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list != NULL)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         unsigned val;
-         errno = 0;
-         val = strtoul(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         return false;
-      }
-      list = list->next;
-   }
+   if (!entry)
+      return false;
+
+   errno = 0;
+   val = strtoul(entry->value, NULL, 0);
+   if (errno != 0)
+      return false;
 
-   return false;
+   *in = val;
+   return true;
 }
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   struct config_entry_list *list = conf->entries;
+   unsigned val;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         unsigned val;
-         errno = 0;
-         val = strtoul(list->value, NULL, 16);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         return false;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   errno = 0;
+   val = strtoul(entry->value, NULL, 16);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         if (list->value[0] && list->value[1])
-            return false;
-         *in = *list->value;
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   if (entry->value[0] && entry->value[1])
+      return false;
+
+   *in = *entry->value;
+   return true;
 }
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         *str = strdup(list->value);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   *str = strdup(entry->value);
+   return true;
 }
 
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-         return strlcpy(buf, list->value, size) < size;
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   return strlcpy(buf, entry->value, size) < size;
 }
 
 bool config_get_path(config_file_t *conf, const char *key,
@@ -690,77 +741,62 @@ bool config_get_path(config_file_t *conf, const char *key,
 #if defined(RARCH_CONSOLE)
    return config_get_array(conf, key, buf, size);
 #else
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         fill_pathname_expand_special(buf, list->value, size);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   fill_pathname_expand_special(buf, entry->value, size);
+   return true;
 #endif
 }
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   struct config_entry_list *list = conf->entries;
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         if (strcasecmp(list->value, "true") == 0)
-            *in = true;
-         else if (strcasecmp(list->value, "1") == 0)
-            *in = true;
-         else if (strcasecmp(list->value, "false") == 0)
-            *in = false;
-         else if (strcasecmp(list->value, "0") == 0)
-            *in = false;
-         else
-            return false;
-
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (!entry)
+      return false;
+
+   if (strcasecmp(entry->value, "true") == 0)
+      *in = true;
+   else if (strcasecmp(entry->value, "1") == 0)
+      *in = true;
+   else if (strcasecmp(entry->value, "false") == 0)
+      *in = false;
+   else if (strcasecmp(entry->value, "0") == 0)
+      *in = false;
+   else
+      return false;
+
+   return true;
 }
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *elem = NULL;
-   struct config_entry_list *list = conf->entries;
-   struct config_entry_list *last = list;
-   while (list)
-   {
-      if (!list->readonly && (strcmp(key, list->key) == 0))
-      {
-         free(list->value);
-         list->value = strdup(val);
-         return;
-      }
+   size_t len = strlen(val);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
-      last = list;
-      list = list->next;
-   }
-
-   elem = (struct config_entry_list*)calloc(1, sizeof(*elem));
+   /* Entries from an #include cannot be overwritten,
+    * look for a writable one further down the bucket. */
+   while (entry && (entry->readonly || strcmp(key, entry->key) != 0))
+      entry = entry->hash_next;
 
-   if (!elem)
+   if (!entry)
+   {
+      config_add_entry(conf, key, strlen(key), val);
       return;
+   }
 
-   elem->key = strdup(key);
-   elem->value = strdup(val);
-
-   if (last)
-      last->next = elem;
+   /* Old values stay in the arena, reuse them when possible. */
+   if (strlen(entry->value) >= len)
+      memcpy(entry->value, val, len + 1);
    else
-      conf->entries = elem;
+   {
+      char *value = config_arena_strndup(conf, val, len);
+      if (value)
+         entry->value = value;
+   }
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -871,16 +907,7 @@ void config_file_dump(config_file_t *conf, FILE *file)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (strcmp(entry, list->key) == 0)
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -40,7 +40,10 @@ struct config_entry_list
    bool readonly;
    char *key;
    char *value;
+   uint32_t hash;
    struct config_entry_list *next;
+   /* Next entry in the same hash bucket, in list order. */
+   struct config_entry_list *hash_next;
 };
 
 struct config_include_list
@@ -49,6 +52,8 @@ struct config_include_list
    struct config_include_list *next;
 };
 
+struct config_arena_block;
+
 struct config_file
 {
    char *path;
@@ -57,6 +62,16 @@ struct config_file
    unsigned include_depth;
 
    struct config_include_list *includes;
+
+   /* Hash index over entries. Lookups return the first entry
+    * in list order, same as a linear walk would. */
+   struct config_entry_list **index;
+   size_t index_size;
+   size_t entry_count;
+
+   /* Entries, keys and values are carved out of these blocks
+    * and released together in config_file_free(). */
+   struct config_arena_block *arena;
 };
 
 typedef struct config_file config_file_t;
@@ -0,0 +1,89 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rthreads_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_RTHREADS_ATOMIC_H__
+#define __LIBRETRO_SDK_RTHREADS_ATOMIC_H__
+
+#include <retro_inline.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+extern "C" {
+#endif
+
+/* Atomic operations on a shared int, all of them full
+ * memory barriers:
+ *
+ * satomic_exchange(ptr, val): stores @val in @ptr.
+ * Returns the value @ptr held before.
+ *
+ * satomic_compare_exchange(ptr, expected, desired): stores
+ * @desired in @ptr if it holds @expected. Returns the value
+ * @ptr held before.
+ *
+ * satomic_add(ptr, val): adds @val to @ptr. Returns the
+ * value @ptr holds afterwards.
+ *
+ * satomic_load(ptr): returns the value @ptr holds.
+ */
+
+#if defined(_MSC_VER)
+
+#define satomic_exchange(ptr, val) \
+   ((int)InterlockedExchange((volatile LONG*)(ptr), (LONG)(val)))
+#define satomic_compare_exchange(ptr, expected, desired) \
+   ((int)InterlockedCompareExchange((volatile LONG*)(ptr), \
+      (LONG)(desired), (LONG)(expected)))
+#define satomic_add(ptr, val) \
+   ((int)InterlockedExchangeAdd((volatile LONG*)(ptr), (LONG)(val)) + (val))
+
+#elif defined(__GNUC__)
+
+#define satomic_compare_exchange(ptr, expected, desired) \
+   __sync_val_compare_and_swap((ptr), (expected), (desired))
+#define satomic_add(ptr, val) __sync_add_and_fetch((ptr), (val))
+
+static INLINE int satomic_exchange(volatile int *ptr, int val)
+{
+   /* __sync_lock_test_and_set is only an acquire barrier. */
+   int old;
+   do
+   {
+      old = *ptr;
+   } while (__sync_val_compare_and_swap(ptr, old, val) != old);
+   return old;
+}
+
+#else
+#error "rthreads_atomic.h: no atomic operations for this compiler."
+#endif
+
+#define satomic_load(ptr) satomic_add((ptr), 0)
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rthreads_pool.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_RTHREADS_POOL_H__
+#define __LIBRETRO_SDK_RTHREADS_POOL_H__
+
+#include <boolean.h>
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+extern "C" {
+#endif
+
+typedef struct sthread_pool sthread_pool_t;
+
+/**
+ * sthread_pool_func_t:
+ * @userdata                : userdata passed to sthread_pool_run()
+ * @index                   : index of the task, from 0 to count - 1
+ *
+ * Runs one task of a job.
+ **/
+typedef void (*sthread_pool_func_t)(void *userdata, unsigned index);
+
+/**
+ * sthread_pool_new:
+ * @threads                 : number of worker threads to start
+ *
+ * Creates a thread pool. The thread calling sthread_pool_run()
+ * takes part in every job too, so a pool with @threads workers
+ * runs up to @threads + 1 tasks at once. A pool without workers
+ * runs all tasks on the calling thread.
+ *
+ * Returns: pointer to a new thread pool if successful,
+ * otherwise NULL.
+ **/
+sthread_pool_t *sthread_pool_new(unsigned threads);
+
+/**
+ * sthread_pool_free:
+ * @pool                    : pointer to thread pool object
+ *
+ * Stops the worker threads and frees the thread pool.
+ **/
+void sthread_pool_free(sthread_pool_t *pool);
+
+/**
+ * sthread_pool_threads:
+ * @pool                    : pointer to thread pool object
+ *
+ * Returns: number of threads taking part in a job, including
+ * the calling thread.
+ **/
+unsigned sthread_pool_threads(sthread_pool_t *pool);
+
+/**
+ * sthread_pool_run:
+ * @pool                    : pointer to thread pool object
+ * @func                    : task callback
+ * @userdata                : userdata passed to @func
+ * @count                   : number of tasks
+ *
+ * Calls @func for every index from 0 to @count - 1, spread over
+ * the pool, and returns once all calls have finished.
+ *
+ * Tasks are dealt out in contiguous runs, one per thread. A
+ * thread which runs out of tasks steals single tasks from the
+ * end of another thread's run, so uneven tasks even out. More
+ * tasks than threads give stealing room to work with.
+ *
+ * The pool may be shared; jobs from several threads are run
+ * one after another.
+ **/
+void sthread_pool_run(sthread_pool_t *pool,
+      sthread_pool_func_t func, void *userdata, unsigned count);
+
+#if defined(__cplusplus) && !defined(_MSC_VER)
+}
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rthreads_pool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <rthreads/rthreads.h>
+#include <rthreads/rthreads_atomic.h>
+#include <rthreads/rthreads_pool.h>
+
+/* A run of task indices, begin | (end << 16), which its owner 
+ * takes from the front and other threads steal from the back. */
+#define POOL_RANGE(begin, end) ((int)((begin) | ((end) << 16)))
+#define POOL_RANGE_BEGIN(range) ((unsigned)(range) & 0xffff)
+#define POOL_RANGE_END(range) ((unsigned)(range) >> 16)
+#define POOL_MAX_TASKS 0x7fff
+
+/* How often an idle worker polls for a new job before it goes 
+ * to sleep. Jobs submitted back to back then start without a 
+ * wakeup through the scheduler. */
+#define POOL_SPIN_COUNT 20000
+
+struct sthread_pool_queue
+{
+   volatile int range;
+   /* Keep every run on its own cache line. */
+   char pad[64 - sizeof(int)];
+};
+
+struct sthread_pool_worker
+{
+   sthread_pool_t *pool;
+   sthread_t *thread;
+   unsigned index;
+};
+
+struct sthread_pool
+{
+   struct sthread_pool_worker *workers;
+   unsigned num_workers;
+
+   /* One run per worker, and the last one for the caller. */
+   struct sthread_pool_queue *queues;
+   unsigned num_queues;
+
+   slock_t *run_lock;
+   slock_t *lock;
+   scond_t *cond_work;
+   scond_t *cond_done;
+
+   volatile int generation;
+   volatile int remaining;
+   volatile bool die;
+   unsigned busy;
+
+   sthread_pool_func_t func;
+   void *userdata;
+   unsigned base;
+};
+
+static int sthread_pool_take(struct sthread_pool_queue *queue, bool steal)
+{
+   for (;;)
+   {
+      unsigned begin, end;
+      int range = queue->range;
+
+      begin = POOL_RANGE_BEGIN(range);
+      end   = POOL_RANGE_END(range);
+
+      if (begin >= end)
+         return -1;
+
+      if (steal)
+      {
+         if (satomic_compare_exchange(&queue->range, range,
+                  POOL_RANGE(begin, end - 1)) == range)
+            return end - 1;
+      }
+      else if (satomic_compare_exchange(&queue->range, range,
+               POOL_RANGE(begin + 1, end)) == range)
+         return begin;
+   }
+}
+
+static void sthread_pool_work(sthread_pool_t *pool, unsigned self,
+      sthread_pool_func_t func, void *userdata, unsigned base)
+{
+   for (;;)
+   {
+      unsigned i;
+      int task = sthread_pool_take(&pool->queues[self], false);
+
+      for (i = 1; task < 0 && i < pool->num_queues; i++)
+         task = sthread_pool_take(
+               &pool->queues[(self + i) % pool->num_queues], true);
+
+      if (task < 0)
+         return;
+
+      func(userdata, base + task);
+
+      if (satomic_add(&pool->remaining, -1) == 0)
+      {
+         slock_lock(pool->lock);
+         scond_signal(pool->cond_done);
+         slock_unlock(pool->lock);
+      }
+   }
+}
+
+static void sthread_pool_loop(void *data)
+{
+   struct sthread_pool_worker *worker = 
+      (struct sthread_pool_worker*)data;
+   sthread_pool_t *pool = worker->pool;
+   int seen             = 0;
+
+   for (;;)
+   {
+      unsigned i, base;
+      sthread_pool_func_t func;
+      void *userdata;
+
+      for (i = 0; i < POOL_SPIN_COUNT; i++)
+      {
+         if (pool->generation != seen || pool->die)
+            break;
+      }
+
+      slock_lock(pool->lock);
+      while (pool->generation == seen && !pool->die)
+         scond_wait(pool->cond_work, pool->lock);
+
+      if (pool->die)
+      {
+         slock_unlock(pool->lock);
+         break;
+      }
+
+      seen     = pool->generation;
+      func     = pool->func;
+      userdata = pool->userdata;
+      base     = pool->base;
+      pool->busy++;
+      slock_unlock(pool->lock);
+
+      sthread_pool_work(pool, worker->index, func, userdata, base);
+
+      slock_lock(pool->lock);
+      if (--pool->busy == 0)
+         scond_signal(pool->cond_done);
+      slock_unlock(pool->lock);
+   }
+}
+
+sthread_pool_t *sthread_pool_new(unsigned threads)
+{
+   unsigned i;
+   sthread_pool_t *pool = (sthread_pool_t*)calloc(1, sizeof(*pool));
+   if (!pool)
+      return NULL;
+
+   pool->num_queues = threads + 1;
+   pool->queues     = (struct sthread_pool_queue*)
+      calloc(pool->num_queues, sizeof(*pool->queues));
+   if (threads)
+      pool->workers = (struct sthread_pool_worker*)
+         calloc(threads, sizeof(*pool->workers));
+   pool->run_lock   = slock_new();
+   pool->lock       = slock_new();
+   pool->cond_work  = scond_new();
+   pool->cond_done  = scond_new();
+
+   if (!pool->queues || (threads && !pool->workers) || !pool->run_lock ||
+         !pool->lock || !pool->cond_work || !pool->cond_done)
+      goto error;
+
+   for (i = 0; i < threads; i++)
+   {
+      struct sthread_pool_worker *worker = &pool->workers[i];
+
+      worker->pool   = pool;
+      worker->index  = i;
+      worker->thread = sthread_create(sthread_pool_loop, worker);
+      if (!worker->thread)
+         goto error;
+      pool->num_workers++;
+   }
+
+   return pool;
+
+error:
+   sthread_pool_free(pool);
+   return NULL;
+}
+
+void sthread_pool_free(sthread_pool_t *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   if (pool->lock)
+   {
+      slock_lock(pool->lock);
+      pool->die = true;
+      if (pool->cond_work)
+         scond_broadcast(pool->cond_work);
+      slock_unlock(pool->lock);
+   }
+
+   for (i = 0; i < pool->num_workers; i++)
+      sthread_join(pool->workers[i].thread);
+
+   if (pool->cond_done)
+      scond_free(pool->cond_done);
+   if (pool->cond_work)
+      scond_free(pool->cond_work);
+   if (pool->lock)
+      slock_free(pool->lock);
+   if (pool->run_lock)
+      slock_free(pool->run_lock);
+   free(pool->workers);
+   free(pool->queues);
+   free(pool);
+}
+
+unsigned sthread_pool_threads(sthread_pool_t *pool)
+{
+   return pool ? pool->num_workers + 1 : 1;
+}
+
+void sthread_pool_run(sthread_pool_t *pool,
+      sthread_pool_func_t func, void *userdata, unsigned count)
+{
+   unsigned base;
+
+   if (!pool || !pool->num_workers || count <= 1)
+   {
+      for (base = 0; base < count; base++)
+         func(userdata, base);
+      return;
+   }
+
+   slock_lock(pool->run_lock);
+
+   for (base = 0; base < count; base += POOL_MAX_TASKS)
+   {
+      unsigned i, spin;
+      unsigned tasks   = count - base;
+      unsigned queues  = pool->num_workers + 1;
+
+      if (tasks > POOL_MAX_TASKS)
+         tasks = POOL_MAX_TASKS;
+
+      slock_lock(pool->lock);
+
+      /* Workers still leaving the previous job may touch the 
+       * runs, so let them finish first. */
+      while (pool->busy)
+         scond_wait(pool->cond_done, pool->lock);
+
+      for (i = 0; i < queues; i++)
+         pool->queues[i].range = POOL_RANGE(tasks * i / queues,
+               tasks * (i + 1) / queues);
+
+      pool->func      = func;
+      pool->userdata  = userdata;
+      pool->base      = base;
+      pool->remaining = tasks;
+      satomic_add(&pool->generation, 1);
+      scond_broadcast(pool->cond_work);
+      slock_unlock(pool->lock);
+
+      sthread_pool_work(pool, pool->num_workers, func, userdata, base);
+
+      for (spin = 0; spin < POOL_SPIN_COUNT; spin++)
+      {
+         if (!pool->remaining)
+            break;
+      }
+
+      slock_lock(pool->lock);
+      while (satomic_load(&pool->remaining))
+         scond_wait(pool->cond_done, pool->lock);
+      slock_unlock(pool->lock);
+   }
+
+   slock_unlock(pool->run_lock);
+}
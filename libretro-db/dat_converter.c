@@ -1,295 +1,854 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
 
-#include "rarchdb.h"
-#include "db_parser.h"
+#include <rthreads/rthreads.h>
 
-#define MAX_TOKEN 256
+#include "libretrodb.h"
+#include "rmsgpack_dom.h"
+#include "../performance/cpu_cores.h"
 
-static char *strndup_(const char *s, size_t n)
-{
-	char* buff = calloc(n, sizeof(char));
+/* Native replacement for dat_converter.lua.
+ *
+ * DAT files are parsed in parallel (one file per job, on a small pool
+ * of threads), merged on the match key through a hash map in command
+ * line order so later files override earlier ones, sorted on the match
+ * key and streamed into libretrodb_create. */
 
-	if (!buff)
-		return 0;
+struct dat_table;
 
-	strncpy(buff, s, n);
-	return buff;
-}
+struct dat_pair
+{
+   const char *key;
+   const char *value;
+   struct dat_table *child;
+};
 
-static struct rmsgpack_dom_value *get_map_value(
-      const struct rmsgpack_dom_value *m, char* key)
+struct dat_table
 {
-   struct rmsgpack_dom_value v;
+   struct dat_pair *pairs;
+   size_t len;
+   size_t cap;
+};
 
-   v.type = RDT_STRING;
-   v.string.len = strlen(key);
-   v.string.buff = key;
-   return rmsgpack_dom_value_map_value(m, &v);
-}
+struct dat_file
+{
+   const char *path;
+   char *buff;
+   struct dat_table **games;
+   size_t games_len;
+   size_t games_cap;
+   int rv;
+};
+
+struct dat_lexer
+{
+   const char *path;
+   char *p;
+   char *end;
+   char pending;
+   unsigned line_no;
+};
+
+struct dat_record
+{
+   const char *key;
+   struct dat_table **tables;
+   size_t len;
+   size_t cap;
+};
 
-static int load_string(int fd, struct rmsgpack_dom_value *out)
+struct dat_parse_queue
 {
-   char tok[MAX_TOKEN];
-   ssize_t tok_size;
+   slock_t *lock;
+   struct dat_file *files;
+   size_t count;
+   size_t next;
+};
 
-   if ((tok_size = get_token(fd, tok, MAX_TOKEN)) < 0)
-      return tok_size;
+struct dat_emit_state
+{
+   struct dat_record *records;
+   size_t count;
+   size_t next;
+};
 
-   out->type = RDT_STRING;
-   out->string.len = tok_size;
-   out->string.buff = strndup_(tok, tok_size);
-   return 0;
+static double now_seconds(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1000000.0;
 }
 
-static int load_uint(int fd, struct rmsgpack_dom_value *out)
+static void *grow_array(void *ptr, size_t *cap, size_t len, size_t elem_size)
 {
-	char tok[MAX_TOKEN], *c;
-	ssize_t tok_size;
-	uint64_t value = 0;
+   void *tmp;
+   size_t new_cap;
 
-	if ((tok_size = get_token(fd, tok, MAX_TOKEN)) < 0)
-		return tok_size;
+   if (len < *cap)
+      return ptr;
 
-	for (c = tok; c < tok + tok_size; c++)
-   {
-		value *= 10;
-		value += *c - '0';
-	}
+   new_cap = *cap ? *cap * 2 : 16;
+   tmp     = realloc(ptr, new_cap * elem_size);
+
+   if (!tmp)
+      return NULL;
 
-	out->type = RDT_UINT;
-	out->uint_ = value;
-	return 0;
+   *cap = new_cap;
+   return tmp;
 }
 
-static int load_bin(int fd, struct rmsgpack_dom_value *out)
+/* Lexer. Tokens are NUL-terminated in place inside the file buffer.
+ * Unquoted parentheses are returned as dat_token_open/dat_token_close
+ * and must be compared by address, so a quoted "(" or ")" value is
+ * never mistaken for a delimiter. */
+
+static const char dat_token_open[]  = "(";
+static const char dat_token_close[] = ")";
+
+static const char *dat_lexer_next(struct dat_lexer *lex)
 {
-   char tok[MAX_TOKEN];
-   ssize_t tok_size;
-   uint8_t h;
-   uint8_t l;
-   int i;
+   char *tok;
+
+   if (lex->pending)
+   {
+      char c = lex->pending;
+      lex->pending = 0;
+      return c == '(' ? dat_token_open : dat_token_close;
+   }
 
-   if ((tok_size = get_token(fd, tok, MAX_TOKEN)) < 0)
-      return tok_size;
+   while (lex->p < lex->end)
+   {
+      switch (*lex->p)
+      {
+         case '\n':
+            lex->line_no++;
+         case ' ':
+         case '\t':
+         case '\r':
+            lex->p++;
+            continue;
+      }
+      break;
+   }
 
-   out->type = RDT_BINARY;
-   out->binary.len = tok_size / 2;
+   if (lex->p >= lex->end)
+      return NULL;
 
-   for (i = 0; i < tok_size; i += 2)
+   switch (*lex->p)
    {
-      if (tok[i] <= '9')
-         h = tok[i] - '0';
-      else
-         h = (tok[i] - 'A') + 10;
-      if (tok[i+1] <= '9')
-         l = tok[i+1] - '0';
-      else
-         l = (tok[i+1] - 'A') + 10;
-      tok[i/2] = h * 16 + l;
+      case '(':
+         lex->p++;
+         return dat_token_open;
+      case ')':
+         lex->p++;
+         return dat_token_close;
+      case '"':
+         tok = ++lex->p;
+         while (lex->p < lex->end && *lex->p != '"')
+         {
+            if (*lex->p == '\n')
+               lex->line_no++;
+            lex->p++;
+         }
+         if (lex->p < lex->end)
+            *lex->p++ = '\0';
+         return tok;
    }
 
-   out->binary.buff = malloc(out->binary.len);
-   memcpy(out->binary.buff, tok, out->binary.len);
-   return 0;
+   tok = lex->p;
+
+   while (lex->p < lex->end)
+   {
+      switch (*lex->p)
+      {
+         case '(':
+         case ')':
+            lex->pending = *lex->p;
+            *lex->p++ = '\0';
+            return tok;
+         case '\n':
+            lex->line_no++;
+         case ' ':
+         case '\t':
+         case '\r':
+            *lex->p++ = '\0';
+            return tok;
+      }
+      lex->p++;
+   }
+
+   return tok;
 }
 
-static int dat_value_provider(void *ctx, struct rmsgpack_dom_value *out)
+/* Parser */
+
+static void dat_table_free(struct dat_table *t)
 {
-   int rv, i;
-   static const int field_count = 22;
-   int fd = *((int*)ctx);
-   char* key;
+   size_t i;
 
-   out->type = RDT_MAP;
-   out->map.len = field_count;
-   out->map.items = calloc(field_count, sizeof(struct rmsgpack_dom_pair));
+   if (!t)
+      return;
 
-   if (find_token(fd, "game") < 0)
-      return 1;
+   for (i = 0; i < t->len; i++)
+      dat_table_free(t->pairs[i].child);
 
-   for (i = 0; i < field_count; i++)
-   {
-      if ((rv = load_string(fd, &out->map.items[i].key)) < 0)
-         goto failed;
+   free(t->pairs);
+   free(t);
+}
 
-      key = out->map.items[i].key.string.buff;
+static struct dat_table *dat_parse_table(struct dat_lexer *lex)
+{
+   const char *tok;
+   struct dat_pair *pair;
+   struct dat_table *t = (struct dat_table*)calloc(1, sizeof(*t));
 
-      if (strncmp(key, "name", sizeof("name")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "description", sizeof("description")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "users", sizeof("users")) == 0)
-      {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "releasemonth", sizeof("releasemonth")) == 0)
-      {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "releaseyear", sizeof("releaseyear")) == 0)
-      {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "rumble", sizeof("rumble")) == 0)
-      {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "analog", sizeof("analog")) == 0)
-      {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "serial", sizeof("serial")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "esrb_rating", sizeof("esrb_rating")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "elspa_rating", sizeof("elspa_rating")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "pegi_rating", sizeof("pegi_rating")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "cero_rating", sizeof("cero_rating")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "developer", sizeof("developer")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "publisher", sizeof("publisher")) == 0)
-      {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "origin", sizeof("origin")) == 0)
+   if (!t)
+      return NULL;
+
+   while ((tok = dat_lexer_next(lex)))
+   {
+      if (tok == dat_token_close)
+         return t;
+
+      if (tok == dat_token_open)
       {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         fprintf(stderr, "%s:%u: fatal error: Unexpected '(' instead of key\n",
+               lex->path, lex->line_no);
+         goto error;
       }
-      else if (strncmp(key, "rom", sizeof("rom")) == 0)
-      {
-         if (find_token(fd, "name") < 0)
-            goto failed;
 
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
-      }
-      else if (strncmp(key, "size", sizeof("size")) == 0)
+      if (!(t->pairs = (struct dat_pair*)grow_array(t->pairs, &t->cap,
+                  t->len, sizeof(*t->pairs))))
+         goto error;
+
+      pair        = &t->pairs[t->len++];
+      pair->key   = tok;
+      pair->value = NULL;
+      pair->child = NULL;
+
+      if (!(tok = dat_lexer_next(lex)))
+         break;
+
+      if (tok == dat_token_open)
       {
-         if ((rv = load_uint(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         if (!(pair->child = dat_parse_table(lex)))
+            goto error;
       }
-      else if (strncmp(key, "sha1", sizeof("sha1")) == 0)
+      else if (tok == dat_token_close)
       {
-         if ((rv = load_bin(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         fprintf(stderr, "%s:%u: fatal error: Unexpected ')' instead of value\n",
+               lex->path, lex->line_no);
+         goto error;
       }
-      else if (strncmp(key, "crc", sizeof("crc")) == 0)
+      else
+         pair->value = tok;
+   }
+
+   fprintf(stderr, "%s:%u: fatal error: Missing ')'\n",
+         lex->path, lex->line_no);
+
+error:
+   dat_table_free(t);
+   return NULL;
+}
+
+static int dat_read_file(const char *path, char **buff, size_t *len)
+{
+   long size;
+   FILE *fp = fopen(path, "rb");
+
+   if (!fp)
+      return -errno;
+
+   fseek(fp, 0, SEEK_END);
+   size = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+
+   *buff = (char*)malloc(size + 1);
+
+   if (!*buff || fread(*buff, 1, size, fp) != (size_t)size)
+   {
+      free(*buff);
+      *buff = NULL;
+      fclose(fp);
+      return -EIO;
+   }
+
+   (*buff)[size] = '\0';
+   *len = size;
+   fclose(fp);
+   return 0;
+}
+
+static int dat_parse_file(struct dat_file *file)
+{
+   int rv;
+   size_t len;
+   const char *key;
+   const char *tok;
+   struct dat_lexer lex;
+   struct dat_table *t;
+
+   if ((rv = dat_read_file(file->path, &file->buff, &len)) < 0)
+   {
+      fprintf(stderr, "could not open dat file '%s': %s\n",
+            file->path, strerror(-rv));
+      return rv;
+   }
+
+   lex.path    = file->path;
+   lex.p       = file->buff;
+   lex.end     = file->buff + len;
+   lex.pending = 0;
+   lex.line_no = 1;
+
+   while ((key = dat_lexer_next(&lex)))
+   {
+      if (!(tok = dat_lexer_next(&lex)) || tok != dat_token_open)
       {
-         if ((rv = load_bin(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         fprintf(stderr, "%s:%u: fatal error: Expected '(' found '%s'\n",
+               lex.path, lex.line_no, tok ? tok : "EOF");
+         return -EINVAL;
       }
-      else if (strncmp(key, "md5", sizeof("md5")) == 0)
+
+      if (!(t = dat_parse_table(&lex)))
+         return -EINVAL;
+
+      if (strcmp(key, "game"))
       {
-         if ((rv = load_bin(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         dat_table_free(t);
+         continue;
       }
-      else if (strncmp(key, "serial", sizeof("serial")) == 0)
+
+      if (!(file->games = (struct dat_table**)grow_array(file->games,
+                  &file->games_cap, file->games_len, sizeof(*file->games))))
       {
-         if ((rv = load_string(fd, &out->map.items[i].value)) < 0)
-            goto failed;
+         dat_table_free(t);
+         return -ENOMEM;
       }
-      else if (strncmp(key, ")", sizeof(")")) == 0)
-      {
-         rmsgpack_dom_value_free(&out->map.items[i].key);
-         out->map.len = i;
-         printf("Couldn't find all fields for item\n");
+
+      file->games[file->games_len++] = t;
+   }
+
+   return 0;
+}
+
+static void dat_parse_worker(void *data)
+{
+   struct dat_parse_queue *queue = (struct dat_parse_queue*)data;
+
+   for (;;)
+   {
+      struct dat_file *file = NULL;
+
+      slock_lock(queue->lock);
+      if (queue->next < queue->count)
+         file = &queue->files[queue->next++];
+      slock_unlock(queue->lock);
+
+      if (!file)
          break;
-      }
-      else
+
+      file->rv = dat_parse_file(file);
+   }
+}
+
+/* The main thread parses as well, so spawn one worker less than
+ * there are cores, and never more than there are other files. */
+static unsigned dat_worker_count(size_t files)
+{
+   unsigned cores   = rarch_get_cpu_cores();
+   unsigned workers = cores > 1 ? cores - 1 : 0;
+
+   if (files < 1)
+      return 0;
+   if (workers > files - 1)
+      workers = files - 1;
+   return workers;
+}
+
+/* Record lookup. Later tables override earlier ones, and within a
+ * table the last occurrence of a key wins, as with the lua converter. */
+
+static const struct dat_pair *dat_table_get(const struct dat_table *t,
+      const char *key, size_t key_len)
+{
+   size_t i;
+
+   if (!t)
+      return NULL;
+
+   for (i = t->len; i-- > 0; )
+   {
+      if (!strncmp(t->pairs[i].key, key, key_len)
+            && t->pairs[i].key[key_len] == '\0')
+         return &t->pairs[i];
+   }
+
+   return NULL;
+}
+
+/* @path is a dot separated list of keys, e.g. "rom.crc". */
+static const char *dat_table_get_path(const struct dat_table *t,
+      const char *path)
+{
+   const struct dat_pair *pair = NULL;
+
+   for (;;)
+   {
+      const char *dot = strchr(path, '.');
+      size_t len      = dot ? (size_t)(dot - path) : strlen(path);
+
+      if (!(pair = dat_table_get(t, path, len)))
+         return NULL;
+
+      if (!dot)
+         return pair->value;
+
+      t    = pair->child;
+      path = dot + 1;
+   }
+}
+
+static const struct dat_pair *dat_record_get(const struct dat_record *rec,
+      const char *key)
+{
+   size_t i;
+   const struct dat_pair *pair;
+
+   for (i = rec->len; i-- > 0; )
+   {
+      if ((pair = dat_table_get(rec->tables[i], key, strlen(key))))
+         return pair;
+   }
+
+   return NULL;
+}
+
+static const char *dat_record_get_value(const struct dat_record *rec,
+      const char *key, const char *subkey)
+{
+   const struct dat_pair *pair = dat_record_get(rec, key);
+
+   if (!pair)
+      return NULL;
+   if (!subkey)
+      return pair->value;
+
+   pair = dat_table_get(pair->child, subkey, strlen(subkey));
+   return pair ? pair->value : NULL;
+}
+
+static int dat_record_add_table(struct dat_record *rec, struct dat_table *t)
+{
+   if (!(rec->tables = (struct dat_table**)grow_array(rec->tables,
+               &rec->cap, rec->len, sizeof(*rec->tables))))
+      return -ENOMEM;
+
+   rec->tables[rec->len++] = t;
+   return 0;
+}
+
+/* Merge */
+
+static uint32_t dat_hash(const char *s)
+{
+   uint32_t hash = 2166136261u;
+
+   while (*s)
+   {
+      hash ^= (uint8_t)*s++;
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+static int dat_merge(struct dat_file *files, size_t files_len,
+      const char *match_key, struct dat_record **out, size_t *out_len)
+{
+   size_t i, j;
+   size_t total      = 0;
+   size_t count      = 0;
+   size_t buckets    = 16;
+   size_t *map       = NULL;
+   struct dat_record *records = NULL;
+
+   for (i = 0; i < files_len; i++)
+      total += files[i].games_len;
+
+   while (buckets < total * 2)
+      buckets *= 2;
+
+   records = (struct dat_record*)calloc(total ? total : 1, sizeof(*records));
+   if (match_key)
+      map  = (size_t*)malloc(buckets * sizeof(*map));
+
+   if (!records || (match_key && !map))
+      goto error;
+
+   if (map)
+      memset(map, 0xff, buckets * sizeof(*map));
+
+   for (i = 0; i < files_len; i++)
+   {
+      for (j = 0; j < files[i].games_len; j++)
       {
-         rmsgpack_dom_value_free(&out->map.items[i].key);
-         i--;
+         struct dat_table *t = files[i].games[j];
+         struct dat_record *rec = NULL;
+
+         if (match_key)
+         {
+            size_t bucket;
+            const char *key = dat_table_get_path(t, match_key);
+
+            if (!key)
+            {
+               fprintf(stderr, "missing match key '%s' in one of the entries\n",
+                     match_key);
+               goto error;
+            }
+
+            bucket = dat_hash(key) & (buckets - 1);
+
+            while (map[bucket] != (size_t)-1)
+            {
+               if (!strcmp(records[map[bucket]].key, key))
+               {
+                  rec = &records[map[bucket]];
+                  break;
+               }
+               bucket = (bucket + 1) & (buckets - 1);
+            }
+
+            if (!rec)
+            {
+               map[bucket] = count;
+               rec         = &records[count++];
+               rec->key    = key;
+            }
+         }
+         else
+         {
+            rec      = &records[count++];
+            rec->key = dat_table_get_path(t, "name");
+         }
+
+         if (dat_record_add_table(rec, t) < 0)
+            goto error;
       }
    }
-   printf("Inserting '%s' (%02X%02X%02X%02X)...\n",
-         get_map_value(out, "name")->string.buff,
-         (unsigned char)get_map_value(out, "crc")->binary.buff[0],
-         (unsigned char)get_map_value(out, "crc")->binary.buff[1],
-         (unsigned char)get_map_value(out, "crc")->binary.buff[2],
-         (unsigned char)get_map_value(out, "crc")->binary.buff[3]
-         );
+
+   free(map);
+   *out     = records;
+   *out_len = count;
    return 0;
 
-failed:
-   rmsgpack_dom_value_free(out);
-   out->type = RDT_NULL;
-   return rv;
+error:
+   for (i = 0; i < count; i++)
+      free(records[i].tables);
+   free(records);
+   free(map);
+   return -1;
+}
+
+static int dat_record_compare(const void *a, const void *b)
+{
+   const struct dat_record *ra = (const struct dat_record*)a;
+   const struct dat_record *rb = (const struct dat_record*)b;
+
+   if (!ra->key || !rb->key)
+      return !ra->key - !rb->key;
+   return strcmp(ra->key, rb->key);
+}
+
+/* Emit */
+
+enum dat_field_type
+{
+   DAT_FIELD_STRING = 0,
+   DAT_FIELD_UINT,
+   DAT_FIELD_HEX,
+   DAT_FIELD_BINARY
+};
+
+struct dat_field
+{
+   const char *name;
+   const char *key;
+   const char *subkey;
+   enum dat_field_type type;
+};
+
+static const struct dat_field dat_fields[] = {
+   { "name",           "name",           NULL,     DAT_FIELD_STRING },
+   { "description",    "description",    NULL,     DAT_FIELD_STRING },
+   { "rom_name",       "rom",            "name",   DAT_FIELD_STRING },
+   { "size",           "rom",            "size",   DAT_FIELD_UINT   },
+   { "users",          "users",          NULL,     DAT_FIELD_UINT   },
+   { "releasemonth",   "releasemonth",   NULL,     DAT_FIELD_UINT   },
+   { "releaseyear",    "releaseyear",    NULL,     DAT_FIELD_UINT   },
+   { "rumble",         "rumble",         NULL,     DAT_FIELD_UINT   },
+   { "analog",         "analog",         NULL,     DAT_FIELD_UINT   },
+   { "famitsu_rating", "famitsu_rating", NULL,     DAT_FIELD_UINT   },
+   { "edge_rating",    "edge_rating",    NULL,     DAT_FIELD_UINT   },
+   { "edge_issue",     "edge_issue",     NULL,     DAT_FIELD_UINT   },
+   { "edge_review",    "edge_review",    NULL,     DAT_FIELD_STRING },
+   { "enhancement_hw", "enhancement_hw", NULL,     DAT_FIELD_STRING },
+   { "barcode",        "barcode",        NULL,     DAT_FIELD_STRING },
+   { "esrb_rating",    "esrb_rating",    NULL,     DAT_FIELD_STRING },
+   { "elspa_rating",   "elspa_rating",   NULL,     DAT_FIELD_STRING },
+   { "pegi_rating",    "pegi_rating",    NULL,     DAT_FIELD_STRING },
+   { "cero_rating",    "cero_rating",    NULL,     DAT_FIELD_STRING },
+   { "franchise",      "franchise",      NULL,     DAT_FIELD_STRING },
+   { "developer",      "developer",      NULL,     DAT_FIELD_STRING },
+   { "publisher",      "publisher",      NULL,     DAT_FIELD_STRING },
+   { "origin",         "origin",         NULL,     DAT_FIELD_STRING },
+   { "crc",            "rom",            "crc",    DAT_FIELD_HEX    },
+   { "md5",            "rom",            "md5",    DAT_FIELD_HEX    },
+   { "sha1",           "rom",            "sha1",   DAT_FIELD_HEX    },
+   { "serial",         "serial",         NULL,     DAT_FIELD_BINARY },
+};
+
+static int dat_unhex(char c)
+{
+   if (c >= '0' && c <= '9')
+      return c - '0';
+   if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+   if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+   return -1;
+}
+
+static int dat_set_value(struct rmsgpack_dom_value *out,
+      enum dat_field_type type, const char *value)
+{
+   size_t i, len;
+   char *end = NULL;
+
+   switch (type)
+   {
+      case DAT_FIELD_STRING:
+         out->type        = RDT_STRING;
+         out->string.len  = strlen(value);
+         out->string.buff = strdup(value);
+         return out->string.buff ? 0 : -ENOMEM;
+      case DAT_FIELD_UINT:
+         out->type  = RDT_UINT;
+         out->uint_ = strtoull(value, &end, 10);
+         return (end == value || *end) ? -EINVAL : 0;
+      case DAT_FIELD_HEX:
+         len = strlen(value) / 2;
+         out->type        = RDT_BINARY;
+         out->binary.len  = len;
+         out->binary.buff = (char*)malloc(len ? len : 1);
+         if (!out->binary.buff)
+            return -ENOMEM;
+         for (i = 0; i < len; i++)
+         {
+            int h = dat_unhex(value[i * 2]);
+            int l = dat_unhex(value[i * 2 + 1]);
+            if (h < 0 || l < 0)
+            {
+               free(out->binary.buff);
+               return -EINVAL;
+            }
+            out->binary.buff[i] = (h << 4) | l;
+         }
+         return 0;
+      case DAT_FIELD_BINARY:
+         len = strlen(value);
+         out->type        = RDT_BINARY;
+         out->binary.len  = len;
+         out->binary.buff = (char*)malloc(len ? len : 1);
+         if (!out->binary.buff)
+            return -ENOMEM;
+         memcpy(out->binary.buff, value, len);
+         return 0;
+   }
+
+   return -EINVAL;
+}
+
+static int dat_value_provider(void *ctx, struct rmsgpack_dom_value *out)
+{
+   size_t i;
+   struct dat_emit_state *state = (struct dat_emit_state*)ctx;
+   const struct dat_record *rec;
+
+   if (state->next >= state->count)
+      return 1;
+
+   rec = &state->records[state->next++];
+
+   out->type      = RDT_MAP;
+   out->map.len   = 0;
+   out->map.items = (struct rmsgpack_dom_pair*)calloc(
+         sizeof(dat_fields) / sizeof(dat_fields[0]),
+         sizeof(struct rmsgpack_dom_pair));
+
+   if (!out->map.items)
+      return -ENOMEM;
+
+   for (i = 0; i < sizeof(dat_fields) / sizeof(dat_fields[0]); i++)
+   {
+      const struct dat_field *field = &dat_fields[i];
+      struct rmsgpack_dom_pair *pair = &out->map.items[out->map.len];
+      const char *value = dat_record_get_value(rec, field->key, field->subkey);
+
+      /* serial falls back to rom.serial */
+      if (!value && !strcmp(field->name, "serial"))
+         value = dat_record_get_value(rec, "rom", "serial");
+
+      if (!value || dat_set_value(&pair->value, field->type, value) < 0)
+         continue;
+
+      pair->key.type        = RDT_STRING;
+      pair->key.string.len  = strlen(field->name);
+      pair->key.string.buff = strdup(field->name);
+      out->map.len++;
+   }
+
+   return 0;
 }
 
 int main(int argc, char **argv)
 {
-	int rv = 0;
-	int src = -1;
-	int dst = -1;
+   size_t i;
+   unsigned threads;
+   double t_start, t_parse, t_merge, t_sort, t_write;
+   int rv                     = EXIT_SUCCESS;
+   int dst                    = -1;
+   size_t files_len           = 0;
+   size_t games               = 0;
+   const char *match_key      = NULL;
+   struct dat_file *files     = NULL;
+   struct dat_emit_state emit = {0};
+   struct dat_parse_queue queue;
+   sthread_t **workers        = NULL;
+
+   if (argc < 3)
+   {
+      printf("Usage: %s <db file> <dat file>\n", argv[0]);
+      printf("       %s <db file> <match key> <dat file> ...\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   if (argc > 3)
+      match_key = argv[2];
+
+   files_len = argc - (match_key ? 3 : 2);
+   files     = (struct dat_file*)calloc(files_len, sizeof(*files));
+
+   if (!files)
+      return EXIT_FAILURE;
 
-	if (argc != 3)
-		printf("Usage: %s <dat file> <output file>\n", argv[0]);
+   for (i = 0; i < files_len; i++)
+      files[i].path = argv[argc - files_len + i];
 
-	src = open(argv[1], O_RDONLY);
+   t_start = now_seconds();
 
-	if (src == -1)
+   queue.lock  = slock_new();
+   queue.files = files;
+   queue.count = files_len;
+   queue.next  = 0;
+   threads     = dat_worker_count(files_len);
+   workers     = threads
+      ? (sthread_t**)calloc(threads, sizeof(*workers)) : NULL;
+
+   if (!queue.lock || (threads && !workers))
    {
-		printf("Could not open source file '%s': %s\n", argv[1], strerror(errno));
-		rv = errno;
-		goto clean;
-	}
+      rv = EXIT_FAILURE;
+      goto clean;
+   }
+
+   for (i = 0; i < threads; i++)
+      workers[i] = sthread_create(dat_parse_worker, &queue);
+
+   /* Also covers the case where threads could not be created. */
+   dat_parse_worker(&queue);
 
-	dst = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+   for (i = 0; i < threads; i++)
+      if (workers[i])
+         sthread_join(workers[i]);
 
-	if (dst == -1)
+   for (i = 0; i < files_len; i++)
    {
-		printf("Could not open destination file '%s': %s\n", argv[1], strerror(errno));
-		rv = errno;
-		goto clean;
-	}
+      if (files[i].rv < 0)
+      {
+         rv = EXIT_FAILURE;
+         goto clean;
+      }
+      games += files[i].games_len;
+   }
+
+   t_parse = now_seconds();
+
+   if (dat_merge(files, files_len, match_key, &emit.records, &emit.count) < 0)
+   {
+      rv = EXIT_FAILURE;
+      goto clean;
+   }
 
-	rv = rarchdb_create(dst, &dat_value_provider, &src);
+   t_merge = now_seconds();
+
+   qsort(emit.records, emit.count, sizeof(*emit.records), dat_record_compare);
+
+   t_sort = now_seconds();
+
+   dst = open(argv[1], O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+
+   if (dst == -1)
+   {
+      printf("Could not open destination file '%s': %s\n", argv[1], strerror(errno));
+      rv = EXIT_FAILURE;
+      goto clean;
+   }
+
+   if ((rv = libretrodb_create(dst, &dat_value_provider, &emit)) < 0)
+   {
+      printf("Could not write '%s': %s\n", argv[1], strerror(-rv));
+      rv = EXIT_FAILURE;
+      goto clean;
+   }
+
+   rv      = EXIT_SUCCESS;
+   t_write = now_seconds();
+
+   printf("Parsed %lu games from %lu dat files on %u threads in %.3fs\n",
+         (unsigned long)games, (unsigned long)files_len, threads + 1,
+         t_parse - t_start);
+   printf("Merged into %lu entries in %.3fs\n",
+         (unsigned long)emit.count, t_merge - t_parse);
+   printf("Sorted in %.3fs\n", t_sort - t_merge);
+   printf("Wrote '%s' in %.3fs\n", argv[1], t_write - t_sort);
+   printf("Total: %.3fs\n", t_write - t_start);
 
 clean:
-	if (src != -1)
-		close(src);
-	if (dst != -1)
-		close(dst);
-	return rv;
+   if (dst != -1)
+      close(dst);
+   for (i = 0; i < emit.count; i++)
+      free(emit.records[i].tables);
+   free(emit.records);
+   for (i = 0; i < files_len; i++)
+   {
+      size_t j;
+      for (j = 0; j < files[i].games_len; j++)
+         dat_table_free(files[i].games[j]);
+      free(files[i].games);
+      free(files[i].buff);
+   }
+   free(files);
+   free(workers);
+   if (queue.lock)
+      slock_free(queue.lock);
+   return rv;
 }
@@ -3,6 +3,7 @@
 #include <sys/types.h>
 #ifdef _WIN32
 #include <direct.h>
+#include <io.h>
 #else
 #include <unistd.h>
 #endif
@@ -11,6 +12,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <ctype.h>
 
 #include <stdio.h>
 
@@ -22,22 +24,43 @@
 
 struct node_iter_ctx
 {
-	libretrodb_t *db;
+	struct rmsgpack_writer *writer;
 	libretrodb_index_t *idx;
 };
 
 static struct rmsgpack_dom_value sentinal;
 
+static size_t write_block_size = RMSGPACK_DEFAULT_BLOCK_SIZE;
+
+void libretrodb_set_write_block_size(size_t block_size)
+{
+   write_block_size = block_size;
+}
+
+static int libretrodb_sync(int fd)
+{
+#ifdef _WIN32
+   return _commit(fd);
+#else
+   return fsync(fd);
+#endif
+}
+
 static int libretrodb_read_metadata(int fd, libretrodb_metadata_t *md)
 {
    return rmsgpack_dom_read_into(fd, "count", &md->count, NULL);
 }
 
-static int libretrodb_write_metadata(int fd, libretrodb_metadata_t *md)
+static int libretrodb_write_metadata(struct rmsgpack_writer *writer,
+      libretrodb_metadata_t *md)
 {
-   rmsgpack_write_map_header(fd, 1);
-   rmsgpack_write_string(fd, "count", strlen("count"));
-   return rmsgpack_write_uint(fd, md->count);
+   int rv;
+
+   if ((rv = rmsgpack_write_map_header(writer, 1)) < 0)
+      return rv;
+   if ((rv = rmsgpack_write_string(writer, "count", strlen("count"))) < 0)
+      return rv;
+   return rmsgpack_write_uint(writer, md->count);
 }
 
 static int validate_document(const struct rmsgpack_dom_value * doc)
@@ -79,6 +102,7 @@ int libretrodb_create(int fd, libretrodb_value_provider value_provider,
 {
    int rv;
    off_t root;
+   struct rmsgpack_writer writer;
    libretrodb_metadata_t md;
    uint64_t item_count = 0;
    struct rmsgpack_dom_value item = {};
@@ -92,29 +116,45 @@ int libretrodb_create(int fd, libretrodb_value_provider value_provider,
 
    lseek(fd, sizeof(libretrodb_header_t), SEEK_CUR);
 
+   if ((rv = rmsgpack_writer_init_buffered(&writer,
+               fd, write_block_size)) < 0)
+      return rv;
+
    while ((rv = value_provider(ctx, &item)) == 0)
    {
       if ((rv = validate_document(&item)) < 0)
          goto clean;
 
-      if ((rv = rmsgpack_dom_write(fd, &item)) < 0)
+      if ((rv = rmsgpack_dom_write(&writer, &item)) < 0)
          goto clean;
 
+      rmsgpack_dom_value_free(&item);
+      item.type = RDT_NULL;
       item_count++;
    }
 
    if (rv < 0)
       goto clean;
 
-   if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
+   if ((rv = rmsgpack_dom_write(&writer, &sentinal)) < 0)
+      goto clean;
+
+   if ((rv = rmsgpack_writer_flush(&writer)) < 0)
       goto clean;
 
    header.metadata_offset = httobe64(lseek(fd, 0, SEEK_CUR));
    md.count = item_count;
-   libretrodb_write_metadata(fd, &md);
+   if ((rv = libretrodb_write_metadata(&writer, &md)) < 0)
+      goto clean;
+
+   if ((rv = rmsgpack_writer_flush(&writer)) < 0)
+      goto clean;
+
    lseek(fd, root, SEEK_SET);
    write(fd, &header, sizeof(header));
+   libretrodb_sync(fd);
 clean:
+   rmsgpack_writer_free(&writer);
    rmsgpack_dom_value_free(&item);
    return rv;
 }
@@ -128,21 +168,34 @@ static int libretrodb_read_index_header(int fd, libretrodb_index_t *idx)
          "next", &idx->next, NULL);
 }
 
-static void libretrodb_write_index_header(int fd, libretrodb_index_t * idx)
+static int libretrodb_write_index_header(struct rmsgpack_writer *writer,
+      libretrodb_index_t * idx)
 {
-	rmsgpack_write_map_header(fd, 3);
-	rmsgpack_write_string(fd, "name", strlen("name"));
-	rmsgpack_write_string(fd, idx->name, strlen(idx->name));
-	rmsgpack_write_string(fd, "key_size", strlen("key_size"));
-	rmsgpack_write_uint(fd, idx->key_size);
-	rmsgpack_write_string(fd, "next", strlen("next"));
-	rmsgpack_write_uint(fd, idx->next);
+	int rv;
+
+	if ((rv = rmsgpack_write_map_header(writer, 3)) < 0)
+		return rv;
+	if ((rv = rmsgpack_write_string(writer, "name", strlen("name"))) < 0)
+		return rv;
+	if ((rv = rmsgpack_write_string(writer, idx->name, strlen(idx->name))) < 0)
+		return rv;
+	if ((rv = rmsgpack_write_string(writer, "key_size", strlen("key_size"))) < 0)
+		return rv;
+	if ((rv = rmsgpack_write_uint(writer, idx->key_size)) < 0)
+		return rv;
+	if ((rv = rmsgpack_write_string(writer, "next", strlen("next"))) < 0)
+		return rv;
+	return rmsgpack_write_uint(writer, idx->next);
 }
 
+static void libretrodb_text_index_free(struct libretrodb_text_index *ti);
+
 void libretrodb_close(libretrodb_t *db)
 {
 	close(db->fd);
 	db->fd = -1;
+	libretrodb_text_index_free(db->text_index);
+	db->text_index = NULL;
 }
 
 int libretrodb_open(const char *path, libretrodb_t *db)
@@ -164,7 +217,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)-1) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -180,6 +233,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    }
 
    db->count = md.count;
+   db->text_index = NULL;
    db->first_index_offset = lseek(fd, 0, SEEK_CUR);
    db->fd = fd;
    return 0;
@@ -188,8 +242,9 @@ error:
    return rv;
 }
 
-static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
-      libretrodb_index_t *idx)
+/* Text indexes are stored with a key_size of 0. */
+static int libretrodb_find_index_of_type(libretrodb_t *db,
+      const char *index_name, libretrodb_index_t *idx, int text)
 {
    off_t eof    = lseek(db->fd, 0, SEEK_END);
    off_t offset = lseek(db->fd, db->first_index_offset, SEEK_SET);
@@ -198,7 +253,8 @@ static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
    {
       libretrodb_read_index_header(db->fd, idx);
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0
+            && (idx->key_size == 0) == text)
          return 0;
 
       offset = lseek(db->fd, idx->next, SEEK_CUR);
@@ -207,6 +263,12 @@ static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
    return -1;
 }
 
+static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
+      libretrodb_index_t *idx)
+{
+   return libretrodb_find_index_of_type(db, index_name, idx, 0);
+}
+
 static int node_compare(const void * a, const void * b, void * ctx)
 {
    return memcmp(a, b, *(uint8_t *)ctx);
@@ -215,25 +277,55 @@ static int node_compare(const void * a, const void * b, void * ctx)
 static int binsearch(const void * buff, const void * item,
       uint64_t count, uint8_t field_size, uint64_t * offset)
 {
-   int mid            = count / 2;
+   int rv;
+   uint64_t mid;
    int item_size      = field_size + sizeof(uint64_t);
-   uint64_t * current = (uint64_t *)buff + (mid * item_size);
-   int rv             = node_compare(current, item, &field_size);
+   const uint8_t *current;
+
+   if (count == 0)
+      return -1;
+
+   mid     = count / 2;
+   current = (const uint8_t *)buff + (mid * item_size);
+   rv      = node_compare(current, item, &field_size);
 
    if (rv == 0)
    {
-      *offset = *(uint64_t *)(current + field_size);
+      memcpy(offset, current + field_size, sizeof(uint64_t));
       return 0;
    }
 
-   if (count == 0)
-      return -1;
-
    if (rv > 0)
       return binsearch(buff, item, mid, field_size, offset);
 
    return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+         count - mid - 1, field_size, offset);
+}
+
+static void *libretrodb_read_index(libretrodb_t *db,
+      const libretrodb_index_t *idx)
+{
+   ssize_t rv;
+   ssize_t bufflen = idx->next;
+   ssize_t nread   = 0;
+   uint8_t *buff   = (uint8_t *)malloc(bufflen);
+
+   if (!buff)
+      return NULL;
+
+   while (nread < bufflen)
+   {
+      rv = read(db->fd, buff + nread, bufflen - nread);
+
+      if (rv <= 0)
+      {
+         free(buff);
+         return NULL;
+      }
+      nread += rv;
+   }
+
+   return buff;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
@@ -243,41 +335,182 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
    int rv;
    void * buff;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
 
    if (libretrodb_find_index(db, index_name, &idx) < 0)
       return -1;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
+   buff = libretrodb_read_index(db, &idx);
 
    if (!buff)
       return -ENOMEM;
 
-   while (nread < bufflen)
+   rv = binsearch(buff, key, db->count, idx.key_size, &offset);
+   free(buff);
+
+   if (rv != 0)
+      return -1;
+
+   lseek(db->fd, offset, SEEK_SET);
+
+   return rmsgpack_dom_read(db->fd, out);
+}
+
+struct libretrodb_probe
+{
+   const void *key;
+   uint64_t key_index;
+   uint64_t offset;
+   uint8_t key_size;
+   int found;
+};
+
+static int probe_key_compare(const void *a, const void *b)
+{
+   const struct libretrodb_probe *pa = (const struct libretrodb_probe*)a;
+   const struct libretrodb_probe *pb = (const struct libretrodb_probe*)b;
+
+   return memcmp(pa->key, pb->key, pa->key_size);
+}
+
+static int probe_offset_compare(const void *a, const void *b)
+{
+   const struct libretrodb_probe *pa = (const struct libretrodb_probe*)a;
+   const struct libretrodb_probe *pb = (const struct libretrodb_probe*)b;
+
+   /* Not found probes sort last so the read pass can stop early. */
+   if (pa->found != pb->found)
+      return pa->found ? -1 : 1;
+   if (pa->offset < pb->offset)
+      return -1;
+   if (pa->offset > pb->offset)
+      return 1;
+   return 0;
+}
+
+/**
+ * libretrodb_find_entries:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @keys                : Array of @count pointers to keys.
+ * @count               : Number of keys.
+ * @handler             : Called once for every key that was found.
+ * @ctx                 : User data passed to @handler.
+ * @found_count         : Set to the number of keys found in the index,
+ *                        may be NULL.
+ *
+ * Looks up many keys with a single pass over the index. The keys are
+ * sorted and merged against the (sorted) index, and matching documents
+ * are then read in file order so the database is scanned front to back
+ * at most once instead of seeking for every key.
+ *
+ * The item passed to @handler is only valid for the duration of the
+ * call. Returning non-zero from @handler stops the lookup.
+ *
+ * Returns: 0 if every found key was handled, the non-zero value
+ * returned by @handler if it stopped the lookup, or negative on error.
+ **/
+int libretrodb_find_entries(libretrodb_t *db, const char *index_name,
+      const void * const *keys, uint64_t count,
+      libretrodb_entry_handler handler, void *ctx, uint64_t *found_count)
+{
+   libretrodb_index_t idx;
+   struct rmsgpack_dom_value item;
+   struct libretrodb_probe *probes = NULL;
+   const uint8_t *entry, *end;
+   uint8_t *buff     = NULL;
+   uint64_t item_loc = 0;
+   uint64_t found    = 0;
+   uint64_t i        = 0;
+   size_t item_size;
+   int have_item     = 0;
+   int rv            = 0;
+
+   if (found_count)
+      *found_count = 0;
+
+   if (count == 0)
+      return 0;
+
+   if (libretrodb_find_index(db, index_name, &idx) < 0)
+      return -1;
+
+   probes = (struct libretrodb_probe*)calloc(count, sizeof(*probes));
+   buff   = (uint8_t*)libretrodb_read_index(db, &idx);
+
+   if (!probes || !buff)
    {
-      void * buff_ = (uint64_t *)buff + nread;
-      rv = read(db->fd, buff_, bufflen - nread);
+      rv = -ENOMEM;
+      goto clean;
+   }
 
-      if (rv <= 0)
+   for (i = 0; i < count; i++)
+   {
+      probes[i].key       = keys[i];
+      probes[i].key_index = i;
+      probes[i].key_size  = idx.key_size;
+   }
+
+   qsort(probes, count, sizeof(*probes), probe_key_compare);
+
+   item_size = idx.key_size + sizeof(uint64_t);
+   entry     = buff;
+   end       = buff + db->count * item_size;
+   i         = 0;
+
+   while (entry < end && i < count)
+   {
+      int cmp = memcmp(entry, probes[i].key, idx.key_size);
+
+      if (cmp < 0)
+         entry += item_size;
+      else if (cmp > 0)
+         i++;
+      else
       {
-         free(buff);
-         return -errno;
+         memcpy(&probes[i].offset, entry + idx.key_size, sizeof(uint64_t));
+         probes[i].found = 1;
+         found++;
+         i++;
       }
-      nread += rv;
    }
 
-   rv = binsearch(buff, key, db->count, idx.key_size, &offset);
    free(buff);
+   buff = NULL;
 
-   if (rv == 0)
-      lseek(db->fd, offset, SEEK_SET);
+   if (found_count)
+      *found_count = found;
 
-   rv = rmsgpack_dom_read(db->fd, out);
+   qsort(probes, count, sizeof(*probes), probe_offset_compare);
 
-   if (rv < 0)
-      return rv;
+   for (i = 0; i < found; i++)
+   {
+      if (!have_item || probes[i].offset != item_loc)
+      {
+         if (have_item)
+            rmsgpack_dom_value_free(&item);
+         have_item = 0;
+
+         item_loc = probes[i].offset;
+         if (lseek(db->fd, item_loc, SEEK_SET) == (off_t)-1)
+         {
+            rv = -errno;
+            goto clean;
+         }
+
+         if ((rv = rmsgpack_dom_read(db->fd, &item)) < 0)
+            goto clean;
+         have_item = 1;
+      }
+
+      if ((rv = handler(ctx, probes[i].key_index, &item)) != 0)
+         goto clean;
+   }
 
+clean:
+   if (have_item)
+      rmsgpack_dom_value_free(&item);
+   free(buff);
+   free(probes);
    return rv;
 }
 
@@ -292,6 +525,7 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
 	cursor->eof = 0;
+	cursor->candidate = 0;
 	return lseek(cursor->fd,
          cursor->db->root + sizeof(libretrodb_header_t),
          SEEK_SET);
@@ -301,11 +535,25 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value * out)
 {
    int rv;
+   const uint64_t *candidates = NULL;
+   uint64_t candidate_count   = 0;
 
    if (cursor->eof)
       return EOF;
 
 retry:
+   if (cursor->query && libretrodb_query_get_candidates(cursor->query,
+            &candidates, &candidate_count))
+   {
+      if (cursor->candidate >= candidate_count)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      lseek(cursor->fd, candidates[cursor->candidate++], SEEK_SET);
+   }
+
    rv = rmsgpack_dom_read(cursor->fd, out);
    if (rv < 0)
       return rv;
@@ -319,7 +567,10 @@ retry:
    if (cursor->query)
    {
       if (!libretrodb_query_filter(cursor->query, out))
+      {
+         rmsgpack_dom_value_free(out);
          goto retry;
+      }
    }
 
    return 0;
@@ -380,12 +631,14 @@ int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
 static int node_iter(void * value, void * ctx)
 {
 	struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
+	int rv = rmsgpack_write_raw(nictx->writer, value,
+			nictx->idx->key_size + sizeof(uint64_t));
 
-	if (write(nictx->db->fd, value,
-            nictx->idx->key_size + sizeof(uint64_t)) > 0)
-		return 0;
+	/* bintree_iterate() stops on, and returns, a non-zero value. */
+	if (rv < 0)
+		return rv;
 
-	return -1;
+	return 0;
 }
 
 static uint64_t libretrodb_tell(libretrodb_t *db)
@@ -396,8 +649,9 @@ static uint64_t libretrodb_tell(libretrodb_t *db)
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-	int rv;
+	int rv = 0;
 	struct node_iter_ctx nictx;
+	struct rmsgpack_writer writer;
 	struct rmsgpack_dom_value key;
 	libretrodb_index_t idx;
 	struct rmsgpack_dom_value item;
@@ -408,7 +662,7 @@ int libretrodb_create_index(libretrodb_t *db,
 	void * buff = NULL;
 	uint64_t * buff_u64 = NULL;
 	uint8_t field_size = 0;
-	uint64_t item_loc = libretrodb_tell(db);
+	uint64_t item_loc = 0;
 
 	bintree_new(&tree, node_compare, &field_size);
 
@@ -418,6 +672,9 @@ int libretrodb_create_index(libretrodb_t *db,
 		goto clean;
 	}
 
+	/* The cursor shares its file offset with db->fd */
+	item_loc = libretrodb_tell(db);
+
 	key.type = RDT_STRING;
 	key.string.len = strlen(field_name);
 
@@ -474,7 +731,7 @@ int libretrodb_create_index(libretrodb_t *db,
 
 		memcpy(buff, field->binary.buff, field_size);
 
-		buff_u64 = (uint64_t *)buff + field_size;
+		buff_u64 = (uint64_t *)((uint8_t *)buff + field_size);
 
 		memcpy(buff_u64, &item_loc, sizeof(uint64_t));
 
@@ -491,7 +748,6 @@ int libretrodb_create_index(libretrodb_t *db,
 		item_loc = libretrodb_tell(db);
 	}
 
-	(void)rv;
 	(void)idx_header_offset;
 
 	idx_header_offset = lseek(db->fd, 0, SEEK_END);
@@ -500,17 +756,609 @@ int libretrodb_create_index(libretrodb_t *db,
 	idx.name[49] = '\0';
 	idx.key_size = field_size;
 	idx.next = db->count * (field_size + sizeof(uint64_t));
-	libretrodb_write_index_header(db->fd, &idx);
+	if ((rv = rmsgpack_writer_init_buffered(&writer,
+					db->fd, write_block_size)) < 0)
+		goto clean;
 
-	nictx.db = db;
+	nictx.writer = &writer;
 	nictx.idx = &idx;
-	bintree_iterate(&tree, node_iter, &nictx);
-	bintree_free(&tree);
+
+	if ((rv = libretrodb_write_index_header(&writer, &idx)) >= 0)
+		rv = bintree_iterate(&tree, node_iter, &nictx);
+
+	/* Flush even after a failed write, but report the first error. */
+	if (rv >= 0)
+		rv = rmsgpack_writer_free(&writer);
+	else
+		rmsgpack_writer_free(&writer);
+
+	if (rv >= 0)
+		rv = libretrodb_sync(db->fd) == 0 ? 0 : -errno;
 clean:
+	bintree_free(&tree);
 	rmsgpack_dom_value_free(&item);
 	if (buff)
 		free(buff);
 	if (cur.is_valid)
 		libretrodb_cursor_close(&cur);
-	return 0;
+	return rv;
+}
+
+/* Text index
+ *
+ * Stored after an index header with a key_size of 0, as:
+ *
+ *   libretrodb_text_index_header_t
+ *   libretrodb_text_entry_t  entries[entry_count]  sorted on value
+ *   libretrodb_text_gram_t   grams[gram_count]     sorted on gram
+ *   uint32_t                 postings[posting_count]
+ *   char                     pool[pool_size]
+ *
+ * All integers are big endian, like the rest of the format. Values
+ * are lowercased and NUL terminated in the pool. Each gram lists, in
+ * order, the entries whose value contains that trigram. */
+
+typedef struct
+{
+   uint64_t entry_count;
+   uint64_t pool_size;
+   uint64_t gram_count;
+   uint64_t posting_count;
+} libretrodb_text_index_header_t;
+
+typedef struct
+{
+   uint64_t offset;
+   uint32_t str_off;
+   uint32_t str_len;
+} libretrodb_text_entry_t;
+
+typedef struct
+{
+   uint32_t gram;
+   uint32_t first;
+   uint32_t count;
+} libretrodb_text_gram_t;
+
+struct libretrodb_text_index
+{
+   char name[50];
+   void *buff;
+   libretrodb_text_index_header_t header;
+   const libretrodb_text_entry_t *entries;
+   const libretrodb_text_gram_t *grams;
+   const uint32_t *postings;
+   const char *pool;
+};
+
+static void libretrodb_text_index_free(struct libretrodb_text_index *ti)
+{
+   if (!ti)
+      return;
+   free(ti->buff);
+   free(ti);
+}
+
+/* Byte swapping is its own inverse, so these convert both ways. */
+
+static void text_index_header_swap(libretrodb_text_index_header_t *th)
+{
+   th->entry_count   = httobe64(th->entry_count);
+   th->pool_size     = httobe64(th->pool_size);
+   th->gram_count    = httobe64(th->gram_count);
+   th->posting_count = httobe64(th->posting_count);
+}
+
+/* Counts are taken from a host order header. */
+static void text_index_arrays_swap(const libretrodb_text_index_header_t *th,
+      libretrodb_text_entry_t *entries, libretrodb_text_gram_t *grams,
+      uint32_t *postings)
+{
+   uint64_t i;
+
+   if (!is_little_endian())
+      return;
+
+   for (i = 0; i < th->entry_count; i++)
+   {
+      entries[i].offset  = swap64(entries[i].offset);
+      entries[i].str_off = SWAP32(entries[i].str_off);
+      entries[i].str_len = SWAP32(entries[i].str_len);
+   }
+
+   for (i = 0; i < th->gram_count; i++)
+   {
+      grams[i].gram  = SWAP32(grams[i].gram);
+      grams[i].first = SWAP32(grams[i].first);
+      grams[i].count = SWAP32(grams[i].count);
+   }
+
+   for (i = 0; i < th->posting_count; i++)
+      postings[i] = SWAP32(postings[i]);
+}
+
+static uint32_t text_gram(const char *s)
+{
+   return ((uint32_t)(uint8_t)s[0] << 16)
+      | ((uint32_t)(uint8_t)s[1] << 8)
+      | (uint8_t)s[2];
+}
+
+static int uint64_compare(const void *a, const void *b)
+{
+   uint64_t ua = *(const uint64_t*)a;
+   uint64_t ub = *(const uint64_t*)b;
+   return (ua > ub) - (ua < ub);
+}
+
+/* qsort has no context argument; entries are sorted through this
+ * wrapper which carries the pool pointer alongside each entry. */
+typedef struct
+{
+   libretrodb_text_entry_t entry;
+   const char *pool;
+} text_sort_entry_t;
+
+static int text_entry_compare(const void *a, const void *b)
+{
+   const text_sort_entry_t *ea = (const text_sort_entry_t*)a;
+   const text_sort_entry_t *eb = (const text_sort_entry_t*)b;
+   return strcmp(ea->pool + ea->entry.str_off, eb->pool + eb->entry.str_off);
+}
+
+int libretrodb_create_text_index(libretrodb_t *db, const char *field_name)
+{
+   int rv = 0;
+   uint64_t i, j;
+   libretrodb_index_t idx;
+   libretrodb_cursor_t cur;
+   libretrodb_text_index_header_t th, th_be;
+   struct rmsgpack_writer writer;
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value item;
+   struct rmsgpack_dom_value *field;
+   text_sort_entry_t *sorted       = NULL;
+   libretrodb_text_entry_t *entries = NULL;
+   libretrodb_text_gram_t *grams    = NULL;
+   uint64_t *pairs                  = NULL;
+   uint32_t *postings               = NULL;
+   char *pool                       = NULL;
+   uint64_t entry_cap = 0, pool_cap = 0, pair_count = 0;
+   uint64_t item_loc;
+
+   memset(&th, 0, sizeof(th));
+   item.type = RDT_NULL;
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      return -1;
+
+   item_loc = libretrodb_tell(db);
+
+   key.type        = RDT_STRING;
+   key.string.len  = strlen(field_name);
+   key.string.buff = (char *) field_name;
+
+   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   {
+      field = rmsgpack_dom_value_map_value(&item, &key);
+
+      if (field && field->type == RDT_STRING)
+      {
+         if (th.entry_count == entry_cap)
+         {
+            entry_cap = entry_cap ? entry_cap * 2 : 1024;
+            sorted    = (text_sort_entry_t*)realloc(sorted,
+                  entry_cap * sizeof(*sorted));
+            if (!sorted)
+            {
+               rv = -ENOMEM;
+               goto clean;
+            }
+         }
+
+         while (th.pool_size + field->string.len + 1 > pool_cap)
+         {
+            pool_cap = pool_cap ? pool_cap * 2 : 64 * 1024;
+            pool     = (char*)realloc(pool, pool_cap);
+            if (!pool)
+            {
+               rv = -ENOMEM;
+               goto clean;
+            }
+         }
+
+         sorted[th.entry_count].entry.offset  = item_loc;
+         sorted[th.entry_count].entry.str_off = th.pool_size;
+         sorted[th.entry_count].entry.str_len = field->string.len;
+
+         for (i = 0; i < field->string.len; i++)
+            pool[th.pool_size + i] = tolower((uint8_t)field->string.buff[i]);
+         pool[th.pool_size + field->string.len] = '\0';
+
+         th.pool_size += field->string.len + 1;
+         th.entry_count++;
+      }
+
+      rmsgpack_dom_value_free(&item);
+      item.type = RDT_NULL;
+      item_loc  = libretrodb_tell(db);
+   }
+
+   for (i = 0; i < th.entry_count; i++)
+      sorted[i].pool = pool;
+
+   if (th.entry_count)
+      qsort(sorted, th.entry_count, sizeof(*sorted), text_entry_compare);
+
+   entries = (libretrodb_text_entry_t*)malloc(
+         (th.entry_count ? th.entry_count : 1) * sizeof(*entries));
+   if (!entries)
+   {
+      rv = -ENOMEM;
+      goto clean;
+   }
+
+   for (i = 0; i < th.entry_count; i++)
+   {
+      entries[i] = sorted[i].entry;
+      if (entries[i].str_len >= 3)
+         pair_count += entries[i].str_len - 2;
+   }
+
+   pairs = (uint64_t*)malloc((pair_count ? pair_count : 1) * sizeof(*pairs));
+   if (!pairs)
+   {
+      rv = -ENOMEM;
+      goto clean;
+   }
+
+   for (i = 0, j = 0; i < th.entry_count; i++)
+   {
+      uint32_t k;
+      const char *s = pool + entries[i].str_off;
+
+      for (k = 0; k + 3 <= entries[i].str_len; k++)
+         pairs[j++] = ((uint64_t)text_gram(s + k) << 32) | i;
+   }
+
+   /* (gram << 32 | entry) pairs, sorted on gram then entry */
+   qsort(pairs, pair_count, sizeof(*pairs), uint64_compare);
+
+   postings = (uint32_t*)malloc((pair_count ? pair_count : 1) * sizeof(*postings));
+   grams    = (libretrodb_text_gram_t*)malloc(
+         (pair_count ? pair_count : 1) * sizeof(*grams));
+   if (!postings || !grams)
+   {
+      rv = -ENOMEM;
+      goto clean;
+   }
+
+   for (i = 0; i < pair_count; i++)
+   {
+      uint32_t gram  = pairs[i] >> 32;
+      uint32_t entry = (uint32_t)pairs[i];
+
+      /* A value containing the same trigram twice is listed once. */
+      if (i > 0 && pairs[i] == pairs[i - 1])
+         continue;
+
+      if (th.gram_count == 0 || grams[th.gram_count - 1].gram != gram)
+      {
+         grams[th.gram_count].gram  = gram;
+         grams[th.gram_count].first = th.posting_count;
+         grams[th.gram_count].count = 0;
+         th.gram_count++;
+      }
+
+      postings[th.posting_count++] = entry;
+      grams[th.gram_count - 1].count++;
+   }
+
+   lseek(db->fd, 0, SEEK_END);
+   strncpy(idx.name, field_name, 50);
+   idx.name[49] = '\0';
+   idx.key_size = 0;
+   idx.next     = sizeof(th)
+      + th.entry_count   * sizeof(*entries)
+      + th.gram_count    * sizeof(*grams)
+      + th.posting_count * sizeof(*postings)
+      + th.pool_size;
+
+   if ((rv = rmsgpack_writer_init_buffered(&writer,
+               db->fd, write_block_size)) < 0)
+      goto clean;
+
+   /* The arrays are not used past this point, swap them in place. */
+   text_index_arrays_swap(&th, entries, grams, postings);
+   th_be = th;
+   text_index_header_swap(&th_be);
+
+   if ((rv = libretrodb_write_index_header(&writer, &idx)) >= 0
+         && (rv = rmsgpack_write_raw(&writer, &th_be, sizeof(th_be))) >= 0
+         && (rv = rmsgpack_write_raw(&writer, entries,
+               th.entry_count * sizeof(*entries))) >= 0
+         && (rv = rmsgpack_write_raw(&writer, grams,
+               th.gram_count * sizeof(*grams))) >= 0
+         && (rv = rmsgpack_write_raw(&writer, postings,
+               th.posting_count * sizeof(*postings))) >= 0)
+      rv = rmsgpack_write_raw(&writer, pool, th.pool_size);
+
+   /* Flush even after a failed write, but report the first error. */
+   if (rv >= 0)
+      rv = rmsgpack_writer_free(&writer);
+   else
+      rmsgpack_writer_free(&writer);
+
+   if (rv >= 0)
+      rv = libretrodb_sync(db->fd) == 0 ? 0 : -errno;
+
+clean:
+   rmsgpack_dom_value_free(&item);
+   libretrodb_cursor_close(&cur);
+   free(sorted);
+   free(entries);
+   free(pairs);
+   free(postings);
+   free(grams);
+   free(pool);
+   return rv;
+}
+
+/* Checks that the counts in a host order header fit the payload
+ * exactly, without overflowing on the way. */
+static int text_index_check_header(const libretrodb_text_index_header_t *th,
+      uint64_t size)
+{
+   if (size < sizeof(*th))
+      return -1;
+   size -= sizeof(*th);
+
+   if (th->entry_count > size / sizeof(libretrodb_text_entry_t))
+      return -1;
+   size -= th->entry_count * sizeof(libretrodb_text_entry_t);
+
+   if (th->gram_count > size / sizeof(libretrodb_text_gram_t))
+      return -1;
+   size -= th->gram_count * sizeof(libretrodb_text_gram_t);
+
+   if (th->posting_count > size / sizeof(uint32_t))
+      return -1;
+   size -= th->posting_count * sizeof(uint32_t);
+
+   if (th->pool_size != size)
+      return -1;
+
+   /* Postings store entry numbers as 32 bit values. */
+   if (th->entry_count > UINT32_MAX)
+      return -1;
+
+   return 0;
+}
+
+/* Checks that every string, posting list and posting is in range,
+ * so searches never index past the payload. */
+static int text_index_check_arrays(const struct libretrodb_text_index *ti)
+{
+   uint64_t i;
+   const libretrodb_text_index_header_t *th = &ti->header;
+
+   if (th->entry_count && (th->pool_size == 0
+            || ti->pool[th->pool_size - 1] != '\0'))
+      return -1;
+
+   for (i = 0; i < th->entry_count; i++)
+   {
+      const libretrodb_text_entry_t *e = &ti->entries[i];
+
+      if (e->str_off >= th->pool_size
+            || e->str_len >= th->pool_size - e->str_off)
+         return -1;
+   }
+
+   for (i = 0; i < th->gram_count; i++)
+   {
+      const libretrodb_text_gram_t *g = &ti->grams[i];
+
+      if ((uint64_t)g->first + g->count > th->posting_count)
+         return -1;
+   }
+
+   for (i = 0; i < th->posting_count; i++)
+      if (ti->postings[i] >= th->entry_count)
+         return -1;
+
+   return 0;
+}
+
+static struct libretrodb_text_index *libretrodb_text_index_load(
+      libretrodb_t *db, const char *field_name)
+{
+   off_t pos, eof;
+   libretrodb_index_t idx;
+   uint8_t *p;
+   libretrodb_text_entry_t *entries;
+   libretrodb_text_gram_t *grams;
+   uint32_t *postings;
+   struct libretrodb_text_index *ti = db->text_index;
+
+   if (ti && !strcmp(ti->name, field_name))
+      return ti;
+
+   if (libretrodb_find_index_of_type(db, field_name, &idx, 1) < 0)
+      return NULL;
+
+   /* Do not trust idx.next for the allocation size before checking
+    * it against what is actually left in the file. */
+   pos = lseek(db->fd, 0, SEEK_CUR);
+   eof = lseek(db->fd, 0, SEEK_END);
+
+   if (pos < 0 || eof < pos || idx.next > (uint64_t)(eof - pos)
+         || idx.next < sizeof(libretrodb_text_index_header_t)
+         || lseek(db->fd, pos, SEEK_SET) != pos)
+      return NULL;
+
+   ti = (struct libretrodb_text_index*)calloc(1, sizeof(*ti));
+   if (!ti)
+      return NULL;
+
+   if (!(ti->buff = libretrodb_read_index(db, &idx)))
+   {
+      free(ti);
+      return NULL;
+   }
+
+   strncpy(ti->name, field_name, sizeof(ti->name));
+   ti->name[sizeof(ti->name) - 1] = '\0';
+
+   memcpy(&ti->header, ti->buff, sizeof(ti->header));
+   text_index_header_swap(&ti->header);
+
+   if (text_index_check_header(&ti->header, idx.next) < 0)
+      goto error;
+
+   p         = (uint8_t*)ti->buff + sizeof(ti->header);
+   entries   = (libretrodb_text_entry_t*)p;
+   p        += ti->header.entry_count * sizeof(*entries);
+   grams     = (libretrodb_text_gram_t*)p;
+   p        += ti->header.gram_count * sizeof(*grams);
+   postings  = (uint32_t*)p;
+   p        += ti->header.posting_count * sizeof(*postings);
+
+   text_index_arrays_swap(&ti->header, entries, grams, postings);
+
+   ti->entries  = entries;
+   ti->grams    = grams;
+   ti->postings = postings;
+   ti->pool     = (const char*)p;
+
+   if (text_index_check_arrays(ti) < 0)
+      goto error;
+
+   libretrodb_text_index_free(db->text_index);
+   db->text_index = ti;
+   return ti;
+
+error:
+   libretrodb_text_index_free(ti);
+   return NULL;
+}
+
+static const libretrodb_text_gram_t *text_index_find_gram(
+      const struct libretrodb_text_index *ti, uint32_t gram)
+{
+   uint64_t lo = 0;
+   uint64_t hi = ti->header.gram_count;
+
+   while (lo < hi)
+   {
+      uint64_t mid = lo + (hi - lo) / 2;
+
+      if (ti->grams[mid].gram < gram)
+         lo = mid + 1;
+      else if (ti->grams[mid].gram > gram)
+         hi = mid;
+      else
+         return &ti->grams[mid];
+   }
+
+   return NULL;
+}
+
+int libretrodb_text_index_search(libretrodb_t *db, const char *field_name,
+      const char *needle, int prefix, uint64_t **offsets, uint64_t *count)
+{
+   uint64_t i, lo, hi;
+   size_t needle_len;
+   char *lower                      = NULL;
+   uint64_t *out                    = NULL;
+   uint64_t found                   = 0;
+   struct libretrodb_text_index *ti = libretrodb_text_index_load(db, field_name);
+
+   *offsets = NULL;
+   *count   = 0;
+
+   if (!ti)
+      return -1;
+
+   needle_len = strlen(needle);
+   lower      = (char*)malloc(needle_len + 1);
+   out        = (uint64_t*)malloc(
+         (ti->header.entry_count ? ti->header.entry_count : 1) * sizeof(*out));
+
+   if (!lower || !out)
+   {
+      free(lower);
+      free(out);
+      return -ENOMEM;
+   }
+
+   for (i = 0; i <= needle_len; i++)
+      lower[i] = tolower((uint8_t)needle[i]);
+
+   if (prefix)
+   {
+      lo = 0;
+      hi = ti->header.entry_count;
+
+      while (lo < hi)
+      {
+         uint64_t mid = lo + (hi - lo) / 2;
+
+         if (strcmp(ti->pool + ti->entries[mid].str_off, lower) < 0)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+
+      for (i = lo; i < ti->header.entry_count; i++)
+      {
+         if (strncmp(ti->pool + ti->entries[i].str_off, lower, needle_len))
+            break;
+         out[found++] = ti->entries[i].offset;
+      }
+   }
+   else if (needle_len < 3)
+   {
+      for (i = 0; i < ti->header.entry_count; i++)
+         if (strstr(ti->pool + ti->entries[i].str_off, lower))
+            out[found++] = ti->entries[i].offset;
+   }
+   else
+   {
+      /* Walk the shortest posting list and verify each candidate. */
+      const libretrodb_text_gram_t *best = NULL;
+
+      for (i = 0; i + 3 <= needle_len; i++)
+      {
+         const libretrodb_text_gram_t *g =
+            text_index_find_gram(ti, text_gram(lower + i));
+
+         if (!g)
+         {
+            best = NULL;
+            break;
+         }
+
+         if (!best || g->count < best->count)
+            best = g;
+      }
+
+      for (i = 0; best && i < best->count; i++)
+      {
+         const libretrodb_text_entry_t *e =
+            &ti->entries[ti->postings[best->first + i]];
+
+         if (strstr(ti->pool + e->str_off, lower))
+            out[found++] = e->offset;
+      }
+   }
+
+   free(lower);
+
+   /* Read the documents in file order. */
+   qsort(out, found, sizeof(*out), uint64_compare);
+
+   *offsets = out;
+   *count   = found;
+   return 0;
 }
@@ -2,6 +2,7 @@
 #define __LIBRETRODB_H__
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef _WIN32
 #include <direct.h>
 #else
@@ -17,6 +18,8 @@ extern "C" {
 
 typedef struct libretrodb_query libretrodb_query_t;
 
+struct libretrodb_text_index;
+
 typedef struct libretrodb
 {
 	int fd;
@@ -24,6 +27,8 @@ typedef struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char path[1024];
+   /* Last text index used by a query, kept for incremental searches */
+   struct libretrodb_text_index *text_index;
 } libretrodb_t;
 
 typedef struct libretrodb_index
@@ -51,11 +56,23 @@ typedef struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t * query;
 	libretrodb_t * db;
+	uint64_t candidate;
 } libretrodb_cursor_t;
 
 typedef int (* libretrodb_value_provider)(void * ctx,
       struct rmsgpack_dom_value * out);
 
+typedef int (* libretrodb_entry_handler)(void * ctx,
+      uint64_t key_index, struct rmsgpack_dom_value * item);
+
+/**
+ * libretrodb_set_write_block_size:
+ * @block_size          : Size in bytes of the write buffer used by
+ *                        libretrodb_create and libretrodb_create_index.
+ *                        0 selects RMSGPACK_DEFAULT_BLOCK_SIZE.
+ **/
+void libretrodb_set_write_block_size(size_t block_size);
+
 int libretrodb_create(int fd, libretrodb_value_provider value_provider,
       void * ctx);
 
@@ -73,6 +90,66 @@ int libretrodb_find_entry(
         struct rmsgpack_dom_value * out
 );
 
+/**
+ * libretrodb_create_text_index:
+ * @db                  : Handle to database.
+ * @field_name          : String field to index.
+ *
+ * Appends a case insensitive search index for @field_name to the
+ * database: the lowercased values sorted for prefix searches and a
+ * trigram posting list for substring searches. Queries using
+ * prefix() or contains() on @field_name are answered from it.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_create_text_index(libretrodb_t *db, const char *field_name);
+
+/**
+ * libretrodb_text_index_search:
+ * @db                  : Handle to database.
+ * @field_name          : Field the text index was created for.
+ * @needle              : String to search for (case insensitive).
+ * @prefix              : If non-zero match only at the start of the value,
+ *                        otherwise anywhere in it.
+ * @offsets             : Set to a malloc'd array of matching document
+ *                        offsets in file order. Free with free().
+ * @count               : Set to the number of offsets.
+ *
+ * Returns: 0 if successful, -1 if there is no text index for
+ * @field_name, otherwise negative.
+ **/
+int libretrodb_text_index_search(libretrodb_t *db, const char *field_name,
+      const char *needle, int prefix, uint64_t **offsets, uint64_t *count);
+
+/**
+ * libretrodb_find_entries:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @keys                : Array of @count pointers to keys.
+ * @count               : Number of keys.
+ * @handler             : Called once for every key that was found.
+ * @ctx                 : User data passed to @handler.
+ * @found_count         : Set to the number of keys found in the index,
+ *                        may be NULL.
+ *
+ * Batched version of libretrodb_find_entry(). The index is walked once
+ * and matching documents are read in file order. @handler receives the
+ * position of the key in @keys; the item is freed after it returns.
+ *
+ * Returns: 0 if every found key was handled, the non-zero value
+ * returned by @handler if it stopped the lookup, or negative on error.
+ * The number of matches is only reported through @found_count.
+ **/
+int libretrodb_find_entries(
+        libretrodb_t * db,
+        const char * index_name,
+        const void * const * keys,
+        uint64_t count,
+        libretrodb_entry_handler handler,
+        void * ctx,
+        uint64_t * found_count
+);
+
 /**
  * libretrodb_cursor_open:
  * @db                  : Handle to database.
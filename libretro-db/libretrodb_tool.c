@@ -19,6 +19,7 @@ int main(int argc, char ** argv)
       printf("Available Commands:\n");
       printf("\tlist\n");
       printf("\tcreate-index <index name> <field name>\n");
+      printf("\tcreate-text-index <field name>\n");
       printf("\tfind <query expression>\n");
       return 1;
    }
@@ -96,7 +97,25 @@ int main(int argc, char ** argv)
       index_name = argv[3];
       field_name = argv[4];
 
-      libretrodb_create_index(&db, index_name, field_name);
+      if ((rv = libretrodb_create_index(&db, index_name, field_name)) != 0)
+      {
+         printf("Could not create index: %s\n", strerror(-rv));
+         return 1;
+      }
+   }
+   else if (strcmp(command, "create-text-index") == 0)
+   {
+      if (argc != 4)
+      {
+         printf("Usage: %s <db file> create-text-index <field name>\n", argv[0]);
+         return 1;
+      }
+
+      if ((rv = libretrodb_create_text_index(&db, argv[3])) != 0)
+      {
+         printf("Could not create text index: %s\n", strerror(-rv));
+         return 1;
+      }
    }
    else
    {
@@ -171,6 +171,10 @@ struct query
 {
 	unsigned ref_count;
 	struct invocation root;
+	/* Documents to visit, when a text index could narrow them down */
+	int has_candidates;
+	uint64_t *candidates;
+	uint64_t candidate_count;
 };
 
 struct registered_func
@@ -342,6 +346,71 @@ static struct rmsgpack_dom_value q_glob(struct rmsgpack_dom_value input,
    return res;
 }
 
+static int string_has_prefix_nocase(const char *s, size_t len,
+      const char *prefix, size_t prefix_len)
+{
+   size_t i;
+
+   if (prefix_len > len)
+      return 0;
+
+   for (i = 0; i < prefix_len; i++)
+      if (tolower((unsigned char)s[i]) != tolower((unsigned char)prefix[i]))
+         return 0;
+
+   return 1;
+}
+
+static struct rmsgpack_dom_value q_prefix(struct rmsgpack_dom_value input,
+      unsigned argc, const struct argument * argv)
+{
+   struct rmsgpack_dom_value res;
+
+   res.type = RDT_BOOL;
+   res.bool_ = 0;
+
+   if (argc != 1)
+      return res;
+   if (argv[0].type != AT_VALUE || argv[0].value.type != RDT_STRING)
+      return res;
+   if (input.type != RDT_STRING)
+      return res;
+
+   res.bool_ = string_has_prefix_nocase(input.string.buff, input.string.len,
+         argv[0].value.string.buff, argv[0].value.string.len);
+   return res;
+}
+
+static struct rmsgpack_dom_value q_contains(struct rmsgpack_dom_value input,
+      unsigned argc, const struct argument * argv)
+{
+   size_t i;
+   struct rmsgpack_dom_value res;
+
+   res.type = RDT_BOOL;
+   res.bool_ = 0;
+
+   if (argc != 1)
+      return res;
+   if (argv[0].type != AT_VALUE || argv[0].value.type != RDT_STRING)
+      return res;
+   if (input.type != RDT_STRING)
+      return res;
+
+   for (i = 0; i + argv[0].value.string.len <= input.string.len; i++)
+   {
+      if (string_has_prefix_nocase(input.string.buff + i,
+               input.string.len - i, argv[0].value.string.buff,
+               argv[0].value.string.len))
+      {
+         res.bool_ = 1;
+         break;
+      }
+   }
+
+   return res;
+}
+
 static struct rmsgpack_dom_value all_map(struct rmsgpack_dom_value input,
       unsigned argc, const struct argument *argv)
 {
@@ -400,6 +469,8 @@ struct registered_func registered_functions[100] = {
 	{"and", operator_and},
 	{"between", between},
 	{"glob", q_glob},
+	{"prefix", q_prefix},
+	{"contains", q_contains},
 	{NULL, NULL}
 };
 
@@ -853,6 +924,51 @@ void libretrodb_query_free(void *q)
 
 	for (i = 0; i < real_q->root.argc; i++)
 		argument_free(&real_q->root.argv[i]);
+
+	free(real_q->candidates);
+	real_q->candidates = NULL;
+}
+
+/* Lets {'field': prefix('...')} and {'field': contains('...')} be
+ * answered from a text index on 'field' instead of a full scan. The
+ * filter still runs on every candidate, so other fields in the same
+ * table keep working. */
+static void query_use_text_index(libretrodb_t *db, struct query *q)
+{
+   unsigned i;
+
+   if (!db || q->root.func != all_map)
+      return;
+
+   for (i = 0; i + 1 < q->root.argc; i += 2)
+   {
+      const struct argument *key = &q->root.argv[i];
+      const struct argument *val = &q->root.argv[i + 1];
+      int prefix;
+
+      if (key->type != AT_VALUE || key->value.type != RDT_STRING)
+         continue;
+      if (val->type != AT_FUNCTION || val->invocation.argc != 1)
+         continue;
+      if (val->invocation.argv[0].type != AT_VALUE
+            || val->invocation.argv[0].value.type != RDT_STRING)
+         continue;
+
+      if (val->invocation.func == q_prefix)
+         prefix = 1;
+      else if (val->invocation.func == q_contains)
+         prefix = 0;
+      else
+         continue;
+
+      if (libretrodb_text_index_search(db, key->value.string.buff,
+               val->invocation.argv[0].value.string.buff, prefix,
+               &q->candidates, &q->candidate_count) == 0)
+      {
+         q->has_candidates = 1;
+         return;
+      }
+   }
 }
 
 void *libretrodb_query_compile(libretrodb_t *db,
@@ -892,6 +1008,8 @@ void *libretrodb_query_compile(libretrodb_t *db,
       raise_unexpected_eof(buff.offset, error);
       return NULL;
    }
+
+   query_use_text_index(db, q);
    goto success;
 clean:
    if (q)
@@ -907,6 +1025,19 @@ void libretrodb_query_inc_ref(libretrodb_query_t *q)
       rq->ref_count += 1;
 }
 
+int libretrodb_query_get_candidates(libretrodb_query_t *q,
+      const uint64_t **offsets, uint64_t *count)
+{
+   struct query *rq = (struct query*)q;
+
+   if (!rq || !rq->has_candidates)
+      return 0;
+
+   *offsets = rq->candidates;
+   *count   = rq->candidate_count;
+   return 1;
+}
+
 int libretrodb_query_filter(libretrodb_query_t *q,
       struct rmsgpack_dom_value *v)
 {
@@ -7,6 +7,11 @@ void libretrodb_query_inc_ref(libretrodb_query_t *q);
 
 void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
+/* Returns 1 and the documents to visit, in file order, if the query
+ * could be narrowed down through an index; 0 if a full scan is needed. */
+int libretrodb_query_get_candidates(libretrodb_query_t *q,
+      const uint64_t **offsets, uint64_t *count);
+
 int libretrodb_query_filter(libretrodb_query_t *q,
       struct rmsgpack_dom_value * v);
 
@@ -12,6 +12,7 @@
 #include "rmsgpack.h"
 
 #include <stdlib.h>
+#include <sys/types.h>
 #ifdef _WIN32
 #include <direct.h>
 #else
@@ -55,7 +56,103 @@ static const uint8_t MPF_UINT64 = 0xcf;
 
 static const uint8_t MPF_NIL = 0xc0;
 
-int rmsgpack_write_array_header(int fd, uint32_t size)
+static ssize_t write_all(int fd, const void *data, size_t len)
+{
+   ssize_t rv;
+   size_t written = 0;
+
+   while (written < len)
+   {
+      rv = write(fd, (const uint8_t*)data + written, len - written);
+
+      if (rv == -1)
+      {
+         if (errno == EINTR)
+            continue;
+         return -1;
+      }
+      written += rv;
+   }
+
+   return written;
+}
+
+static ssize_t rmsgpack_out(struct rmsgpack_writer *writer,
+      const void *data, size_t len)
+{
+   if (!writer->buff)
+      return write_all(writer->fd, data, len);
+
+   if (writer->len + len > writer->size)
+   {
+      if (rmsgpack_writer_flush(writer) < 0)
+         return -1;
+
+      if (len >= writer->size)
+         return write_all(writer->fd, data, len);
+   }
+
+   memcpy(writer->buff + writer->len, data, len);
+   writer->len += len;
+   return len;
+}
+
+void rmsgpack_writer_init(struct rmsgpack_writer *writer, int fd)
+{
+   writer->fd   = fd;
+   writer->buff = NULL;
+   writer->size = 0;
+   writer->len  = 0;
+}
+
+int rmsgpack_writer_init_buffered(struct rmsgpack_writer *writer,
+      int fd, size_t block_size)
+{
+   rmsgpack_writer_init(writer, fd);
+
+   if (block_size == 0)
+      block_size = RMSGPACK_DEFAULT_BLOCK_SIZE;
+
+   writer->buff = (uint8_t*)malloc(block_size);
+
+   if (!writer->buff)
+      return -ENOMEM;
+
+   writer->size = block_size;
+   return 0;
+}
+
+int rmsgpack_writer_flush(struct rmsgpack_writer *writer)
+{
+   if (!writer->buff || writer->len == 0)
+      return 0;
+
+   if (write_all(writer->fd, writer->buff, writer->len) == -1)
+      return -errno;
+
+   writer->len = 0;
+   return 0;
+}
+
+int rmsgpack_writer_free(struct rmsgpack_writer *writer)
+{
+   int rv = rmsgpack_writer_flush(writer);
+
+   free(writer->buff);
+   writer->buff = NULL;
+   writer->size = 0;
+   writer->len  = 0;
+   return rv;
+}
+
+int rmsgpack_write_raw(struct rmsgpack_writer *writer, const void *data, uint32_t len)
+{
+   if (rmsgpack_out(writer, data, len) == -1)
+      return -errno;
+   return len;
+}
+
+int rmsgpack_write_array_header(struct rmsgpack_writer *writer, uint32_t size)
 {
    uint16_t tmp_i16;
    uint32_t tmp_i32;
@@ -63,29 +160,29 @@ int rmsgpack_write_array_header(int fd, uint32_t size)
    if (size < 16)
    {
       size = (size | MPF_FIXARRAY);
-      if (write(fd, &size, sizeof(int8_t)) == -1)
+      if (rmsgpack_out(writer, &size, sizeof(int8_t)) == -1)
          return -errno;
       return sizeof(int8_t);
    }
    else if (size == (uint16_t)size)
    {
-      if (write(fd, &MPF_ARRAY16, sizeof(MPF_ARRAY16)) == -1)
+      if (rmsgpack_out(writer, &MPF_ARRAY16, sizeof(MPF_ARRAY16)) == -1)
          return -errno;
       tmp_i16 = httobe16(size);
-      if (write(fd, (void *)(&tmp_i16), sizeof(uint16_t)) == -1)
+      if (rmsgpack_out(writer, (void *)(&tmp_i16), sizeof(uint16_t)) == -1)
          return -errno;
       return sizeof(int8_t) + sizeof(uint16_t);
    }
 
-   if (write(fd, &MPF_ARRAY32, sizeof(MPF_ARRAY32)) == -1)
+   if (rmsgpack_out(writer, &MPF_ARRAY32, sizeof(MPF_ARRAY32)) == -1)
       return -errno;
    tmp_i32 = httobe32(size);
-   if (write(fd, (void *)(&tmp_i32), sizeof(uint32_t)) == -1)
+   if (rmsgpack_out(writer, (void *)(&tmp_i32), sizeof(uint32_t)) == -1)
       return -errno;
    return sizeof(int8_t) + sizeof(uint32_t);
 }
 
-int rmsgpack_write_map_header(int fd, uint32_t size)
+int rmsgpack_write_map_header(struct rmsgpack_writer *writer, uint32_t size)
 {
    uint16_t tmp_i16;
    uint32_t tmp_i32;
@@ -93,29 +190,29 @@ int rmsgpack_write_map_header(int fd, uint32_t size)
    if (size < 16)
    {
       size = (size | MPF_FIXMAP);
-      if (write(fd, &size, sizeof(int8_t)) == -1)
+      if (rmsgpack_out(writer, &size, sizeof(int8_t)) == -1)
          return -errno;
       return sizeof(int8_t);
    }
    else if (size < (uint16_t)size)
    {
-      if (write(fd, &MPF_MAP16, sizeof(MPF_MAP16)) == -1)
+      if (rmsgpack_out(writer, &MPF_MAP16, sizeof(MPF_MAP16)) == -1)
          return -errno;
       tmp_i16 = httobe16(size);
-      if (write(fd, (void *)(&tmp_i16), sizeof(uint16_t)) == -1)
+      if (rmsgpack_out(writer, (void *)(&tmp_i16), sizeof(uint16_t)) == -1)
          return -errno;
       return sizeof(uint8_t) + sizeof(uint16_t);
    }
 
    tmp_i32 = httobe32(size);
-   if (write(fd, &MPF_MAP32, sizeof(MPF_MAP32)) == -1)
+   if (rmsgpack_out(writer, &MPF_MAP32, sizeof(MPF_MAP32)) == -1)
       return -errno;
-   if (write(fd, (void *)(&tmp_i32), sizeof(uint32_t)) == -1)
+   if (rmsgpack_out(writer, (void *)(&tmp_i32), sizeof(uint32_t)) == -1)
       return -errno;
    return sizeof(int8_t) + sizeof(uint32_t);
 }
 
-int rmsgpack_write_string(int fd, const char *s, uint32_t len)
+int rmsgpack_write_string(struct rmsgpack_writer *writer, const char *s, uint32_t len)
 {
    int8_t fixlen = 0;
    uint16_t tmp_i16;
@@ -125,43 +222,43 @@ int rmsgpack_write_string(int fd, const char *s, uint32_t len)
    if (len < 32)
    {
       fixlen = len | MPF_FIXSTR;
-      if (write(fd, &fixlen, sizeof(int8_t)) == -1)
+      if (rmsgpack_out(writer, &fixlen, sizeof(int8_t)) == -1)
          return -errno;
    }
    else if (len < (1 << 8))
    {
-      if (write(fd, &MPF_STR8, sizeof(MPF_STR8)) == -1)
+      if (rmsgpack_out(writer, &MPF_STR8, sizeof(MPF_STR8)) == -1)
          return -errno;
-      if (write(fd, &len, sizeof(uint8_t)) == -1)
+      if (rmsgpack_out(writer, &len, sizeof(uint8_t)) == -1)
          return -errno;
       written += sizeof(uint8_t);
    }
    else if (len < (1 << 16))
    {
-      if (write(fd, &MPF_STR16, sizeof(MPF_STR16)) == -1)
+      if (rmsgpack_out(writer, &MPF_STR16, sizeof(MPF_STR16)) == -1)
          return -errno;
       tmp_i16 = httobe16(len);
-      if (write(fd, &tmp_i16, sizeof(uint16_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i16, sizeof(uint16_t)) == -1)
          return -errno;
       written += sizeof(uint16_t);
    }
    else
    {
-      if (write(fd, &MPF_STR32, sizeof(MPF_STR32)) == -1)
+      if (rmsgpack_out(writer, &MPF_STR32, sizeof(MPF_STR32)) == -1)
          return -errno;
       tmp_i32 = httobe32(len);
-      if (write(fd, &tmp_i32, sizeof(uint32_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i32, sizeof(uint32_t)) == -1)
          return -errno;
       written += sizeof(uint32_t);
    }
 
-   if (write(fd, s, len) == -1)
+   if (rmsgpack_out(writer, s, len) == -1)
       return -errno;
    written += len;
    return written;
 }
 
-int rmsgpack_write_bin(int fd, const void *s, uint32_t len)
+int rmsgpack_write_bin(struct rmsgpack_writer *writer, const void *s, uint32_t len)
 {
    uint16_t tmp_i16;
    uint32_t tmp_i32;
@@ -169,58 +266,58 @@ int rmsgpack_write_bin(int fd, const void *s, uint32_t len)
 
    if (len == (uint8_t)len)
    {
-      if (write(fd, &MPF_BIN8, sizeof(MPF_BIN8)) == -1)
+      if (rmsgpack_out(writer, &MPF_BIN8, sizeof(MPF_BIN8)) == -1)
          return -errno;
-      if (write(fd, &len, sizeof(uint8_t)) == -1)
+      if (rmsgpack_out(writer, &len, sizeof(uint8_t)) == -1)
          return -errno;
       written += sizeof(uint8_t);
    }
    else if (len == (uint16_t)len)
    {
-      if (write(fd, &MPF_BIN16, sizeof(MPF_BIN16)) == -1)
+      if (rmsgpack_out(writer, &MPF_BIN16, sizeof(MPF_BIN16)) == -1)
          return -errno;
       tmp_i16 = httobe16(len);
-      if (write(fd, &tmp_i16, sizeof(uint16_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i16, sizeof(uint16_t)) == -1)
          return -errno;
       written += sizeof(uint16_t);
    }
    else
    {
-      if (write(fd, &MPF_BIN32, sizeof(MPF_BIN32)) == -1)
+      if (rmsgpack_out(writer, &MPF_BIN32, sizeof(MPF_BIN32)) == -1)
          return -errno;
       tmp_i32 = httobe32(len);
-      if (write(fd, &tmp_i32, sizeof(uint32_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i32, sizeof(uint32_t)) == -1)
          return -errno;
       written += sizeof(uint32_t);
    }
-   if (write(fd, s, len) == -1)
+   if (rmsgpack_out(writer, s, len) == -1)
       return -errno;
    written += len;
    return 0;
 }
 
-int rmsgpack_write_nil(int fd)
+int rmsgpack_write_nil(struct rmsgpack_writer *writer)
 {
-   if (write(fd, &MPF_NIL, sizeof(MPF_NIL)) == -1)
+   if (rmsgpack_out(writer, &MPF_NIL, sizeof(MPF_NIL)) == -1)
       return -errno;
    return sizeof(uint8_t);
 }
 
-int rmsgpack_write_bool(int fd, int value)
+int rmsgpack_write_bool(struct rmsgpack_writer *writer, int value)
 {
    if (value)
    {
-      if (write(fd, &MPF_TRUE, sizeof(MPF_TRUE)) == -1)
+      if (rmsgpack_out(writer, &MPF_TRUE, sizeof(MPF_TRUE)) == -1)
          return -errno;
    }
 
-   if (write(fd, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
+   if (rmsgpack_out(writer, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
       return -errno;
 
    return sizeof(uint8_t);
 }
 
-int rmsgpack_write_int(int fd, int64_t value)
+int rmsgpack_write_int(struct rmsgpack_writer *writer, int64_t value)
 {
    int16_t tmp_i16;
    int32_t tmp_i32;
@@ -229,58 +326,58 @@ int rmsgpack_write_int(int fd, int64_t value)
 
    if (value >=0 && value < 128)
    {
-      if (write(fd, &value, sizeof(int8_t)) == -1)
+      if (rmsgpack_out(writer, &value, sizeof(int8_t)) == -1)
          return -errno;
    }
    else if (value < 0 && value > -32)
    {
       tmpval = (value) | 0xe0;
-      if (write(fd, &tmpval, sizeof(uint8_t)) == -1)
+      if (rmsgpack_out(writer, &tmpval, sizeof(uint8_t)) == -1)
          return -errno;
    }
    else if (value == (int8_t)value)
    {
-      if (write(fd, &MPF_INT8, sizeof(MPF_INT8)) == -1)
+      if (rmsgpack_out(writer, &MPF_INT8, sizeof(MPF_INT8)) == -1)
          return -errno;
 
-      if (write(fd, &value, sizeof(int8_t)) == -1)
+      if (rmsgpack_out(writer, &value, sizeof(int8_t)) == -1)
          return -errno;
       written += sizeof(int8_t);
    }
    else if (value == (int16_t)value)
    {
-      if (write(fd, &MPF_INT16, sizeof(MPF_INT16)) == -1)
+      if (rmsgpack_out(writer, &MPF_INT16, sizeof(MPF_INT16)) == -1)
          return -errno;
 
       tmp_i16 = httobe16(value);
-      if (write(fd, &tmp_i16, sizeof(int16_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i16, sizeof(int16_t)) == -1)
          return -errno;
       written += sizeof(int16_t);
    }
    else if (value == (int32_t)value)
    {
-      if (write(fd, &MPF_INT32, sizeof(MPF_INT32)) == -1)
+      if (rmsgpack_out(writer, &MPF_INT32, sizeof(MPF_INT32)) == -1)
          return -errno;
 
       tmp_i32 = httobe32(value);
-      if (write(fd, &tmp_i32, sizeof(int32_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i32, sizeof(int32_t)) == -1)
          return -errno;
       written += sizeof(int32_t);
    }
    else
    {
-      if (write(fd, &MPF_INT64, sizeof(MPF_INT64)) == -1)
+      if (rmsgpack_out(writer, &MPF_INT64, sizeof(MPF_INT64)) == -1)
          return -errno;
 
       value = httobe64(value);
-      if (write(fd, &value, sizeof(int64_t)) == -1)
+      if (rmsgpack_out(writer, &value, sizeof(int64_t)) == -1)
          return -errno;
       written += sizeof(int64_t);
    }
    return written;
 }
 
-int rmsgpack_write_uint(int fd, uint64_t value)
+int rmsgpack_write_uint(struct rmsgpack_writer *writer, uint64_t value)
 {
    uint16_t tmp_i16;
    uint32_t tmp_i32;
@@ -288,40 +385,40 @@ int rmsgpack_write_uint(int fd, uint64_t value)
 
    if (value == (uint8_t)value)
    {
-      if (write(fd, &MPF_UINT8, sizeof(MPF_UINT8)) == -1)
+      if (rmsgpack_out(writer, &MPF_UINT8, sizeof(MPF_UINT8)) == -1)
          return -errno;
 
-      if (write(fd, &value, sizeof(uint8_t)) == -1)
+      if (rmsgpack_out(writer, &value, sizeof(uint8_t)) == -1)
          return -errno;
       written += sizeof(uint8_t);
    }
    else if (value == (uint16_t)value)
    {
-      if (write(fd, &MPF_UINT16, sizeof(MPF_UINT16)) == -1)
+      if (rmsgpack_out(writer, &MPF_UINT16, sizeof(MPF_UINT16)) == -1)
          return -errno;
 
       tmp_i16 = httobe16(value);
-      if (write(fd, &tmp_i16, sizeof(uint16_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i16, sizeof(uint16_t)) == -1)
          return -errno;
       written += sizeof(uint16_t);
    }
    else if (value == (uint32_t)value)
    {
-      if (write(fd, &MPF_UINT32, sizeof(MPF_UINT32)) == -1)
+      if (rmsgpack_out(writer, &MPF_UINT32, sizeof(MPF_UINT32)) == -1)
          return -errno;
 
       tmp_i32 = httobe32(value);
-      if (write(fd, &tmp_i32, sizeof(uint32_t)) == -1)
+      if (rmsgpack_out(writer, &tmp_i32, sizeof(uint32_t)) == -1)
          return -errno;
       written += sizeof(uint32_t);
    }
    else
    {
-      if (write(fd, &MPF_UINT64, sizeof(MPF_UINT64)) == -1)
+      if (rmsgpack_out(writer, &MPF_UINT64, sizeof(MPF_UINT64)) == -1)
          return -errno;
 
       value = httobe64(value);
-      if (write(fd, &value, sizeof(uint64_t)) == -1)
+      if (rmsgpack_out(writer, &value, sizeof(uint64_t)) == -1)
          return -errno;
       written += sizeof(uint64_t);
    }
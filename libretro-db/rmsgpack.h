@@ -2,6 +2,9 @@
 #define __RARCHDB_MSGPACK_H__
 
 #include <stdint.h>
+#include <stddef.h>
+
+#define RMSGPACK_DEFAULT_BLOCK_SIZE (64 * 1024)
 
 struct rmsgpack_read_callbacks {
 	int (* read_nil)(void *);
@@ -38,35 +41,68 @@ struct rmsgpack_read_callbacks {
 };
 
 
-int rmsgpack_write_array_header(
+/* Destination of the rmsgpack_write_* functions. Each writer is
+ * owned by its caller. Writes go straight to @fd unless the writer
+ * was set up with rmsgpack_writer_init_buffered(), which collects
+ * them in blocks of @block_size bytes (0 selects
+ * RMSGPACK_DEFAULT_BLOCK_SIZE). Flush before seeking or writing to
+ * @fd directly, and release a buffered writer with
+ * rmsgpack_writer_free(), which flushes it first. */
+struct rmsgpack_writer
+{
+	int fd;
+	uint8_t *buff;
+	size_t size;
+	size_t len;
+};
+
+void rmsgpack_writer_init(
+        struct rmsgpack_writer *writer,
+        int fd
+);
+int rmsgpack_writer_init_buffered(
+        struct rmsgpack_writer *writer,
         int fd,
+        size_t block_size
+);
+int rmsgpack_writer_flush(struct rmsgpack_writer *writer);
+int rmsgpack_writer_free(struct rmsgpack_writer *writer);
+
+int rmsgpack_write_raw(
+        struct rmsgpack_writer *writer,
+        const void * data,
+        uint32_t len
+);
+
+int rmsgpack_write_array_header(
+        struct rmsgpack_writer *writer,
         uint32_t size
 );
 int rmsgpack_write_map_header(
-        int fd,
+        struct rmsgpack_writer *writer,
         uint32_t size
 );
 int rmsgpack_write_string(
-        int fd,
+        struct rmsgpack_writer *writer,
         const char * s,
         uint32_t len
 );
 int rmsgpack_write_bin(
-        int fd,
+        struct rmsgpack_writer *writer,
         const void * s,
         uint32_t len
 );
-int rmsgpack_write_nil(int fd);
+int rmsgpack_write_nil(struct rmsgpack_writer *writer);
 int rmsgpack_write_bool(
-        int fd,
+        struct rmsgpack_writer *writer,
         int value
 );
 int rmsgpack_write_int(
-        int fd,
+        struct rmsgpack_writer *writer,
         int64_t value
 );
 int rmsgpack_write_uint(
-        int fd,
+        struct rmsgpack_writer *writer,
         uint64_t value
 );
 
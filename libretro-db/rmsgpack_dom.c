@@ -340,7 +340,7 @@ void rmsgpack_dom_value_print(struct rmsgpack_dom_value *obj)
          printf("]");
    }
 }
-int rmsgpack_dom_write(int fd, const struct rmsgpack_dom_value *obj)
+int rmsgpack_dom_write(struct rmsgpack_writer *writer, const struct rmsgpack_dom_value *obj)
 {
    unsigned i;
    int rv = 0;
@@ -349,40 +349,40 @@ int rmsgpack_dom_write(int fd, const struct rmsgpack_dom_value *obj)
    switch (obj->type)
    {
       case RDT_NULL:
-         return rmsgpack_write_nil(fd);
+         return rmsgpack_write_nil(writer);
       case RDT_BOOL:
-         return rmsgpack_write_bool(fd, obj->bool_);
+         return rmsgpack_write_bool(writer, obj->bool_);
       case RDT_INT:
-         return rmsgpack_write_int(fd, obj->int_);
+         return rmsgpack_write_int(writer, obj->int_);
       case RDT_UINT:
-         return rmsgpack_write_uint(fd, obj->uint_);
+         return rmsgpack_write_uint(writer, obj->uint_);
       case RDT_STRING:
-         return rmsgpack_write_string(fd, obj->string.buff, obj->string.len);
+         return rmsgpack_write_string(writer, obj->string.buff, obj->string.len);
       case RDT_BINARY:
-         return rmsgpack_write_bin(fd, obj->binary.buff, obj->binary.len);
+         return rmsgpack_write_bin(writer, obj->binary.buff, obj->binary.len);
       case RDT_MAP:
-         if ((rv = rmsgpack_write_map_header(fd, obj->map.len)) < 0)
+         if ((rv = rmsgpack_write_map_header(writer, obj->map.len)) < 0)
             return rv;
          written += rv;
 
          for (i = 0; i < obj->map.len; i++)
          {
-            if ((rv = rmsgpack_dom_write(fd, &obj->map.items[i].key)) < 0)
+            if ((rv = rmsgpack_dom_write(writer, &obj->map.items[i].key)) < 0)
                return rv;
             written += rv;
-            if ((rv = rmsgpack_dom_write(fd, &obj->map.items[i].value)) < 0)
+            if ((rv = rmsgpack_dom_write(writer, &obj->map.items[i].value)) < 0)
                return rv;
             written += rv;
          }
          break;
       case RDT_ARRAY:
-         if ((rv = rmsgpack_write_array_header(fd, obj->array.len)) < 0)
+         if ((rv = rmsgpack_write_array_header(writer, obj->array.len)) < 0)
             return rv;
          written += rv;
 
          for (i = 0; i < obj->array.len; i++)
          {
-            if ((rv = rmsgpack_dom_write(fd, &obj->array.items[i])) < 0)
+            if ((rv = rmsgpack_dom_write(writer, &obj->array.items[i])) < 0)
                return rv;
             written += rv;
          }
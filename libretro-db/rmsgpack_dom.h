@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "rmsgpack.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,7 +67,7 @@ int rmsgpack_dom_read(
         struct rmsgpack_dom_value * out
 );
 int rmsgpack_dom_write(
-        int fd,
+        struct rmsgpack_writer *writer,
         const struct rmsgpack_dom_value * obj
 );
 
@@ -171,22 +171,24 @@ int main(void)
       printf("Could not open file: %s", strerror(errno));
       return errno;
       }
-      rmsgpack_write_map_header(fd, 2);
-      rmsgpack_write_string(fd, "compact", strlen("compact"));
-      rmsgpack_write_bool(fd, 1);
-      rmsgpack_write_string(fd, "schema", strlen("schema"));
-      rmsgpack_write_array_header(fd, 10);
-      rmsgpack_write_string(fd, "schema", strlen("schema"));
-      rmsgpack_write_uint(fd, 1<<17);
-      rmsgpack_write_int(fd, (1<<17) + 1);
-      rmsgpack_write_int(fd, 4);
-      rmsgpack_write_int(fd, -3);
-      rmsgpack_write_int(fd, -22);
-      rmsgpack_write_int(fd, -35);
-      rmsgpack_write_int(fd, -421421412);
-      rmsgpack_write_int(fd, 4214);
-      rmsgpack_write_int(fd, -4214);
-      rmsgpack_write_uint(fd, 1<<17);
+      struct rmsgpack_writer writer;
+      rmsgpack_writer_init(&writer, fd);
+      rmsgpack_write_map_header(&writer, 2);
+      rmsgpack_write_string(&writer, "compact", strlen("compact"));
+      rmsgpack_write_bool(&writer, 1);
+      rmsgpack_write_string(&writer, "schema", strlen("schema"));
+      rmsgpack_write_array_header(&writer, 10);
+      rmsgpack_write_string(&writer, "schema", strlen("schema"));
+      rmsgpack_write_uint(&writer, 1<<17);
+      rmsgpack_write_int(&writer, (1<<17) + 1);
+      rmsgpack_write_int(&writer, 4);
+      rmsgpack_write_int(&writer, -3);
+      rmsgpack_write_int(&writer, -22);
+      rmsgpack_write_int(&writer, -35);
+      rmsgpack_write_int(&writer, -421421412);
+      rmsgpack_write_int(&writer, 4214);
+      rmsgpack_write_int(&writer, -4214);
+      rmsgpack_write_uint(&writer, 1<<17);
       close(fd);
       */
 
@@ -122,10 +122,17 @@ static void video_frame(const void *data, unsigned width,
    driver_t  *driver    = driver_get_ptr();
    global_t  *global    = global_get_ptr();
    settings_t *settings = config_get_ptr();
+   runloop_t *runloop   = rarch_main_get_ptr();
 
    if (!driver->video_active)
       return;
 
+   if (runloop->frames.fastforward.skip)
+      return;
+
+   if (settings->video.frame_delay_auto)
+      runloop->frames.delay.present = rarch_get_time_usec();
+
    global->frame_cache.data   = data;
    global->frame_cache.width  = width;
    global->frame_cache.height = height;
@@ -196,7 +203,8 @@ bool retro_flush_audio(const int16_t *data, size_t samples)
          driver->recording->push_audio(driver->recording_data, &ffemu_data);
    }
 
-   if (runloop->is_paused || settings->audio.mute_enable)
+   if (runloop->is_paused || settings->audio.mute_enable
+         || runloop->frames.fastforward.skip)
       return true;
    if (!driver->audio_active || !global->audio_data.data)
       return false;
@@ -349,6 +357,55 @@ static size_t audio_sample_batch_rewind(const int16_t *data, size_t frames)
    return frames;
 }
 
+/**
+ * video_frame_runahead:
+ * @data                 : pointer to data of the video frame.
+ * @width                : width of the video frame.
+ * @height               : height of the video frame.
+ * @pitch                : pitch of the video frame.
+ *
+ * Video frame render callback function (run-ahead version).
+ * Drops the frame, used for the frames run-ahead keeps hidden.
+ **/
+static void video_frame_runahead(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   (void)data;
+   (void)width;
+   (void)height;
+   (void)pitch;
+}
+
+/**
+ * audio_sample_runahead:
+ * @left                 : value of the left audio channel.
+ * @right                : value of the right audio channel.
+ *
+ * Audio sample render callback function (run-ahead version).
+ * Drops the sample, used for frames run-ahead will roll back.
+ **/
+static void audio_sample_runahead(int16_t left, int16_t right)
+{
+   (void)left;
+   (void)right;
+}
+
+/**
+ * audio_sample_batch_runahead:
+ * @data                 : pointer to audio buffer.
+ * @frames               : amount of audio frames to push.
+ *
+ * Batched audio sample render callback function (run-ahead version).
+ * Drops the samples, used for frames run-ahead will roll back.
+ *
+ * Returns: amount of frames sampled, always equal to @frames.
+ **/
+static size_t audio_sample_batch_runahead(const int16_t *data, size_t frames)
+{
+   (void)data;
+   return frames;
+}
+
 /**
  * input_apply_turbo:
  * @port                 : user number
@@ -740,3 +797,25 @@ void retro_set_rewind_callbacks(void)
       pretro_set_audio_sample_batch(audio_sample_batch);
    }
 }
+
+/**
+ * retro_set_runahead_callbacks:
+ * @video          : pass video frames on to the video driver.
+ * @audio          : pass audio samples on to the audio driver.
+ *
+ * Sets the video and audio callbacks for a frame run by
+ * run-ahead. Disabled output is dropped. With both enabled,
+ * the regular callbacks are restored.
+ **/
+void retro_set_runahead_callbacks(bool video, bool audio)
+{
+   pretro_set_video_refresh(video ? video_frame : video_frame_runahead);
+
+   if (audio)
+      retro_set_rewind_callbacks();
+   else
+   {
+      pretro_set_audio_sample(audio_sample_runahead);
+      pretro_set_audio_sample_batch(audio_sample_batch_runahead);
+   }
+}
@@ -58,6 +58,17 @@ void retro_set_default_callbacks(void *data);
  **/
 void retro_set_rewind_callbacks(void);
 
+/**
+ * retro_set_runahead_callbacks:
+ * @video          : pass video frames on to the video driver.
+ * @audio          : pass audio samples on to the audio driver.
+ *
+ * Sets the video and audio callbacks for a frame run by
+ * run-ahead. Disabled output is dropped. With both enabled,
+ * the regular callbacks are restored.
+ **/
+void retro_set_runahead_callbacks(bool video, bool audio);
+
 /**
  * retro_flush_audio:
  * @data                 : pointer to audio buffer.
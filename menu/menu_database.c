@@ -20,22 +20,41 @@
 #include "../playlist.h"
 #include <string.h>
 
+#ifdef HAVE_LIBRETRODB
+typedef struct
+{
+   file_list_t *list;
+   const char *path;
+} menu_database_query_t;
+
+static int menu_database_push_query_entry(void *userdata,
+      const database_info_view_t *view)
+{
+   menu_database_query_t *query = (menu_database_query_t*)userdata;
+   const char *name = database_info_view_get_string(view, "name", NULL);
+
+   if (name)
+      menu_list_push(query->list, name, query->path,
+            MENU_FILE_RDB_ENTRY, 0);
+
+   return 0;
+}
+#endif
+
 int menu_database_populate_query(file_list_t *list, const char *path,
     const char *query)
 {
 #ifdef HAVE_LIBRETRODB
-   libretrodb_t db;
-   libretrodb_cursor_t cur;
+   menu_database_query_t entries;
 
-   if ((libretrodb_open(path, &db)) != 0)
-      return -1;
-   if ((database_open_cursor(&db, &cur, query) != 0))
-      return -1;
-   if ((menu_entries_push_query(&db, &cur, list)) != 0)
-      return -1;
+   entries.list = list;
+   entries.path = path;
 
-   libretrodb_cursor_close(&cur);
-   libretrodb_close(&db);
+   /* Only the names are listed, so read them straight out of
+    * the records instead of decoding whole entries. */
+   if (database_info_iterate(path, query,
+            menu_database_push_query_entry, &entries) != 0)
+      return -1;
 #endif
 
    return 0;
@@ -140,7 +140,7 @@ static int deferred_push_core_information(void *data, void *userdata,
    info = (core_info_t*)global->core_info_current;
    menu_list_clear(list);
 
-   if (info && info->data)
+   if (info && info->has_info)
    {
       char tmp[PATH_MAX_LENGTH];
 
@@ -305,7 +305,9 @@ static int deferred_push_rdb_entry_detail(void *data, void *userdata,
 
    menu_list_clear(list);
 
-   if (!(db_info = database_info_list_new(path, query)))
+   /* Every field is listed below, so decode them all. */
+   if (!(db_info = database_info_list_new(path, query,
+               DATABASE_INFO_FIELD_ALL)))
    {
       ret = -1;
       goto done;
@@ -489,12 +491,15 @@ static int deferred_push_rdb_entry_detail(void *data, void *userdata,
 
       if (playlist)
       {
-         for (j = 0; j < playlist->size; j++)
+         for (j = 0; j < content_playlist_size(playlist); j++)
          {
             char elem0[PATH_MAX_LENGTH], elem1[PATH_MAX_LENGTH];
             bool match_found = false;
-            struct string_list *tmp_str_list = string_split(
-                  playlist->entries[j].core_name, "|"); 
+            const char *core_name = NULL;
+            struct string_list *tmp_str_list = NULL;
+
+            content_playlist_get_index(playlist, j, NULL, NULL, &core_name);
+            tmp_str_list = string_split(core_name, "|");
 
             if (!tmp_str_list)
                continue;
@@ -790,7 +795,7 @@ static int deferred_push_core_information(void *data, void *userdata,
    info = (core_info_t*)global->core_info_current;
    menu_list_clear(list);
 
-   if (info->data)
+   if (info->has_info)
    {
       char tmp[PATH_MAX_LENGTH];
 
@@ -1304,6 +1309,10 @@ static void push_perfcounter(menu_handle_t *menu,
    if (!counters || num == 0)
       return;
 
+   /* The menu has room for MAX_COUNTERS entries per list. */
+   if (num > MAX_COUNTERS)
+      num = MAX_COUNTERS;
+
    for (i = 0; i < num; i++)
       if (counters[i] && counters[i]->ident)
          menu_list_push(list, counters[i]->ident, "",
@@ -390,6 +390,10 @@ static void menu_action_setting_disp_set_label_perf_counters(
 {
    const struct retro_perf_counter **counters = 
       (const struct retro_perf_counter **)perf_counters_rarch;
+   unsigned num = perf_ptr_rarch;
+   retro_perf_tick_t total;
+   uint64_t call_cnt;
+   struct rarch_perf_percentiles pct;
    unsigned offset = type - MENU_SETTINGS_PERF_COUNTERS_BEGIN;
    runloop_t *runloop = rarch_main_get_ptr();
 
@@ -397,20 +401,32 @@ static void menu_action_setting_disp_set_label_perf_counters(
    *w = 19;
    strlcpy(path_buf, path, path_buf_size);
 
-   if (!counters[offset])
+   if (offset >= num || !counters[offset])
       return;
-   if (!counters[offset]->call_cnt)
+
+   rarch_perf_get_totals(counters[offset], &total, &call_cnt);
+   if (!call_cnt)
       return;
 
-   snprintf(type_str, type_str_size,
+   if (rarch_perf_get_percentiles(counters[offset], &pct))
+      snprintf(type_str, type_str_size,
+#ifdef _WIN32
+            "%I64u ticks (p99 %I64u), %I64u runs.",
+#else
+            "%llu ticks (p99 %llu), %llu runs.",
+#endif
+            ((unsigned long long)total / (unsigned long long)call_cnt),
+            (unsigned long long)pct.p99,
+            (unsigned long long)call_cnt);
+   else
+      snprintf(type_str, type_str_size,
 #ifdef _WIN32
-         "%I64u ticks, %I64u runs.",
+            "%I64u ticks, %I64u runs.",
 #else
-         "%llu ticks, %llu runs.",
+            "%llu ticks, %llu runs.",
 #endif
-         ((unsigned long long)counters[offset]->total /
-          (unsigned long long)counters[offset]->call_cnt),
-         (unsigned long long)counters[offset]->call_cnt);
+            ((unsigned long long)total / (unsigned long long)call_cnt),
+            (unsigned long long)call_cnt);
 
    runloop->frames.video.current.menu.label.is_updated = true;
 }
@@ -426,6 +442,10 @@ static void menu_action_setting_disp_set_label_libretro_perf_counters(
 {
    const struct retro_perf_counter **counters = 
       (const struct retro_perf_counter **)perf_counters_libretro;
+   unsigned num = perf_ptr_libretro;
+   retro_perf_tick_t total;
+   uint64_t call_cnt;
+   struct rarch_perf_percentiles pct;
    unsigned offset = type - MENU_SETTINGS_LIBRETRO_PERF_COUNTERS_BEGIN;
    runloop_t *runloop = rarch_main_get_ptr();
 
@@ -433,20 +453,32 @@ static void menu_action_setting_disp_set_label_libretro_perf_counters(
    *w = 19;
    strlcpy(path_buf, path, path_buf_size);
 
-   if (!counters[offset])
+   if (offset >= num || !counters[offset])
       return;
-   if (!counters[offset]->call_cnt)
+
+   rarch_perf_get_totals(counters[offset], &total, &call_cnt);
+   if (!call_cnt)
       return;
 
-   snprintf(type_str, type_str_size,
+   if (rarch_perf_get_percentiles(counters[offset], &pct))
+      snprintf(type_str, type_str_size,
+#ifdef _WIN32
+            "%I64u ticks (p99 %I64u), %I64u runs.",
+#else
+            "%llu ticks (p99 %llu), %llu runs.",
+#endif
+            ((unsigned long long)total / (unsigned long long)call_cnt),
+            (unsigned long long)pct.p99,
+            (unsigned long long)call_cnt);
+   else
+      snprintf(type_str, type_str_size,
 #ifdef _WIN32
-         "%I64u ticks, %I64u runs.",
+            "%I64u ticks, %I64u runs.",
 #else
-         "%llu ticks, %llu runs.",
+            "%llu ticks, %llu runs.",
 #endif
-         ((unsigned long long)counters[offset]->total /
-          (unsigned long long)counters[offset]->call_cnt),
-         (unsigned long long)counters[offset]->call_cnt);
+            ((unsigned long long)total / (unsigned long long)call_cnt),
+            (unsigned long long)call_cnt);
 
    runloop->frames.video.current.menu.label.is_updated = true;
 }
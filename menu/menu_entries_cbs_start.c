@@ -54,11 +54,8 @@ static int action_start_performance_counters_core(unsigned type, const char *lab
    (void)label;
    (void)action;
 
-   if (counters[offset])
-   {
-      counters[offset]->total = 0;
-      counters[offset]->call_cnt = 0;
-   }
+   if (offset < perf_ptr_libretro)
+      rarch_perf_reset(counters[offset]);
 
    return 0;
 }
@@ -247,11 +244,8 @@ static int action_start_performance_counters_frontend(unsigned type, const char
 
    (void)label;
 
-   if (counters[offset])
-   {
-      counters[offset]->total = 0;
-      counters[offset]->call_cnt = 0;
-   }
+   if (offset < perf_ptr_rarch)
+      rarch_perf_reset(counters[offset]);
 
    return 0;
 }
@@ -42,6 +42,7 @@
 #elif defined(_POSIX_MONOTONIC_CLOCK) || defined(ANDROID) || defined(__QNX__)
 // POSIX_MONOTONIC_CLOCK is not being defined in Android headers despite support being present.
 #include <time.h>
+#include <errno.h>
 #endif
 
 #if defined(__QNX__) && !defined(CLOCK_MONOTONIC)
@@ -91,76 +92,1624 @@ static int clock_gettime(int clk_ik, struct timespec *t)
 #include <emscripten.h>
 #endif
 
-#if defined(BSD) || defined(__APPLE__)
-#include <sys/sysctl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
 #endif
 
-#include <string.h>
+#if defined(__linux__) && !defined(RARCH_CONSOLE)
+#define PERF_HW_EVENTS
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(HAVE_THREADS) && !defined(RARCH_CONSOLE)
+#if defined(_MSC_VER)
+#define PERF_TLS __declspec(thread)
+#elif defined(__GNUC__)
+#define PERF_TLS __thread
+#endif
+#elif !defined(HAVE_THREADS)
+/* Only one thread records, a plain static will do. */
+#define PERF_TLS
+#endif
+
+#if defined(__GNUC__)
+#define PERF_MEMORY_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER) && !defined(_XBOX)
+#define PERF_MEMORY_BARRIER() MemoryBarrier()
+#else
+#define PERF_MEMORY_BARRIER()
+#endif
+
+/* Both registries only ever grow, see perf_registry_push(). */
+const struct retro_perf_counter **perf_counters_rarch;
+const struct retro_perf_counter **perf_counters_libretro;
+unsigned perf_ptr_rarch;
+unsigned perf_ptr_libretro;
+
+/* Log-bucketed histogram: values below 2 * PERF_HIST_SUB are
+ * exact, above that every power of two is split into
+ * PERF_HIST_SUB buckets, i.e. at most 12.5% relative error. */
+#define PERF_HIST_SUB_BITS 3
+#define PERF_HIST_SUB      (1 << PERF_HIST_SUB_BITS)
+#define PERF_HIST_BUCKETS  (64 * PERF_HIST_SUB)
+
+struct perf_histogram
+{
+   uint32_t buckets[PERF_HIST_BUCKETS];
+   uint64_t count;
+   uint64_t max;
+};
+
+static struct perf_histogram perf_frame_time;
+static struct perf_histogram perf_frame_limit_error;
+
+static INLINE unsigned perf_hist_msb(uint64_t v)
+{
+#if defined(__GNUC__)
+   return 63 - __builtin_clzll(v);
+#else
+   unsigned msb = 0;
+   while (v >>= 1)
+      msb++;
+   return msb;
+#endif
+}
+
+static INLINE unsigned perf_hist_bucket(uint64_t v)
+{
+   unsigned msb;
+
+   if (v < PERF_HIST_SUB)
+      return (unsigned)v;
+
+   msb = perf_hist_msb(v);
+   return (msb - PERF_HIST_SUB_BITS + 1) * PERF_HIST_SUB
+      + (unsigned)((v >> (msb - PERF_HIST_SUB_BITS)) & (PERF_HIST_SUB - 1));
+}
+
+/**
+ * perf_hist_value:
+ * @bucket             : bucket index.
+ *
+ * Returns: the middle of the range of values counted in @bucket.
+ **/
+static uint64_t perf_hist_value(unsigned bucket)
+{
+   unsigned msb, shift;
+
+   if (bucket < PERF_HIST_SUB)
+      return bucket;
+
+   msb   = bucket / PERF_HIST_SUB - 1 + PERF_HIST_SUB_BITS;
+   shift = msb - PERF_HIST_SUB_BITS;
+
+   return ((uint64_t)(PERF_HIST_SUB + bucket % PERF_HIST_SUB) << shift)
+      + (((uint64_t)1 << shift) >> 1);
+}
+
+static INLINE void perf_hist_add(struct perf_histogram *hist, uint64_t v)
+{
+   hist->buckets[perf_hist_bucket(v)]++;
+   hist->count++;
+   if (v > hist->max)
+      hist->max = v;
+}
+
+static uint64_t perf_hist_percentile(const struct perf_histogram *hist,
+      unsigned percent)
+{
+   unsigned i;
+   uint64_t seen   = 0;
+   uint64_t target = (hist->count * percent + 99) / 100;
+
+   if (!hist->count)
+      return 0;
+
+   for (i = 0; i < PERF_HIST_BUCKETS; i++)
+   {
+      seen += hist->buckets[i];
+      if (seen >= target)
+      {
+         uint64_t v = perf_hist_value(i);
+         return v < hist->max ? v : hist->max;
+      }
+   }
+
+   return hist->max;
+}
+
+static void perf_hist_percentiles(const struct perf_histogram *hist,
+      struct rarch_perf_percentiles *out)
+{
+   out->p50   = perf_hist_percentile(hist, 50);
+   out->p95   = perf_hist_percentile(hist, 95);
+   out->p99   = perf_hist_percentile(hist, 99);
+   out->max   = hist->max;
+   out->count = hist->count;
+}
+
+#define PERF_THREAD_BUCKETS 64
+
+/* One thread's share of a counter. Only the owning thread
+ * writes it, readers sum up the shares of all threads. */
+struct perf_thread_counter
+{
+   const struct retro_perf_counter *counter;
+   retro_perf_tick_t start;
+   retro_perf_tick_t total;
+   uint64_t call_cnt;
+   struct perf_histogram hist;
+   uint64_t hw_start[RARCH_PERF_HW_LAST];
+   uint64_t hw_total[RARCH_PERF_HW_LAST];
+   bool hw_started;
+   struct perf_thread_counter *next;
+};
+
+/* Fixed size hash of counter address -> share. Nodes are
+ * only ever prepended, so other threads can walk the chains
+ * while the owner adds to them. */
+struct perf_thread
+{
+   struct perf_thread_counter *buckets[PERF_THREAD_BUCKETS];
+   /* perf_event group of this thread, -1 if none. */
+   int hw_fd;
+   /* Open fds of the group, leader first, hw_count of them. */
+   int hw_fds[RARCH_PERF_HW_LAST];
+   /* Position of each event in a group read, -1 if absent. */
+   int hw_index[RARCH_PERF_HW_LAST];
+   unsigned hw_count;
+   bool hw_tried;
+   struct perf_thread *next;
+};
+
+struct perf_retired
+{
+   const struct retro_perf_counter **counters;
+   struct perf_retired *next;
+};
+
+static struct
+{
+   struct perf_thread *threads;
+   struct perf_retired *retired;
+   unsigned cap_rarch;
+   unsigned cap_libretro;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+} perf_registry;
+
+#ifdef PERF_TLS
+static PERF_TLS struct perf_thread *perf_thread_self;
+/* Shares of threads that have exited, see rarch_perf_thread_exit(). */
+static struct perf_thread perf_thread_exited;
+static bool perf_thread_exited_linked;
+#else
+/* No TLS, all threads share one set of counters. */
+static struct perf_thread perf_thread_shared;
+#endif
+
+static void perf_registry_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (perf_registry.lock)
+      slock_lock(perf_registry.lock);
+#endif
+}
+
+static void perf_registry_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (perf_registry.lock)
+      slock_unlock(perf_registry.lock);
+#endif
+}
+
+/**
+ * rarch_perf_init:
+ *
+ * Sets up the counter registry. Must run before any
+ * thread other than the main one uses a counter.
+ **/
+void rarch_perf_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!perf_registry.lock)
+      perf_registry.lock = slock_new();
+#endif
+#ifndef PERF_TLS
+   perf_thread_shared.hw_fd = -1;
+   perf_registry.threads    = &perf_thread_shared;
+#endif
+}
+
+static struct perf_thread *perf_thread_get(void)
+{
+#ifdef PERF_TLS
+   struct perf_thread *thr = perf_thread_self;
+
+   if (thr)
+      return thr;
+
+   if (!(thr = (struct perf_thread*)calloc(1, sizeof(*thr))))
+      return NULL;
+
+   thr->hw_fd = -1;
+
+   perf_registry_lock();
+   thr->next             = perf_registry.threads;
+   perf_registry.threads = thr;
+   perf_registry_unlock();
+
+   perf_thread_self = thr;
+   return thr;
+#else
+   return &perf_thread_shared;
+#endif
+}
+
+static INLINE unsigned perf_thread_bucket(const struct retro_perf_counter *perf)
+{
+   uintptr_t h = (uintptr_t)perf;
+   h ^= h >> 16;
+   h *= 0x45d9f3bu;
+   h ^= h >> 16;
+   return (unsigned)(h & (PERF_THREAD_BUCKETS - 1));
+}
+
+static struct perf_thread_counter *perf_thread_counter_find(
+      const struct perf_thread *thr, const struct retro_perf_counter *perf)
+{
+   struct perf_thread_counter *node = thr->buckets[perf_thread_bucket(perf)];
+
+   while (node && node->counter != perf)
+      node = node->next;
+
+   return node;
+}
+
+/**
+ * perf_thread_counter_get:
+ * @thr                : calling thread.
+ * @perf               : registered performance counter.
+ *
+ * Returns: the calling thread's share of @perf, created on
+ * first use. NULL on OOM.
+ **/
+static struct perf_thread_counter *perf_thread_counter_get(
+      struct perf_thread *thr, const struct retro_perf_counter *perf)
+{
+   unsigned bucket;
+   struct perf_thread_counter *node = NULL;
+
+   if ((node = perf_thread_counter_find(thr, perf)))
+      return node;
+
+   if (!(node = (struct perf_thread_counter*)calloc(1, sizeof(*node))))
+      return NULL;
+
+   bucket        = perf_thread_bucket(perf);
+   node->counter = perf;
+   node->next    = thr->buckets[bucket];
+
+   /* Readers on other threads must never see a half-built node. */
+   PERF_MEMORY_BARRIER();
+   thr->buckets[bucket] = node;
+   return node;
+}
+
+#ifdef PERF_HW_EVENTS
+/* Set once the PMU turned out to be unusable. */
+static bool perf_hw_unavailable;
+
+static int perf_hw_open(uint32_t type, uint64_t config, int group_fd)
+{
+   struct perf_event_attr attr;
+
+   memset(&attr, 0, sizeof(attr));
+   attr.size           = sizeof(attr);
+   attr.type           = type;
+   attr.config         = config;
+   attr.disabled       = group_fd == -1;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv     = 1;
+   attr.read_format    = PERF_FORMAT_GROUP;
+
+   /* Calling thread, any CPU. */
+   return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/**
+ * perf_hw_init_thread:
+ * @thr                : calling thread.
+ *
+ * Opens one perf_event group for the calling thread, led by
+ * the cycle counter. Events the PMU lacks are left out of
+ * the group; if there is no cycle counter at all, hardware
+ * counters are turned off for good.
+ **/
+static void perf_hw_init_thread(struct perf_thread *thr)
+{
+   unsigned i;
+   static const uint64_t configs[RARCH_PERF_HW_LAST] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES,
+   };
+
+   thr->hw_tried = true;
+
+   for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+      thr->hw_index[i] = -1;
+
+   thr->hw_fd = perf_hw_open(PERF_TYPE_HARDWARE, configs[0], -1);
+   if (thr->hw_fd < 0)
+   {
+      RARCH_WARN("[PERF]: Hardware counters unavailable (%s), "
+            "falling back to time only.\n", strerror(errno));
+      perf_hw_unavailable = true;
+      return;
+   }
+
+   thr->hw_index[0] = 0;
+   thr->hw_fds[0]   = thr->hw_fd;
+   thr->hw_count    = 1;
+
+   for (i = 1; i < RARCH_PERF_HW_LAST; i++)
+   {
+      int fd = perf_hw_open(PERF_TYPE_HARDWARE, configs[i], thr->hw_fd);
+
+      if (fd < 0)
+         continue;
+
+      thr->hw_index[i]             = thr->hw_count;
+      thr->hw_fds[thr->hw_count++] = fd;
+   }
+
+   ioctl(thr->hw_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+   ioctl(thr->hw_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/**
+ * perf_hw_read:
+ * @thr                : calling thread.
+ * @values             : event values, absent events read as 0.
+ *
+ * Returns: true if @values was filled in, otherwise false.
+ **/
+static bool perf_hw_read(struct perf_thread *thr, uint64_t *values)
+{
+   unsigned i;
+   uint64_t buf[1 + RARCH_PERF_HW_LAST];
+
+   if (!thr->hw_tried && !perf_hw_unavailable)
+      perf_hw_init_thread(thr);
+
+   if (thr->hw_fd < 0)
+      return false;
+
+   if (read(thr->hw_fd, buf, (1 + thr->hw_count) * sizeof(uint64_t)) <= 0)
+      return false;
+
+   for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+      values[i] = thr->hw_index[i] >= 0 ? buf[1 + thr->hw_index[i]] : 0;
+
+   return true;
+}
+
+/**
+ * perf_hw_close:
+ * @thr                : thread whose group to close.
+ *
+ * Closes the perf_event group of @thr. hw_index is kept, so
+ * the events counted so far are still reported, and the
+ * group is not opened again.
+ **/
+static void perf_hw_close(struct perf_thread *thr)
+{
+   while (thr->hw_count)
+      close(thr->hw_fds[--thr->hw_count]);
+
+   thr->hw_fd = -1;
+}
+#endif
+
+void rarch_perf_start(struct retro_perf_counter *perf)
+{
+   struct perf_thread_counter *node = NULL;
+   struct perf_thread *thr          = NULL;
+   global_t *global                 = global_get_ptr();
+
+   if (!perf)
+      return;
+
+   if (perf_trace_enable)
+      rarch_perf_trace_begin(perf->ident);
+
+   if (!global->perfcnt_enable)
+      return;
+
+   /* Cores read start, total and call_cnt straight from the
+    * struct, so these are still written. They race when threads
+    * share a counter; RetroArch reports the per-thread shares. */
+   perf->call_cnt++;
+
+   if (perf->registered && (thr = perf_thread_get())
+         && (node = perf_thread_counter_get(thr, perf)))
+   {
+      node->call_cnt++;
+
+#ifdef PERF_HW_EVENTS
+      node->hw_started = global->perfcnt_hw_enable && !perf_hw_unavailable
+         && perf_hw_read(thr, node->hw_start);
+#endif
+   }
+
+   /* Last, so the above isn't billed to the counter. */
+   perf->start = rarch_get_perf_counter();
+
+   if (node)
+      node->start = perf->start;
+}
+
+void rarch_perf_stop(struct retro_perf_counter *perf)
+{
+   retro_perf_tick_t now, ticks;
+   struct perf_thread_counter *node = NULL;
+   struct perf_thread *thr          = NULL;
+   global_t *global                 = global_get_ptr();
+
+   if (!perf)
+      return;
+
+   if (perf_trace_enable)
+      rarch_perf_trace_end(perf->ident);
+
+   if (!global->perfcnt_enable)
+      return;
+
+   now          = rarch_get_perf_counter();
+   perf->total += now - perf->start;
+
+   if (!perf->registered || !(thr = perf_thread_get()))
+      return;
+
+   if (!(node = perf_thread_counter_get(thr, perf)) || !node->start)
+      return;
+
+   ticks        = now - node->start;
+   node->total += ticks;
+   node->start  = 0;
+   perf_hist_add(&node->hist, ticks);
+
+#ifdef PERF_HW_EVENTS
+   if (node->hw_started)
+   {
+      unsigned i;
+      uint64_t hw_end[RARCH_PERF_HW_LAST];
+
+      if (perf_hw_read(thr, hw_end))
+         for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+            node->hw_total[i] += hw_end[i] - node->hw_start[i];
+      node->hw_started = false;
+   }
+#endif
+}
+
+/**
+ * rarch_perf_get_totals:
+ * @perf               : registered performance counter.
+ * @total              : sum of ticks over all threads.
+ * @call_cnt           : sum of runs over all threads.
+ *
+ * Aggregates the per-thread shares of @perf. A share that
+ * is being written to meanwhile may be read one run behind.
+ **/
+void rarch_perf_get_totals(const struct retro_perf_counter *perf,
+      retro_perf_tick_t *total, uint64_t *call_cnt)
+{
+   const struct perf_thread *thr = NULL;
+
+   *total    = 0;
+   *call_cnt = 0;
+
+   perf_registry_lock();
+   for (thr = perf_registry.threads; thr; thr = thr->next)
+   {
+      const struct perf_thread_counter *node =
+         perf_thread_counter_find(thr, perf);
+
+      if (!node)
+         continue;
+
+      *total    += node->total;
+      *call_cnt += node->call_cnt;
+   }
+   perf_registry_unlock();
+}
+
+/**
+ * rarch_perf_get_hw:
+ * @perf               : registered performance counter.
+ * @out                : filled in with hardware event totals.
+ *
+ * Aggregates the hardware events counted inside @perf over
+ * all threads.
+ *
+ * Returns: true if any cycles were counted, otherwise false.
+ **/
+bool rarch_perf_get_hw(const struct retro_perf_counter *perf,
+      struct rarch_perf_hw *out)
+{
+   unsigned i;
+   const struct perf_thread *thr = NULL;
+
+   memset(out, 0, sizeof(*out));
+
+   perf_registry_lock();
+   for (thr = perf_registry.threads; thr; thr = thr->next)
+   {
+      const struct perf_thread_counter *node =
+         perf_thread_counter_find(thr, perf);
+
+      if (!node)
+         continue;
+
+      for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+      {
+         out->value[i] += node->hw_total[i];
+         if (thr->hw_index[i] >= 0 && thr->hw_tried)
+            out->mask  |= 1 << i;
+      }
+   }
+   perf_registry_unlock();
+
+   return out->value[RARCH_PERF_HW_CYCLES] != 0;
+}
+
+/**
+ * rarch_perf_get_percentiles:
+ * @perf               : registered performance counter.
+ * @out                : filled in with the counter's distribution.
+ *
+ * Returns: true if @perf has been run at least once,
+ * otherwise false.
+ **/
+bool rarch_perf_get_percentiles(const struct retro_perf_counter *perf,
+      struct rarch_perf_percentiles *out)
+{
+   unsigned i;
+   bool ret                      = false;
+   const struct perf_thread *thr = NULL;
+   struct perf_histogram *merged = (struct perf_histogram*)
+      calloc(1, sizeof(*merged));
+
+   if (!merged)
+      return false;
+
+   perf_registry_lock();
+   for (thr = perf_registry.threads; thr; thr = thr->next)
+   {
+      const struct perf_thread_counter *node =
+         perf_thread_counter_find(thr, perf);
+
+      if (!node)
+         continue;
+
+      for (i = 0; i < PERF_HIST_BUCKETS; i++)
+         merged->buckets[i] += node->hist.buckets[i];
+      merged->count += node->hist.count;
+      if (node->hist.max > merged->max)
+         merged->max = node->hist.max;
+   }
+   perf_registry_unlock();
+
+   ret = merged->count != 0;
+   if (ret)
+      perf_hist_percentiles(merged, out);
+
+   free(merged);
+   return ret;
+}
+
+/**
+ * rarch_perf_reset:
+ * @perf               : performance counter
+ *
+ * Clears totals, run count and histogram of @perf on all
+ * threads. Runs in flight on other threads may survive.
+ **/
+void rarch_perf_reset(struct retro_perf_counter *perf)
+{
+   struct perf_thread *thr = NULL;
+
+   if (!perf)
+      return;
+
+   perf->total    = 0;
+   perf->call_cnt = 0;
+
+   perf_registry_lock();
+   for (thr = perf_registry.threads; thr; thr = thr->next)
+   {
+      struct perf_thread_counter *node = perf_thread_counter_find(thr, perf);
+
+      if (!node)
+         continue;
+
+      node->total    = 0;
+      node->call_cnt = 0;
+      memset(&node->hist, 0, sizeof(node->hist));
+      memset(node->hw_total, 0, sizeof(node->hw_total));
+   }
+   perf_registry_unlock();
+}
+
+#ifdef PERF_TLS
+/**
+ * perf_thread_counter_fold:
+ * @dst                : share to add to.
+ * @src                : share of an exiting thread.
+ **/
+static void perf_thread_counter_fold(struct perf_thread_counter *dst,
+      const struct perf_thread_counter *src)
+{
+   unsigned i;
+
+   dst->total    += src->total;
+   dst->call_cnt += src->call_cnt;
+
+   for (i = 0; i < PERF_HIST_BUCKETS; i++)
+      dst->hist.buckets[i] += src->hist.buckets[i];
+   dst->hist.count += src->hist.count;
+   if (src->hist.max > dst->hist.max)
+      dst->hist.max = src->hist.max;
+
+   for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+      dst->hw_total[i] += src->hw_total[i];
+}
+#endif
+
+/**
+ * rarch_perf_thread_exit:
+ *
+ * Must be called by a thread that used counters right before
+ * it exits. Folds its shares into the registry, so totals
+ * survive the thread, and releases its state and perf_event
+ * group.
+ **/
+void rarch_perf_thread_exit(void)
+{
+#ifdef PERF_TLS
+   unsigned i;
+   struct perf_thread **link = NULL;
+   struct perf_thread *thr   = perf_thread_self;
+   struct perf_thread *dst   = &perf_thread_exited;
+
+   if (!thr)
+      return;
+
+   perf_thread_self = NULL;
+
+   perf_registry_lock();
+
+   if (!perf_thread_exited_linked)
+   {
+      dst->hw_fd = -1;
+      for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+         dst->hw_index[i] = -1;
+
+      dst->next                 = perf_registry.threads;
+      perf_registry.threads     = dst;
+      perf_thread_exited_linked = true;
+   }
+
+   for (link = &perf_registry.threads; *link; link = &(*link)->next)
+   {
+      if (*link != thr)
+         continue;
+
+      *link = thr->next;
+      break;
+   }
+
+   for (i = 0; i < PERF_THREAD_BUCKETS; i++)
+   {
+      struct perf_thread_counter *node = thr->buckets[i];
+
+      while (node)
+      {
+         struct perf_thread_counter *next = node->next;
+         struct perf_thread_counter *sum  =
+            perf_thread_counter_get(dst, node->counter);
+
+         if (sum)
+            perf_thread_counter_fold(sum, node);
+
+         free(node);
+         node = next;
+      }
+   }
+
+   if (thr->hw_tried)
+   {
+      dst->hw_tried = true;
+      for (i = 0; i < RARCH_PERF_HW_LAST; i++)
+         if (thr->hw_index[i] >= 0)
+            dst->hw_index[i] = i;
+   }
+
+   perf_registry_unlock();
+
+#ifdef PERF_HW_EVENTS
+   perf_hw_close(thr);
+#endif
+   free(thr);
+#endif
+}
+
+/**
+ * rarch_perf_deinit:
+ *
+ * Closes the perf_event groups still open. Totals stay
+ * readable. Must run after all other threads have exited.
+ **/
+void rarch_perf_deinit(void)
+{
+#ifdef PERF_HW_EVENTS
+   struct perf_thread *thr = NULL;
+
+   perf_registry_lock();
+   for (thr = perf_registry.threads; thr; thr = thr->next)
+      perf_hw_close(thr);
+   perf_registry_unlock();
+#endif
+}
+
+/**
+ * rarch_perf_get_frame_time_percentiles:
+ * @out                : filled in with the frame time distribution (usec).
+ *
+ * Returns: true if any frame time has been recorded, otherwise false.
+ **/
+bool rarch_perf_get_frame_time_percentiles(
+      struct rarch_perf_percentiles *out)
+{
+   if (!perf_frame_time.count)
+      return false;
+
+   perf_hist_percentiles(&perf_frame_time, out);
+   return true;
+}
+
+void rarch_perf_frame_time_add(retro_time_t usec)
+{
+   perf_hist_add(&perf_frame_time, usec);
+}
+
+void rarch_perf_frame_limit_error_add(retro_time_t usec)
+{
+   perf_hist_add(&perf_frame_limit_error, usec < 0 ? -usec : usec);
+}
+
+/**
+ * perf_registry_push:
+ * @list               : registry to add @perf to.
+ * @count              : number of counters in @list.
+ * @cap                : capacity of @list.
+ * @perf               : counter to add.
+ *
+ * Appends @perf, doubling the registry when full. The old
+ * array is retired instead of freed, as the main thread may
+ * be reading it unlocked; since the registry only doubles,
+ * all retired arrays together stay smaller than the live one.
+ *
+ * Must be called with the registry locked.
+ *
+ * Returns: true if @perf was added, false on OOM.
+ **/
+static bool perf_registry_push(const struct retro_perf_counter ***list,
+      unsigned *count, unsigned *cap, const struct retro_perf_counter *perf)
+{
+   if (*count >= *cap)
+   {
+      struct perf_retired *retired      = NULL;
+      unsigned new_cap                  = *cap ? *cap * 2 : 64;
+      const struct retro_perf_counter **counters =
+         (const struct retro_perf_counter**)calloc(new_cap, sizeof(*counters));
+
+      if (!counters)
+         return false;
+
+      if (*list)
+      {
+         if (!(retired = (struct perf_retired*)calloc(1, sizeof(*retired))))
+         {
+            free(counters);
+            return false;
+         }
+
+         memcpy(counters, *list, *count * sizeof(*counters));
+         retired->counters     = *list;
+         retired->next         = perf_registry.retired;
+         perf_registry.retired = retired;
+      }
+
+      PERF_MEMORY_BARRIER();
+      *list = counters;
+      *cap  = new_cap;
+   }
+
+   (*list)[*count] = perf;
+   PERF_MEMORY_BARRIER();
+   (*count)++;
+   return true;
+}
+
+void rarch_perf_register(struct retro_perf_counter *perf)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global->perfcnt_enable || perf->registered)
+      return;
+
+   perf_registry_lock();
+   if (!perf->registered && perf_registry_push(&perf_counters_rarch,
+            &perf_ptr_rarch, &perf_registry.cap_rarch, perf))
+      perf->registered = true;
+   perf_registry_unlock();
+}
+
+void retro_perf_register(struct retro_perf_counter *perf)
+{
+   if (perf->registered)
+      return;
+
+   perf_registry_lock();
+   if (!perf->registered && perf_registry_push(&perf_counters_libretro,
+            &perf_ptr_libretro, &perf_registry.cap_libretro, perf))
+      perf->registered = true;
+   perf_registry_unlock();
+}
+
+void retro_perf_clear(void)
+{
+   unsigned i;
+
+   /* The core is going away; a counter of the next one may
+    * end up at the same address and must start from zero. */
+   for (i = 0; i < perf_ptr_libretro; i++)
+      rarch_perf_reset((struct retro_perf_counter*)perf_counters_libretro[i]);
+
+   perf_ptr_libretro = 0;
+}
+
+/**
+ * log_counter_hw:
+ *
+ * Logs IPC, and cache and branch misses per thousand
+ * instructions (MPKI), of whichever events were counted.
+ **/
+static void log_counter_hw(const struct retro_perf_counter *counter,
+      const struct rarch_perf_hw *hw)
+{
+   char buf[128];
+   double kinstr = hw->value[RARCH_PERF_HW_INSTRUCTIONS] / 1000.0;
+
+   buf[0] = '\0';
+
+   if (hw->mask & (1 << RARCH_PERF_HW_INSTRUCTIONS))
+      snprintf(buf, sizeof(buf), "IPC %.2f",
+            (double)hw->value[RARCH_PERF_HW_INSTRUCTIONS] /
+            hw->value[RARCH_PERF_HW_CYCLES]);
+
+   if (kinstr > 0.0 && (hw->mask & (1 << RARCH_PERF_HW_CACHE_MISSES)))
+      snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
+            ", cache MPKI %.2f",
+            hw->value[RARCH_PERF_HW_CACHE_MISSES] / kinstr);
+
+   if (kinstr > 0.0 && (hw->mask & (1 << RARCH_PERF_HW_BRANCH_MISSES)))
+      snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
+            ", branch MPKI %.2f",
+            hw->value[RARCH_PERF_HW_BRANCH_MISSES] / kinstr);
+
+   RARCH_LOG("[PERF]:     (%s): %llu cycles, %s.\n", counter->ident,
+         (unsigned long long)hw->value[RARCH_PERF_HW_CYCLES],
+         *buf ? buf : "no other events");
+}
+
+static void log_counters(
+      const struct retro_perf_counter **counters, unsigned num)
+{
+   unsigned i;
+   for (i = 0; i < num; i++)
+   {
+      retro_perf_tick_t total;
+      uint64_t call_cnt;
+      struct rarch_perf_hw hw;
+      struct rarch_perf_percentiles pct;
+
+      rarch_perf_get_totals(counters[i], &total, &call_cnt);
+
+      if (call_cnt)
+      {
+         RARCH_LOG(PERF_LOG_FMT,
+               counters[i]->ident,
+               (unsigned long long)total / 
+               (unsigned long long)call_cnt,
+               (unsigned long long)call_cnt);
+
+         if (rarch_perf_get_percentiles(counters[i], &pct))
+            RARCH_LOG(PERF_LOG_PCT_FMT,
+                  counters[i]->ident,
+                  (unsigned long long)pct.p50,
+                  (unsigned long long)pct.p95,
+                  (unsigned long long)pct.p99,
+                  (unsigned long long)pct.max);
+
+         if (rarch_perf_get_hw(counters[i], &hw))
+            log_counter_hw(counters[i], &hw);
+      }
+   }
+}
+
+void rarch_perf_log(void)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global->perfcnt_enable)
+      return;
+
+   RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
+   log_counters(perf_counters_rarch, perf_ptr_rarch);
+
+   if (perf_frame_time.count)
+   {
+      struct rarch_perf_percentiles pct;
+
+      perf_hist_percentiles(&perf_frame_time, &pct);
+      RARCH_LOG("[PERF]: Frame time: p50 %.3f ms, p95 %.3f ms, "
+            "p99 %.3f ms, max %.3f ms, %llu frames.\n",
+            pct.p50 / 1000.0, pct.p95 / 1000.0,
+            pct.p99 / 1000.0, pct.max / 1000.0,
+            (unsigned long long)pct.count);
+   }
+
+   if (perf_frame_limit_error.count)
+   {
+      struct rarch_perf_percentiles pct;
+
+      perf_hist_percentiles(&perf_frame_limit_error, &pct);
+      RARCH_LOG("[PERF]: Frame limiter interval error: p50 %llu us, "
+            "p95 %llu us, p99 %llu us, max %llu us, %llu frames.\n",
+            (unsigned long long)pct.p50, (unsigned long long)pct.p95,
+            (unsigned long long)pct.p99, (unsigned long long)pct.max,
+            (unsigned long long)pct.count);
+   }
+}
+
+void retro_perf_log(void)
+{
+   RARCH_LOG("[PERF]: Performance counters (libretro):\n");
+   log_counters(perf_counters_libretro, perf_ptr_libretro);
+}
+
+#define STARTUP_MAX_PHASES 64
+
+struct startup_phase
+{
+   const char *name;
+   retro_time_t start;
+   retro_time_t end;
+   unsigned depth;
+};
+
+static struct
+{
+   struct startup_phase phases[STARTUP_MAX_PHASES];
+   unsigned stack[STARTUP_MAX_PHASES];
+   unsigned count;
+   unsigned depth;
+   unsigned overflow;
+   retro_time_t start;
+   bool active;
+} startup_trace;
 
-const struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
-const struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
-unsigned perf_ptr_rarch;
-unsigned perf_ptr_libretro;
+/**
+ * rarch_startup_trace_init:
+ *
+ * Starts recording startup phases. Phases begun before
+ * this or after rarch_startup_trace_finish() are ignored.
+ **/
+void rarch_startup_trace_init(void)
+{
+   memset(&startup_trace, 0, sizeof(startup_trace));
+   startup_trace.start  = rarch_get_time_usec();
+   startup_trace.active = true;
+}
 
-void rarch_perf_register(struct retro_perf_counter *perf)
+/**
+ * rarch_startup_phase_begin:
+ * @name               : name of the phase, must be a string literal.
+ *
+ * Opens a startup phase. Phases nest, and are closed
+ * with rarch_startup_phase_end() in reverse order.
+ **/
+void rarch_startup_phase_begin(const char *name)
 {
-   global_t *global = global_get_ptr();
+   struct startup_phase *phase = NULL;
+
+   if (!startup_trace.active)
+      return;
+
+   /* Keep begin/end balanced even when out of room. */
+   if (startup_trace.depth >= STARTUP_MAX_PHASES)
+   {
+      startup_trace.overflow++;
+      return;
+   }
 
-   if (!global->perfcnt_enable || perf->registered 
-         || perf_ptr_rarch >= MAX_COUNTERS)
+   if (startup_trace.count >= STARTUP_MAX_PHASES)
+   {
+      startup_trace.stack[startup_trace.depth++] = STARTUP_MAX_PHASES;
       return;
+   }
 
-   perf_counters_rarch[perf_ptr_rarch++] = perf;
-   perf->registered = true;
+   phase        = &startup_trace.phases[startup_trace.count];
+   phase->name  = name;
+   phase->depth = startup_trace.depth;
+   phase->start = rarch_get_time_usec();
+   phase->end   = 0;
+
+   startup_trace.stack[startup_trace.depth++] = startup_trace.count++;
 }
 
-void retro_perf_register(struct retro_perf_counter *perf)
+/**
+ * rarch_startup_phase_end:
+ *
+ * Closes the innermost open startup phase.
+ **/
+void rarch_startup_phase_end(void)
 {
-   if (perf->registered || perf_ptr_libretro >= MAX_COUNTERS)
+   unsigned idx;
+
+   if (!startup_trace.active)
+      return;
+
+   if (startup_trace.overflow)
+   {
+      startup_trace.overflow--;
+      return;
+   }
+
+   if (!startup_trace.depth)
       return;
 
-   perf_counters_libretro[perf_ptr_libretro++] = perf;
-   perf->registered = true;
+   idx = startup_trace.stack[--startup_trace.depth];
+   if (idx < STARTUP_MAX_PHASES)
+      startup_trace.phases[idx].end = rarch_get_time_usec();
 }
 
-void retro_perf_clear(void)
+/**
+ * perf_json_write_string:
+ * @file               : file to write to
+ * @str                : string to write, may be NULL
+ *
+ * Writes @str as a quoted JSON string, escaping quotes,
+ * backslashes and control characters.
+ **/
+static void perf_json_write_string(FILE *file, const char *str)
 {
-   perf_ptr_libretro = 0;
-   memset(perf_counters_libretro, 0, sizeof(perf_counters_libretro));
+   const unsigned char *p = (const unsigned char*)(str ? str : "(null)");
+
+   fputc('"', file);
+
+   for (; *p; p++)
+   {
+      switch (*p)
+      {
+         case '"':
+            fputs("\\\"", file);
+            break;
+         case '\\':
+            fputs("\\\\", file);
+            break;
+         case '\n':
+            fputs("\\n", file);
+            break;
+         case '\r':
+            fputs("\\r", file);
+            break;
+         case '\t':
+            fputs("\\t", file);
+            break;
+         default:
+            if (*p < 0x20)
+               fprintf(file, "\\u%04x", *p);
+            else
+               fputc(*p, file);
+            break;
+      }
+   }
+
+   fputc('"', file);
 }
 
-static void log_counters(
-      const struct retro_perf_counter **counters, unsigned num)
+static void startup_trace_write(const char *path, retro_time_t end)
 {
    unsigned i;
-   for (i = 0; i < num; i++)
+   FILE *file = fopen(path, "w");
+
+   if (!file)
+   {
+      RARCH_ERR("[PERF]: Could not write startup trace to \"%s\".\n", path);
+      return;
+   }
+
+   fprintf(file, "{\"traceEvents\":[\n");
+   fprintf(file, "{\"name\":\"startup\",\"cat\":\"startup\",\"ph\":\"X\","
+         "\"ts\":0,\"dur\":%llu,\"pid\":1,\"tid\":1}",
+         (unsigned long long)(end - startup_trace.start));
+
+   for (i = 0; i < startup_trace.count; i++)
+   {
+      const struct startup_phase *phase = &startup_trace.phases[i];
+
+      fprintf(file, ",\n{\"name\":");
+      perf_json_write_string(file, phase->name);
+      fprintf(file, ",\"cat\":\"startup\",\"ph\":\"X\","
+            "\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":1}",
+            (unsigned long long)(phase->start - startup_trace.start),
+            (unsigned long long)(phase->end - phase->start));
+   }
+
+   fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+   fclose(file);
+
+   RARCH_LOG("[PERF]: Startup trace written to \"%s\".\n", path);
+}
+
+/**
+ * rarch_startup_trace_finish:
+ * @path               : Chrome trace output path, or NULL.
+ *
+ * Stops recording, logs a summary of all startup phases and
+ * writes them as Chrome trace events (chrome://tracing) to @path.
+ **/
+void rarch_startup_trace_finish(const char *path)
+{
+   unsigned i;
+   retro_time_t end = rarch_get_time_usec();
+
+   if (!startup_trace.active)
+      return;
+
+   /* Close whatever an early exit left open. */
+   for (i = 0; i < startup_trace.count; i++)
+      if (!startup_trace.phases[i].end)
+         startup_trace.phases[i].end = end;
+
+   startup_trace.active = false;
+
+   RARCH_LOG("[PERF]: Startup phases:\n");
+   for (i = 0; i < startup_trace.count; i++)
+   {
+      const struct startup_phase *phase = &startup_trace.phases[i];
+
+      RARCH_LOG("[PERF]: %*s%-*s %8.3f ms\n",
+            phase->depth * 2, "", 28 - phase->depth * 2, phase->name,
+            (phase->end - phase->start) / 1000.0);
+   }
+   RARCH_LOG("[PERF]: Startup total: %.3f ms\n",
+         (end - startup_trace.start) / 1000.0);
+
+   if (path && *path)
+      startup_trace_write(path, end);
+}
+
+/* Events kept per thread, must be a power of two. */
+#define PERF_TRACE_EVENTS  (1 << 14)
+#define PERF_TRACE_MASK    (PERF_TRACE_EVENTS - 1)
+#define PERF_TRACE_CACHE   64
+
+enum perf_trace_type
+{
+   PERF_TRACE_BEGIN = 0,
+   PERF_TRACE_END,
+   PERF_TRACE_COUNTER
+};
+
+struct perf_trace_event
+{
+   const char *name;
+   retro_time_t ts;
+   unsigned type;
+   /* Only used by counter samples. */
+   unsigned value;
+};
+
+struct perf_trace_name
+{
+   char *name;
+   struct perf_trace_name *next;
+};
+
+struct perf_trace_thread
+{
+   struct perf_trace_event events[PERF_TRACE_EVENTS];
+   /* Only ever written by the owning thread. */
+   uint64_t head;
+   unsigned tid;
+   unsigned generation;
+   const char *thread_name;
+
+   /* Caller's name pointer -> interned copy. */
+   const char *cache_key[PERF_TRACE_CACHE];
+   const char *cache_val[PERF_TRACE_CACHE];
+
+   struct perf_trace_thread *next;
+};
+
+bool perf_trace_enable;
+
+static struct
+{
+   struct perf_trace_thread *threads;
+   struct perf_trace_name *names;
+   unsigned thread_count;
+   unsigned generation;
+   retro_time_t start;
+   char *path;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+} perf_trace;
+
+#ifdef PERF_TLS
+static PERF_TLS struct perf_trace_thread *perf_trace_self;
+static PERF_TLS unsigned perf_trace_self_generation;
+static PERF_TLS const char *perf_trace_self_name;
+#endif
+
+static void perf_trace_lock(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(perf_trace.lock);
+#endif
+}
+
+static void perf_trace_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(perf_trace.lock);
+#endif
+}
+
+#ifdef PERF_TLS
+/**
+ * perf_trace_get_thread:
+ *
+ * Returns: the calling thread's event buffer, which is
+ * allocated and registered on first use. NULL on OOM.
+ **/
+static struct perf_trace_thread *perf_trace_get_thread(void)
+{
+   struct perf_trace_thread *thr = perf_trace_self;
+
+   if (thr && perf_trace_self_generation == perf_trace.generation)
+      return thr;
+
+   thr = (struct perf_trace_thread*)calloc(1, sizeof(*thr));
+   if (!thr)
+      return NULL;
+
+   thr->thread_name  = perf_trace_self_name;
+
+   perf_trace_lock();
+   thr->generation   = perf_trace.generation;
+   thr->tid          = ++perf_trace.thread_count;
+   thr->next         = perf_trace.threads;
+   perf_trace.threads = thr;
+   perf_trace_unlock();
+
+   perf_trace_self            = thr;
+   perf_trace_self_generation = thr->generation;
+   return thr;
+}
+
+/**
+ * perf_trace_intern:
+ * @thr                : calling thread's event buffer.
+ * @name               : counter name.
+ *
+ * Counter names of libretro cores point into the core,
+ * which may be unloaded before the trace is written, so
+ * every name is recorded as a private copy. The per-thread
+ * cache keeps this off the lock after the first lookup.
+ *
+ * Returns: interned copy of @name.
+ **/
+static const char *perf_trace_intern(struct perf_trace_thread *thr,
+      const char *name)
+{
+   struct perf_trace_name *node = NULL;
+   unsigned slot = (unsigned)(((uintptr_t)name >> 3) & (PERF_TRACE_CACHE - 1));
+
+   if (thr->cache_key[slot] == name && !strcmp(thr->cache_val[slot], name))
+      return thr->cache_val[slot];
+
+   perf_trace_lock();
+   for (node = perf_trace.names; node; node = node->next)
+      if (!strcmp(node->name, name))
+         break;
+
+   if (!node)
    {
-      if (counters[i]->call_cnt)
+      node = (struct perf_trace_name*)calloc(1, sizeof(*node));
+      if (node && !(node->name = strdup(name)))
       {
-         RARCH_LOG(PERF_LOG_FMT,
-               counters[i]->ident,
-               (unsigned long long)counters[i]->total / 
-               (unsigned long long)counters[i]->call_cnt,
-               (unsigned long long)counters[i]->call_cnt);
+         free(node);
+         node = NULL;
+      }
+
+      if (node)
+      {
+         node->next       = perf_trace.names;
+         perf_trace.names = node;
       }
    }
+   perf_trace_unlock();
+
+   if (!node)
+      return "(null)";
+
+   thr->cache_key[slot] = name;
+   thr->cache_val[slot] = node->name;
+   return node->name;
 }
 
-void rarch_perf_log(void)
+static void perf_trace_push(const char *name, unsigned type,
+      unsigned value)
 {
-   global_t *global = global_get_ptr();
+   struct perf_trace_event *ev = NULL;
+   struct perf_trace_thread *thr = perf_trace_get_thread();
 
-   if (!global->perfcnt_enable)
+   if (!thr)
       return;
 
-   RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
-   log_counters(perf_counters_rarch, perf_ptr_rarch);
+   ev       = &thr->events[thr->head & PERF_TRACE_MASK];
+   ev->name = perf_trace_intern(thr, name ? name : "(null)");
+   ev->ts   = rarch_get_time_usec();
+   ev->type  = type;
+   ev->value = value;
+
+   /* Publish only once the event is complete. */
+   thr->head++;
 }
+#endif
 
-void retro_perf_log(void)
+/**
+ * rarch_perf_trace_init:
+ * @path               : Chrome trace output path.
+ *
+ * Starts recording begin/end events of all performance
+ * counters, and of the explicit rarch_perf_trace_begin()/
+ * rarch_perf_trace_end() spans, into per-thread ring buffers.
+ **/
+void rarch_perf_trace_init(const char *path)
 {
-   RARCH_LOG("[PERF]: Performance counters (libretro):\n");
-   log_counters(perf_counters_libretro, perf_ptr_libretro);
+#ifdef PERF_TLS
+   if (perf_trace_enable || !path || !*path)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!perf_trace.lock && !(perf_trace.lock = slock_new()))
+      return;
+#endif
+
+   perf_trace.path       = strdup(path);
+   perf_trace.start      = rarch_get_time_usec();
+   perf_trace.generation++;
+   perf_trace_enable     = true;
+
+   rarch_perf_trace_thread_name("main");
+#else
+   RARCH_WARN("[PERF]: Timeline tracing is not supported on this platform.\n");
+#endif
+}
+
+/**
+ * rarch_perf_trace_thread_name:
+ * @name               : name of the calling thread, must be a string literal.
+ *
+ * Names the calling thread in the trace.
+ **/
+void rarch_perf_trace_thread_name(const char *name)
+{
+#ifdef PERF_TLS
+   struct perf_trace_thread *thr = NULL;
+
+   perf_trace_self_name = name;
+
+   if (!perf_trace_enable)
+      return;
+
+   if ((thr = perf_trace_get_thread()))
+      thr->thread_name = name;
+#endif
+}
+
+void rarch_perf_trace_begin(const char *name)
+{
+#ifdef PERF_TLS
+   if (perf_trace_enable)
+      perf_trace_push(name, PERF_TRACE_BEGIN, 0);
+#endif
+}
+
+void rarch_perf_trace_end(const char *name)
+{
+#ifdef PERF_TLS
+   if (perf_trace_enable)
+      perf_trace_push(name, PERF_TRACE_END, 0);
+#endif
+}
+
+void rarch_perf_trace_counter(const char *name, unsigned value)
+{
+#ifdef PERF_TLS
+   if (perf_trace_enable)
+      perf_trace_push(name, PERF_TRACE_COUNTER, value);
+#endif
+}
+
+static void perf_trace_write_event(FILE *file, bool *first,
+      const char *name, char ph, retro_time_t ts, unsigned tid)
+{
+   fprintf(file, "%s{\"name\":", *first ? "" : ",\n");
+   perf_json_write_string(file, name);
+   fprintf(file, ",\"cat\":\"perf\",\"ph\":\"%c\","
+         "\"ts\":%llu,\"pid\":1,\"tid\":%u}", ph,
+         (unsigned long long)(ts - perf_trace.start), tid);
+   *first = false;
+}
+
+/**
+ * perf_trace_write_thread:
+ *
+ * Writes what is left of one thread's ring. Ends whose
+ * begin was overwritten are dropped, and spans still open
+ * are closed at the last recorded timestamp.
+ **/
+static void perf_trace_write_thread(FILE *file, bool *first,
+      const struct perf_trace_thread *thr)
+{
+   uint64_t i;
+   const char *stack[64];
+   unsigned depth    = 0;
+   uint64_t head     = thr->head;
+   uint64_t tail     = head > PERF_TRACE_EVENTS ? head - PERF_TRACE_EVENTS : 0;
+   retro_time_t last = perf_trace.start;
+
+   fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+         "\"tid\":%u,\"args\":{\"name\":", *first ? "" : ",\n", thr->tid);
+   perf_json_write_string(file,
+         thr->thread_name ? thr->thread_name : "unnamed");
+   fprintf(file, "}}");
+   *first = false;
+
+   for (i = tail; i < head; i++)
+   {
+      const struct perf_trace_event *ev = &thr->events[i & PERF_TRACE_MASK];
+
+      if (ev->ts < perf_trace.start)
+         continue;
+
+      last = ev->ts;
+
+      if (ev->type == PERF_TRACE_COUNTER)
+      {
+         fprintf(file, "%s{\"name\":", *first ? "" : ",\n");
+         perf_json_write_string(file, ev->name);
+         fprintf(file, ",\"cat\":\"perf\",\"ph\":\"C\","
+               "\"ts\":%llu,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%u}}",
+               (unsigned long long)(ev->ts - perf_trace.start),
+               thr->tid, ev->value);
+         *first = false;
+         continue;
+      }
+
+      if (ev->type == PERF_TRACE_BEGIN)
+      {
+         if (depth < ARRAY_SIZE(stack))
+            stack[depth] = ev->name;
+         depth++;
+      }
+      else
+      {
+         if (!depth)
+            continue;
+         depth--;
+      }
+
+      perf_trace_write_event(file, first, ev->name,
+            ev->type == PERF_TRACE_BEGIN ? 'B' : 'E', ev->ts, thr->tid);
+   }
+
+   while (depth--)
+      perf_trace_write_event(file, first,
+            depth < ARRAY_SIZE(stack) ? stack[depth] : "(null)",
+            'E', last, thr->tid);
+}
+
+/**
+ * rarch_perf_trace_deinit:
+ *
+ * Stops recording and writes all per-thread events as
+ * Chrome trace events (chrome://tracing) to the path given
+ * to rarch_perf_trace_init(). The other threads must have
+ * stopped recording by now, as the rings are read unlocked.
+ **/
+void rarch_perf_trace_deinit(void)
+{
+   FILE *file                       = NULL;
+   bool first                       = true;
+   struct perf_trace_thread *thr    = NULL;
+   struct perf_trace_name *name     = NULL;
+
+   if (!perf_trace_enable)
+      return;
+
+   perf_trace_enable = false;
+
+   if (!(file = fopen(perf_trace.path, "w")))
+      RARCH_ERR("[PERF]: Could not write perf trace to \"%s\".\n",
+            perf_trace.path);
+   else
+   {
+      fprintf(file, "{\"traceEvents\":[\n");
+      for (thr = perf_trace.threads; thr; thr = thr->next)
+         perf_trace_write_thread(file, &first, thr);
+      fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+      fclose(file);
+
+      RARCH_LOG("[PERF]: Perf trace of %u thread(s) written to \"%s\".\n",
+            perf_trace.thread_count, perf_trace.path);
+   }
+
+   perf_trace_lock();
+   thr = perf_trace.threads;
+   while (thr)
+   {
+      struct perf_trace_thread *next = thr->next;
+      free(thr);
+      thr = next;
+   }
+
+   name = perf_trace.names;
+   while (name)
+   {
+      struct perf_trace_name *next = name->next;
+      free(name->name);
+      free(name);
+      name = next;
+   }
+
+   perf_trace.threads      = NULL;
+   perf_trace.names        = NULL;
+   perf_trace.thread_count = 0;
+   perf_trace_unlock();
+
+   free(perf_trace.path);
+   perf_trace.path = NULL;
 }
 
 /**
@@ -263,6 +1812,83 @@ retro_time_t rarch_get_time_usec(void)
 #endif
 }
 
+/* Bounds of the part of a wait that is spun rather than slept. */
+#define SLEEP_MARGIN_MIN   50
+#define SLEEP_MARGIN_MAX 4000
+
+/* Running estimate of how late the OS wakes us up (mean
+ * and mean deviation, in usec), see rarch_sleep_until(). */
+static retro_time_t sleep_late_avg  = 500;
+static retro_time_t sleep_late_mdev = 250;
+
+static INLINE void rarch_cpu_relax(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   __asm__ __volatile__("pause");
+#endif
+}
+
+/**
+ * rarch_sleep_until:
+ * @deadline           : absolute time, as returned by rarch_get_time_usec().
+ *
+ * Sleeps until @deadline. The OS sleep is aimed a margin
+ * short of it, where the margin follows how late wakeups
+ * have actually been, and the rest is spun. On Linux the
+ * sleep is against an absolute deadline, so it doesn't add
+ * up rounding or the time spent getting here.
+ *
+ * Not meant to be used from more than one thread at once,
+ * the calibration is shared.
+ *
+ * Returns: the time the wait actually ended.
+ **/
+retro_time_t rarch_sleep_until(retro_time_t deadline)
+{
+   retro_time_t now    = rarch_get_time_usec();
+   retro_time_t margin = sleep_late_avg + 4 * sleep_late_mdev;
+
+   if (margin < SLEEP_MARGIN_MIN)
+      margin = SLEEP_MARGIN_MIN;
+   else if (margin > SLEEP_MARGIN_MAX)
+      margin = SLEEP_MARGIN_MAX;
+
+   if (deadline - margin > now)
+   {
+      retro_time_t late;
+      retro_time_t wake = deadline - margin;
+#if defined(__linux__) && defined(_POSIX_MONOTONIC_CLOCK) && defined(TIMER_ABSTIME)
+      struct timespec ts;
+
+      ts.tv_sec  = wake / 1000000;
+      ts.tv_nsec = (wake % 1000000) * 1000;
+
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+#else
+      /* Whole milliseconds only, never past the wake time. */
+      if ((wake - now) / 1000 > 0)
+         rarch_sleep((unsigned)((wake - now) / 1000));
+#endif
+      now  = rarch_get_time_usec();
+      late = now - wake;
+
+      if (late > 0)
+      {
+         retro_time_t err  = late - sleep_late_avg;
+         sleep_late_avg   += err / 8;
+         sleep_late_mdev  += ((err < 0 ? -err : err) - sleep_late_mdev) / 4;
+      }
+   }
+
+   while (now < deadline)
+   {
+      rarch_cpu_relax();
+      now = rarch_get_time_usec();
+   }
+
+   return now;
+}
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
 #define CPU_X86
 #endif
@@ -341,60 +1967,6 @@ static void arm_enable_runfast_mode(void)
 }
 #endif
 
-/**
- * rarch_get_cpu_cores:
- *
- * Gets the amount of available CPU cores.
- *
- * Returns: amount of CPU cores available.
- **/
-unsigned rarch_get_cpu_cores(void)
-{
-#if defined(_WIN32) && !defined(_XBOX)
-   /* Win32 */
-   SYSTEM_INFO sysinfo;
-   GetSystemInfo(&sysinfo);
-   return sysinfo.dwNumberOfProcessors;
-#elif defined(ANDROID)
-   return android_getCpuCount();
-#elif defined(GEKKO)
-   return 1;
-#elif defined(PSP)
-   return 1;
-#elif defined(_3DS)
-   return 1;
-#elif defined(_SC_NPROCESSORS_ONLN)
-   /* Linux, most UNIX-likes. */
-   long ret = sysconf(_SC_NPROCESSORS_ONLN);
-   if (ret <= 0)
-      return (unsigned)1;
-   return ret;
-#elif defined(BSD) || defined(__APPLE__)
-   /* BSD */
-   /* Copypasta from stackoverflow, dunno if it works. */
-   int num_cpu = 0;
-   int mib[4];
-   size_t len = sizeof(num_cpu);
-
-   mib[0] = CTL_HW;
-   mib[1] = HW_AVAILCPU;
-   sysctl(mib, 2, &num_cpu, &len, NULL, 0);
-   if (num_cpu < 1)
-   {
-      mib[1] = HW_NCPU;
-      sysctl(mib, 2, &num_cpu, &len, NULL, 0);
-      if (num_cpu < 1)
-         num_cpu = 1;
-   }
-   return num_cpu;
-#elif defined(_XBOX360)
-   return 3;
-#else
-   /* No idea, assume single core. */
-   return 1;
-#endif
-}
-
 /**
  * rarch_get_cpu_features:
  *
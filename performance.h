@@ -18,6 +18,7 @@
 #define _RARCH_PERF_H
 
 #include "general.h"
+#include "performance/cpu_cores.h"
 #include <retro_inline.h>
 
 #ifdef __cplusplus
@@ -26,8 +27,10 @@ extern "C" {
 
 #ifdef _WIN32
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %I64u ticks, %I64u runs.\n"
+#define PERF_LOG_PCT_FMT "[PERF]:     (%s): p50 %I64u, p95 %I64u, p99 %I64u, max %I64u ticks.\n"
 #else
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %llu ticks, %llu runs.\n"
+#define PERF_LOG_PCT_FMT "[PERF]:     (%s): p50 %llu, p95 %llu, p99 %llu, max %llu ticks.\n"
 #endif
 
 /* Used internally by RetroArch. */
@@ -41,15 +44,43 @@ extern "C" {
 #define RARCH_PERFORMANCE_START(X) rarch_perf_start(&(X))
 #define RARCH_PERFORMANCE_STOP(X) rarch_perf_stop(&(X))
 
-#ifndef MAX_COUNTERS
-#define MAX_COUNTERS 64
-#endif
-
-extern const struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
-extern const struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
+/* Registered counters. Each thread keeps its own totals,
+ * read them through rarch_perf_get_totals(). */
+extern const struct retro_perf_counter **perf_counters_rarch;
+extern const struct retro_perf_counter **perf_counters_libretro;
 extern unsigned perf_ptr_rarch;
 extern unsigned perf_ptr_libretro;
 
+struct rarch_perf_percentiles
+{
+   retro_perf_tick_t p50;
+   retro_perf_tick_t p95;
+   retro_perf_tick_t p99;
+   retro_perf_tick_t max;
+   uint64_t count;
+};
+
+enum rarch_perf_hw_event
+{
+   RARCH_PERF_HW_CYCLES = 0,
+   RARCH_PERF_HW_INSTRUCTIONS,
+   RARCH_PERF_HW_CACHE_MISSES,
+   RARCH_PERF_HW_BRANCH_MISSES,
+   RARCH_PERF_HW_LAST
+};
+
+/* Hardware events counted inside a performance counter,
+ * see perfcnt_hw_enable. */
+struct rarch_perf_hw
+{
+   uint64_t value[RARCH_PERF_HW_LAST];
+   /* Bit per rarch_perf_hw_event the PMU could count. */
+   unsigned mask;
+};
+
+/* Set while rarch_perf_trace_init() is recording. */
+extern bool perf_trace_enable;
+
 
 /**
  * rarch_get_perf_counter:
@@ -69,6 +100,16 @@ retro_perf_tick_t rarch_get_perf_counter(void);
  **/
 retro_time_t rarch_get_time_usec(void);
 
+/**
+ * rarch_sleep_until:
+ * @deadline           : absolute time, as returned by rarch_get_time_usec().
+ *
+ * Sleeps, then spins, until @deadline.
+ *
+ * Returns: the time the wait actually ended.
+ **/
+retro_time_t rarch_sleep_until(retro_time_t deadline);
+
 void rarch_perf_register(struct retro_perf_counter *perf);
 
 /* Same as rarch_perf_register, just for libretro cores. */
@@ -78,57 +119,170 @@ void retro_perf_clear(void);
 
 void rarch_perf_log(void);
 
+/**
+ * rarch_perf_init:
+ *
+ * Sets up the counter registry. Must run before any
+ * thread other than the main one uses a counter.
+ **/
+void rarch_perf_init(void);
+
+/**
+ * rarch_perf_deinit:
+ *
+ * Closes the hardware counters still open.
+ **/
+void rarch_perf_deinit(void);
+
+/**
+ * rarch_perf_thread_exit:
+ *
+ * Called by a thread that used counters right before it
+ * exits, keeps its totals and releases its state.
+ **/
+void rarch_perf_thread_exit(void);
+
+void rarch_perf_get_totals(const struct retro_perf_counter *perf,
+      retro_perf_tick_t *total, uint64_t *call_cnt);
+
+bool rarch_perf_get_percentiles(const struct retro_perf_counter *perf,
+      struct rarch_perf_percentiles *out);
+
+bool rarch_perf_get_hw(const struct retro_perf_counter *perf,
+      struct rarch_perf_hw *out);
+
+bool rarch_perf_get_frame_time_percentiles(
+      struct rarch_perf_percentiles *out);
+
+/**
+ * rarch_perf_reset:
+ * @perf               : performance counter
+ *
+ * Clears totals, run count and histogram of @perf.
+ **/
+void rarch_perf_reset(struct retro_perf_counter *perf);
+
+/**
+ * rarch_perf_frame_time_add:
+ * @usec               : time since the previous frame, in microseconds.
+ *
+ * Adds a frame to the frame time histogram.
+ **/
+void rarch_perf_frame_time_add(retro_time_t usec);
+
+/**
+ * rarch_perf_frame_limit_error_add:
+ * @usec               : achieved minus wanted frame interval, in microseconds.
+ *
+ * Adds a frame to the frame limiter error histogram.
+ **/
+void rarch_perf_frame_limit_error_add(retro_time_t usec);
+
 void retro_perf_log(void);
 
 /**
- * rarch_perf_start:
- * @perf               : pointer to performance counter
+ * rarch_startup_trace_init:
  *
- * Start performance counter. 
+ * Starts recording startup phases.
  **/
-static INLINE void rarch_perf_start(struct retro_perf_counter *perf)
-{
-   global_t *global = global_get_ptr();
-   if (!global->perfcnt_enable || !perf)
-      return;
+void rarch_startup_trace_init(void);
 
-   perf->call_cnt++;
-   perf->start = rarch_get_perf_counter();
-}
+/**
+ * rarch_startup_phase_begin:
+ * @name               : name of the phase, must be a string literal.
+ *
+ * Opens a (nestable) startup phase.
+ **/
+void rarch_startup_phase_begin(const char *name);
 
 /**
- * rarch_perf_stop:
- * @perf               : pointer to performance counter
+ * rarch_startup_phase_end:
  *
- * Stop performance counter. 
+ * Closes the innermost open startup phase.
  **/
-static INLINE void rarch_perf_stop(struct retro_perf_counter *perf)
-{
-   global_t *global = global_get_ptr();
-   if (!global->perfcnt_enable || !perf)
-      return;
+void rarch_startup_phase_end(void);
 
-   perf->total += rarch_get_perf_counter() - perf->start;
-}
+/**
+ * rarch_startup_trace_finish:
+ * @path               : Chrome trace output path, or NULL.
+ *
+ * Stops recording, logs a summary and writes the trace to @path.
+ **/
+void rarch_startup_trace_finish(const char *path);
 
 /**
- * rarch_get_cpu_features:
+ * rarch_perf_trace_init:
+ * @path               : Chrome trace output path.
  *
- * Gets CPU features..
+ * Starts recording timestamped begin/end events of all
+ * performance counters into per-thread ring buffers.
+ **/
+void rarch_perf_trace_init(const char *path);
+
+/**
+ * rarch_perf_trace_deinit:
  *
- * Returns: bitmask of all CPU features available.
+ * Stops recording and writes the trace.
  **/
-uint64_t rarch_get_cpu_features(void);
+void rarch_perf_trace_deinit(void);
+
+/**
+ * rarch_perf_trace_thread_name:
+ * @name               : name of the calling thread, must be a string literal.
+ *
+ * Names the calling thread in the trace.
+ **/
+void rarch_perf_trace_thread_name(const char *name);
 
 /**
- * rarch_get_cpu_cores:
+ * rarch_perf_trace_begin:
+ * @name               : name of the span.
  *
- * Gets the amount of available CPU cores.
+ * Opens a span on the calling thread's timeline.
+ **/
+void rarch_perf_trace_begin(const char *name);
+
+/**
+ * rarch_perf_trace_end:
+ * @name               : name of the span.
  *
- * Returns: amount of CPU cores available.
+ * Closes the innermost span on the calling thread's timeline.
  **/
-unsigned rarch_get_cpu_cores(void);
+void rarch_perf_trace_end(const char *name);
 
+/**
+ * rarch_perf_trace_counter:
+ * @name               : name of the counter.
+ * @value              : its current value.
+ *
+ * Records a sample of a value plotted over time in the trace.
+ **/
+void rarch_perf_trace_counter(const char *name, unsigned value);
+
+/**
+ * rarch_perf_start:
+ * @perf               : pointer to performance counter
+ *
+ * Start performance counter on the calling thread.
+ **/
+void rarch_perf_start(struct retro_perf_counter *perf);
+
+/**
+ * rarch_perf_stop:
+ * @perf               : pointer to performance counter
+ *
+ * Stop performance counter on the calling thread.
+ **/
+void rarch_perf_stop(struct retro_perf_counter *perf);
+
+/**
+ * rarch_get_cpu_features:
+ *
+ * Gets CPU features..
+ *
+ * Returns: bitmask of all CPU features available.
+ **/
+uint64_t rarch_get_cpu_features(void);
 
 #ifdef __cplusplus
 }
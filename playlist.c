@@ -2,7 +2,7 @@
  *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
  *  Copyright (C) 2011-2015 - Daniel De Matteis
  *  Copyright (C) 2013-2014 - Jason Fetters
- * 
+ *
  *  RetroArch is free software: you can redistribute it and/or modify it under the terms
  *  of the GNU General Public License as published by the Free Software Found-
  *  ation, either version 3 of the License, or (at your option) any later version.
@@ -22,57 +22,247 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
-/**
- * content_playlist_get_index:
- * @playlist        	   : Playlist handle.
- * @idx                 : Index of playlist entry.
- * @path                : Path of playlist entry.
- * @core_path           : Core path of playlist entry.
- * @core_name           : Core name of playlist entry.
- * 
- * Gets values of playlist index: 
- **/
-void content_playlist_get_index(content_playlist_t *playlist,
-      size_t idx,
-      const char **path, const char **core_path,
-      const char **core_name)
+/* Entries live in a dense node array (slots [0, size) are always in
+ * use). Recency order is kept as an intrusive doubly linked list so
+ * bumping an entry to the top is O(1), and two chained hash indexes
+ * map path + core path and path alone to nodes.
+ *
+ * On disk, the playlist file is a snapshot (most recent entry first,
+ * three lines per entry, the same format as always). Every push is
+ * also appended to '<playlist>.journal' and replayed on load, and the
+ * journal is folded back into the snapshot once it gets larger than
+ * the playlist itself, or when a playlist that pushed entries is
+ * freed. */
+
+#define PLAYLIST_NIL              ((size_t)-1)
+#define PLAYLIST_JOURNAL_EXT      ".journal"
+#define PLAYLIST_JOURNAL_MIN_SIZE 64
+
+typedef struct content_playlist_node
 {
-   if (!playlist)
-      return;
+   content_playlist_entry_t entry;
+   uint32_t hash;
+   uint32_t path_hash;
+   /* Recency for path lookups; snapshot entries count down from -1. */
+   int64_t stamp;
+   size_t prev;
+   size_t next;
+   size_t hash_next;
+   size_t path_next;
+} content_playlist_node_t;
+
+struct content_playlist
+{
+   content_playlist_node_t *nodes;
+   size_t size;
+   size_t alloc;
+   size_t cap;
+
+   size_t head;
+   size_t tail;
+   int64_t stamp;
+
+   size_t *buckets;
+   size_t *path_buckets;
+   size_t bucket_count;
+
+   /* Nodes in recency order, rebuilt on demand after a reorder. */
+   size_t *order;
+   bool order_dirty;
+
+   bool loaded;
+   /* Set once this instance appended to the journal since the last
+    * snapshot; a journal only replayed on load is left alone. */
+   bool appended;
+   size_t journal_records;
+   FILE *journal;
+   char *journal_path;
+   char *conf_path;
+};
+
+static uint32_t content_playlist_hash_str(uint32_t hash, const char *s)
+{
+   if (!s)
+      return hash;
 
-   if (path)
-      *path      = playlist->entries[idx].path;
-   if (core_path)
-      *core_path = playlist->entries[idx].core_path;
-   if (core_name)
-      *core_name = playlist->entries[idx].core_name;
+   while (*s)
+      hash = (hash << 5) + hash + (uint8_t)*s++;
+
+   return hash;
 }
 
-void content_playlist_get_index_by_path(content_playlist_t *playlist,
-      const char *search_path,
-      char **path, char **core_path,
-      char **core_name)
+static uint32_t content_playlist_hash(const char *path, const char *core_path)
+{
+   uint32_t hash = content_playlist_hash_str(5381, path);
+   hash          = (hash << 5) + hash + '\n';
+   return content_playlist_hash_str(hash, core_path);
+}
+
+static bool content_playlist_path_equal(const char *a, const char *b)
+{
+   if (!a || !b)
+      return a == b;
+   return !strcmp(a, b);
+}
+
+static void content_playlist_hash_insert(content_playlist_t *playlist,
+      size_t idx)
+{
+   content_playlist_node_t *node = &playlist->nodes[idx];
+   size_t mask                   = playlist->bucket_count - 1;
+
+   node->hash_next = playlist->buckets[node->hash & mask];
+   playlist->buckets[node->hash & mask] = idx;
+
+   node->path_next = playlist->path_buckets[node->path_hash & mask];
+   playlist->path_buckets[node->path_hash & mask] = idx;
+}
+
+static void content_playlist_hash_remove(content_playlist_t *playlist,
+      size_t idx)
+{
+   size_t *link;
+   content_playlist_node_t *node = &playlist->nodes[idx];
+   size_t mask                   = playlist->bucket_count - 1;
+
+   for (link = &playlist->buckets[node->hash & mask];
+         *link != PLAYLIST_NIL; link = &playlist->nodes[*link].hash_next)
+   {
+      if (*link == idx)
+      {
+         *link = node->hash_next;
+         break;
+      }
+   }
+
+   for (link = &playlist->path_buckets[node->path_hash & mask];
+         *link != PLAYLIST_NIL; link = &playlist->nodes[*link].path_next)
+   {
+      if (*link == idx)
+      {
+         *link = node->path_next;
+         break;
+      }
+   }
+}
+
+static bool content_playlist_rehash(content_playlist_t *playlist,
+      size_t bucket_count)
 {
    size_t i;
-   if (!playlist)
-      return;
+   size_t *buckets      = (size_t*)malloc(bucket_count * sizeof(size_t));
+   size_t *path_buckets = (size_t*)malloc(bucket_count * sizeof(size_t));
+
+   if (!buckets || !path_buckets)
+   {
+      free(buckets);
+      free(path_buckets);
+      return false;
+   }
+
+   for (i = 0; i < bucket_count; i++)
+      buckets[i] = path_buckets[i] = PLAYLIST_NIL;
+
+   free(playlist->buckets);
+   free(playlist->path_buckets);
+   playlist->buckets      = buckets;
+   playlist->path_buckets = path_buckets;
+   playlist->bucket_count = bucket_count;
 
    for (i = 0; i < playlist->size; i++)
+      content_playlist_hash_insert(playlist, i);
+
+   return true;
+}
+
+static void content_playlist_list_unlink(content_playlist_t *playlist,
+      size_t idx)
+{
+   content_playlist_node_t *node = &playlist->nodes[idx];
+
+   if (node->prev != PLAYLIST_NIL)
+      playlist->nodes[node->prev].next = node->next;
+   else
+      playlist->head = node->next;
+
+   if (node->next != PLAYLIST_NIL)
+      playlist->nodes[node->next].prev = node->prev;
+   else
+      playlist->tail = node->prev;
+
+   node->prev = node->next = PLAYLIST_NIL;
+   playlist->order_dirty = true;
+}
+
+static void content_playlist_list_link(content_playlist_t *playlist,
+      size_t idx, bool at_head)
+{
+   content_playlist_node_t *node = &playlist->nodes[idx];
+
+   if (at_head)
    {
-      if (strcmp(playlist->entries[i].path, search_path) != 0)
-         continue;
+      node->prev = PLAYLIST_NIL;
+      node->next = playlist->head;
+      if (playlist->head != PLAYLIST_NIL)
+         playlist->nodes[playlist->head].prev = idx;
+      else
+         playlist->tail = idx;
+      playlist->head = idx;
+   }
+   else
+   {
+      node->next = PLAYLIST_NIL;
+      node->prev = playlist->tail;
+      if (playlist->tail != PLAYLIST_NIL)
+         playlist->nodes[playlist->tail].next = idx;
+      else
+         playlist->head = idx;
+      playlist->tail = idx;
+   }
+
+   playlist->order_dirty = true;
+}
+
+static size_t content_playlist_find(content_playlist_t *playlist,
+      const char *path, const char *core_path, uint32_t hash)
+{
+   size_t idx;
+
+   if (!playlist->bucket_count)
+      return PLAYLIST_NIL;
+
+   for (idx = playlist->buckets[hash & (playlist->bucket_count - 1)];
+         idx != PLAYLIST_NIL; idx = playlist->nodes[idx].hash_next)
+   {
+      content_playlist_node_t *node = &playlist->nodes[idx];
+
+      if (node->hash == hash
+            && content_playlist_path_equal(node->entry.path, path)
+            && !strcmp(node->entry.core_path, core_path))
+         return idx;
+   }
+
+   return PLAYLIST_NIL;
+}
 
-      if (path)
-         *path      = playlist->entries[i].path;
-      if (core_path)
-         *core_path = playlist->entries[i].core_path;
-      if (core_name)
-         *core_name = playlist->entries[i].core_name;
-      break;
+static const content_playlist_node_t *content_playlist_node_at(
+      content_playlist_t *playlist, size_t idx)
+{
+   if (playlist->order_dirty)
+   {
+      size_t i, node;
+
+      for (i = 0, node = playlist->head; node != PLAYLIST_NIL;
+            node = playlist->nodes[node].next)
+         playlist->order[i++] = node;
+
+      playlist->order_dirty = false;
    }
 
+   return &playlist->nodes[playlist->order[idx]];
 }
 
 /**
@@ -99,83 +289,140 @@ static void content_playlist_free_entry(content_playlist_entry_t *entry)
    memset(entry, 0, sizeof(*entry));
 }
 
-/**
- * content_playlist_push:
- * @playlist        	   : Playlist handle.
- * @path                : Path of new playlist entry.
- * @core_path           : Core path of new playlist entry.
- * @core_name           : Core name of new playlist entry.
- *
- * Push entry to top of playlist.
- **/
-void content_playlist_push(content_playlist_t *playlist,
-      const char *path, const char *core_path,
-      const char *core_name)
+static bool content_playlist_reserve(content_playlist_t *playlist)
 {
-   size_t i;
+   size_t alloc;
+   size_t *order;
+   content_playlist_node_t *nodes;
 
-   if (!playlist)
-      return;
+   if (playlist->size < playlist->alloc)
+      return true;
 
-   if (!core_path || !*core_path || !core_name || !*core_name)
+   alloc = playlist->alloc ? playlist->alloc * 2 : 16;
+   if (alloc > playlist->cap)
+      alloc = playlist->cap;
+
+   nodes = (content_playlist_node_t*)realloc(playlist->nodes,
+         alloc * sizeof(*nodes));
+   if (!nodes)
+      return false;
+   playlist->nodes = nodes;
+
+   order = (size_t*)realloc(playlist->order, alloc * sizeof(*order));
+   if (!order)
+      return false;
+   playlist->order = order;
+
+   playlist->alloc       = alloc;
+   playlist->order_dirty = true;
+
+   /* Keep the load factor at or below one. */
+   if (playlist->bucket_count < alloc)
    {
-      RARCH_ERR("cannot push NULL or empty core info into the playlist");
-      return;
+      size_t bucket_count = playlist->bucket_count ? playlist->bucket_count : 16;
+      while (bucket_count < alloc)
+         bucket_count *= 2;
+      return content_playlist_rehash(playlist, bucket_count);
    }
 
-   if (path && !*path)
-      path = NULL;
+   return true;
+}
 
-   for (i = 0; i < playlist->size; i++)
+/* Adds a new entry, evicting the least recently used one when full.
+ * Takes ownership of the strings. */
+static void content_playlist_insert(content_playlist_t *playlist,
+      char *path, char *core_path, char *core_name,
+      uint32_t hash, bool at_head)
+{
+   size_t idx;
+   content_playlist_node_t *node;
+
+   if (playlist->size == playlist->cap)
    {
-      content_playlist_entry_t tmp;
-      bool equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
-          !strcmp(path,playlist->entries[i].path));
-
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!equal_path)
-         continue;
+      /* Reuse the evicted slot so the node array stays dense. */
+      idx = playlist->tail;
+      content_playlist_list_unlink(playlist, idx);
+      content_playlist_hash_remove(playlist, idx);
+      content_playlist_free_entry(&playlist->nodes[idx].entry);
+   }
+   else
+   {
+      if (!content_playlist_reserve(playlist))
+      {
+         free(path);
+         free(core_path);
+         free(core_name);
+         return;
+      }
+      idx = playlist->size++;
+   }
 
-      if (strcmp(playlist->entries[i].core_path, core_path))
-         continue;
+   node                  = &playlist->nodes[idx];
+   node->entry.path      = path;
+   node->entry.core_path = core_path;
+   node->entry.core_name = core_name;
+   node->hash            = hash;
+   node->path_hash       = content_playlist_hash_str(5381, path);
+   node->stamp           = at_head ? ++playlist->stamp
+      : -(int64_t)playlist->size;
+
+   content_playlist_hash_insert(playlist, idx);
+   content_playlist_list_link(playlist, idx, at_head);
+}
+
+/* Returns true if the playlist changed. */
+static bool content_playlist_push_internal(content_playlist_t *playlist,
+      const char *path, const char *core_path,
+      const char *core_name)
+{
+   uint32_t hash = content_playlist_hash(path, core_path);
+   /* Core name can have changed while still being the same core.
+    * Differentiate based on the core path only. */
+   size_t idx    = content_playlist_find(playlist, path, core_path, hash);
 
+   if (idx != PLAYLIST_NIL)
+   {
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
-      if (i == 0)
-         return;
+      if (idx == playlist->head)
+         return false;
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-		      i * sizeof(content_playlist_entry_t));
-      playlist->entries[0] = tmp;
-
-      return;
+      content_playlist_list_unlink(playlist, idx);
+      content_playlist_list_link(playlist, idx, true);
+      playlist->nodes[idx].stamp = ++playlist->stamp;
+      return true;
    }
 
-   if (playlist->size == playlist->cap)
-   {
-      content_playlist_free_entry(&playlist->entries[playlist->cap - 1]);
-      playlist->size--;
-   }
+   content_playlist_insert(playlist,
+         path ? strdup(path) : NULL, strdup(core_path), strdup(core_name),
+         hash, true);
+   return playlist->head != PLAYLIST_NIL;
+}
 
-   memmove(playlist->entries + 1, playlist->entries,
-         (playlist->cap - 1) * sizeof(content_playlist_entry_t));
+static void content_playlist_write_entry(FILE *file,
+      const content_playlist_entry_t *entry)
+{
+   fprintf(file, "%s\n%s\n%s\n",
+         entry->path ? entry->path : "",
+         entry->core_path,
+         entry->core_name);
+}
 
-   playlist->entries[0].path      = path ? strdup(path) : NULL;
-   playlist->entries[0].core_path = strdup(core_path);
-   playlist->entries[0].core_name = strdup(core_name);
-   playlist->size++;
+static FILE *content_playlist_journal(content_playlist_t *playlist)
+{
+   if (!playlist->journal && playlist->journal_path)
+      playlist->journal = fopen(playlist->journal_path, "a");
+   return playlist->journal;
 }
 
+/* Writes a full snapshot and empties the journal. */
 static void content_playlist_write_file(content_playlist_t *playlist)
 {
    size_t i;
    FILE *file = NULL;
 
-   if (!playlist)
+   if (!playlist || !playlist->conf_path || !playlist->loaded)
       return;
 
    file = fopen(playlist->conf_path, "w");
@@ -184,12 +431,243 @@ static void content_playlist_write_file(content_playlist_t *playlist)
       return;
 
    for (i = 0; i < playlist->size; i++)
-      fprintf(file, "%s\n%s\n%s\n",
-            playlist->entries[i].path ? playlist->entries[i].path : "",
-            playlist->entries[i].core_path,
-            playlist->entries[i].core_name);
+      content_playlist_write_entry(file,
+            &content_playlist_node_at(playlist, i)->entry);
+
+   fclose(file);
+
+   if (playlist->journal)
+      fclose(playlist->journal);
+   playlist->journal = NULL;
+
+   if (playlist->journal_path)
+      remove(playlist->journal_path);
+   playlist->journal_records = 0;
+   playlist->appended        = false;
+}
+
+static void content_playlist_journal_push(content_playlist_t *playlist,
+      const content_playlist_entry_t *entry)
+{
+   FILE *journal = content_playlist_journal(playlist);
+
+   if (!journal)
+      return;
+
+   content_playlist_write_entry(journal, entry);
+   fflush(journal);
+   playlist->appended = true;
+
+   if (++playlist->journal_records > playlist->size
+         && playlist->journal_records > PLAYLIST_JOURNAL_MIN_SIZE)
+      content_playlist_write_file(playlist);
+}
+
+static void content_playlist_free_nodes(content_playlist_t *playlist)
+{
+   size_t i;
+
+   for (i = 0; i < playlist->size; i++)
+      content_playlist_free_entry(&playlist->nodes[i].entry);
+
+   for (i = 0; i < playlist->bucket_count; i++)
+      playlist->buckets[i] = playlist->path_buckets[i] = PLAYLIST_NIL;
+
+   playlist->size        = 0;
+   playlist->head        = PLAYLIST_NIL;
+   playlist->tail        = PLAYLIST_NIL;
+   playlist->order_dirty = true;
+}
+
+/* Reads three line records from @path. The snapshot is appended in
+ * file order, the journal is replayed as pushes. */
+static size_t content_playlist_read_records(content_playlist_t *playlist,
+      const char *path, bool replay)
+{
+   char buf[3][1024];
+   unsigned i;
+   size_t records = 0;
+   char *last     = NULL;
+   FILE *file     = fopen(path, "r");
+
+   if (!file)
+      return 0;
+
+   for (;;)
+   {
+      for (i = 0; i < 3; i++)
+      {
+         *buf[i] = '\0';
+
+         if (!fgets(buf[i], sizeof(buf[i]), file))
+            goto end;
+
+         last = strrchr(buf[i], '\n');
+         if (last)
+            *last = '\0';
+      }
+
+      if (!*buf[1] || !*buf[2])
+         continue;
 
+      records++;
+
+      if (replay)
+         content_playlist_push_internal(playlist,
+               *buf[0] ? buf[0] : NULL, buf[1], buf[2]);
+      else
+      {
+         const char *entry_path = *buf[0] ? buf[0] : NULL;
+         uint32_t hash          = content_playlist_hash(entry_path, buf[1]);
+
+         if (playlist->size == playlist->cap)
+            break;
+
+         if (content_playlist_find(playlist, entry_path, buf[1], hash)
+               != PLAYLIST_NIL)
+            continue;
+
+         content_playlist_insert(playlist,
+               entry_path ? strdup(entry_path) : NULL,
+               strdup(buf[1]), strdup(buf[2]), hash, false);
+      }
+   }
+
+end:
    fclose(file);
+   return records;
+}
+
+/* Playlists are only read from disk on first use. */
+static void content_playlist_load(content_playlist_t *playlist)
+{
+   if (playlist->loaded)
+      return;
+
+   playlist->loaded = true;
+
+   /* If playlist file does not exist,
+    * create an empty playlist instead.
+    */
+   if (!playlist->conf_path)
+      return;
+
+   content_playlist_read_records(playlist, playlist->conf_path, false);
+
+   if (playlist->journal_path)
+      playlist->journal_records = content_playlist_read_records(
+            playlist, playlist->journal_path, true);
+}
+
+/**
+ * content_playlist_get_index:
+ * @playlist        	   : Playlist handle.
+ * @idx                 : Index of playlist entry.
+ * @path                : Path of playlist entry.
+ * @core_path           : Core path of playlist entry.
+ * @core_name           : Core name of playlist entry.
+ *
+ * Gets values of playlist index:
+ **/
+void content_playlist_get_index(content_playlist_t *playlist,
+      size_t idx,
+      const char **path, const char **core_path,
+      const char **core_name)
+{
+   const content_playlist_node_t *node = NULL;
+
+   if (!playlist)
+      return;
+
+   content_playlist_load(playlist);
+
+   if (idx >= playlist->size)
+      return;
+
+   node = content_playlist_node_at(playlist, idx);
+
+   if (path)
+      *path      = node->entry.path;
+   if (core_path)
+      *core_path = node->entry.core_path;
+   if (core_name)
+      *core_name = node->entry.core_name;
+}
+
+void content_playlist_get_index_by_path(content_playlist_t *playlist,
+      const char *search_path,
+      char **path, char **core_path,
+      char **core_name)
+{
+   size_t idx;
+   uint32_t hash;
+   content_playlist_node_t *best = NULL;
+
+   if (!playlist)
+      return;
+
+   content_playlist_load(playlist);
+
+   if (!playlist->bucket_count)
+      return;
+
+   /* Several cores can share a path, return the most recent one. */
+   hash = content_playlist_hash_str(5381, search_path);
+
+   for (idx = playlist->path_buckets[hash & (playlist->bucket_count - 1)];
+         idx != PLAYLIST_NIL; idx = playlist->nodes[idx].path_next)
+   {
+      content_playlist_node_t *node = &playlist->nodes[idx];
+
+      if (node->path_hash != hash || !node->entry.path
+            || strcmp(node->entry.path, search_path) != 0)
+         continue;
+
+      if (!best || node->stamp > best->stamp)
+         best = node;
+   }
+
+   if (!best)
+      return;
+
+   if (path)
+      *path      = best->entry.path;
+   if (core_path)
+      *core_path = best->entry.core_path;
+   if (core_name)
+      *core_name = best->entry.core_name;
+}
+
+/**
+ * content_playlist_push:
+ * @playlist        	   : Playlist handle.
+ * @path                : Path of new playlist entry.
+ * @core_path           : Core path of new playlist entry.
+ * @core_name           : Core name of new playlist entry.
+ *
+ * Push entry to top of playlist.
+ **/
+void content_playlist_push(content_playlist_t *playlist,
+      const char *path, const char *core_path,
+      const char *core_name)
+{
+   if (!playlist)
+      return;
+
+   if (!core_path || !*core_path || !core_name || !*core_name)
+   {
+      RARCH_ERR("cannot push NULL or empty core info into the playlist");
+      return;
+   }
+
+   if (path && !*path)
+      path = NULL;
+
+   content_playlist_load(playlist);
+
+   if (content_playlist_push_internal(playlist, path, core_path, core_name))
+      content_playlist_journal_push(playlist,
+            &playlist->nodes[playlist->head].entry);
 }
 
 /**
@@ -200,18 +678,21 @@ static void content_playlist_write_file(content_playlist_t *playlist)
  */
 void content_playlist_free(content_playlist_t *playlist)
 {
-   size_t i;
-
    if (!playlist)
       return;
 
-   if (playlist->conf_path)
+   if (playlist->appended)
       content_playlist_write_file(playlist);
+   if (playlist->journal)
+      fclose(playlist->journal);
    free(playlist->conf_path);
+   free(playlist->journal_path);
 
-   for (i = 0; i < playlist->cap; i++)
-      content_playlist_free_entry(&playlist->entries[i]);
-   free(playlist->entries);
+   content_playlist_free_nodes(playlist);
+   free(playlist->nodes);
+   free(playlist->order);
+   free(playlist->buckets);
+   free(playlist->path_buckets);
 
    free(playlist);
 }
@@ -224,13 +705,12 @@ void content_playlist_free(content_playlist_t *playlist)
  **/
 void content_playlist_clear(content_playlist_t *playlist)
 {
-   size_t i;
    if (!playlist)
       return;
 
-   for (i = 0; i < playlist->cap; i++)
-      content_playlist_free_entry(&playlist->entries[i]);
-   playlist->size = 0;
+   playlist->loaded = true;
+   content_playlist_free_nodes(playlist);
+   content_playlist_write_file(playlist);
 }
 
 /**
@@ -244,53 +724,9 @@ size_t content_playlist_size(content_playlist_t *playlist)
 {
    if (!playlist)
       return 0;
-   return playlist->size;
-}
-
-static bool content_playlist_read_file(
-      content_playlist_t *playlist, const char *path)
-{
-   char buf[3][1024];
-   unsigned i;
-   content_playlist_entry_t *entry = NULL;
-   char *last = NULL;
-   FILE *file = fopen(path, "r");
-
-   /* If playlist file does not exist,
-    * create an empty playlist instead.
-    */
-   if (!file)
-      return true;
-
-   for (playlist->size = 0; playlist->size < playlist->cap; )
-   {
-      for (i = 0; i < 3; i++)
-      {
-         *buf[i] = '\0';
-
-         if (!fgets(buf[i], sizeof(buf[i]), file))
-            goto end;
-
-         last = strrchr(buf[i], '\n');
-         if (last)
-            *last = '\0';
-      }
-
-      entry = &playlist->entries[playlist->size];
 
-      if (!*buf[1] || !*buf[2])
-         continue;
-
-      if (*buf[0])
-         entry->path = strdup(buf[0]);
-      entry->core_path = strdup(buf[1]);
-      entry->core_name = strdup(buf[2]);
-      playlist->size++;
-   }
-
-end:
-   fclose(file);
-   return true;
+   content_playlist_load(playlist);
+   return playlist->size;
 }
 
 /**
@@ -298,27 +734,40 @@ end:
  * @path            	   : Path to playlist contents file.
  * @size                : Maximum capacity of playlist size.
  *
- * Creates and initializes a playlist.
+ * Creates and initializes a playlist. The file is read on first use.
  *
  * Returns: handle to new playlist if successful, otherwise NULL
  **/
 content_playlist_t *content_playlist_init(const char *path, size_t size)
 {
-   content_playlist_t *playlist = (content_playlist_t*)
-      calloc(1, sizeof(*playlist));
+   size_t len;
+   content_playlist_t *playlist = NULL;
+
+   if (!size)
+      return NULL;
+
+   playlist = (content_playlist_t*)calloc(1, sizeof(*playlist));
    if (!playlist)
       return NULL;
 
-   playlist->entries = (content_playlist_entry_t*)calloc(size,
-         sizeof(*playlist->entries));
-   if (!playlist->entries)
-      goto error;
+   playlist->cap  = size;
+   playlist->head = PLAYLIST_NIL;
+   playlist->tail = PLAYLIST_NIL;
+
+   if (!path)
+      return playlist;
 
-   playlist->cap = size;
+   len                    = strlen(path);
+   playlist->conf_path    = strdup(path);
+   playlist->journal_path = (char*)malloc(len + sizeof(PLAYLIST_JOURNAL_EXT));
+
+   if (!playlist->conf_path || !playlist->journal_path)
+      goto error;
 
-   content_playlist_read_file(playlist, path);
+   memcpy(playlist->journal_path, path, len);
+   memcpy(playlist->journal_path + len, PLAYLIST_JOURNAL_EXT,
+         sizeof(PLAYLIST_JOURNAL_EXT));
 
-   playlist->conf_path = strdup(path);
    return playlist;
 
 error:
@@ -31,21 +31,14 @@ typedef struct content_playlist_entry
    char *core_name;
 } content_playlist_entry_t;
 
-typedef struct content_playlist
-{
-   struct content_playlist_entry *entries;
-   size_t size;
-   size_t cap;
-
-   char *conf_path;
-} content_playlist_t;
+typedef struct content_playlist content_playlist_t;
 
 /**
  * content_playlist_init:
  * @path            	   : Path to playlist contents file.
  * @size                : Maximum capacity of playlist size.
  *
- * Creates and initializes a playlist.
+ * Creates and initializes a playlist. The file is read on first use.
  *
  * Returns: handle to new playlist if successful, otherwise NULL
  **/
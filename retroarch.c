@@ -60,6 +60,10 @@
 #include "netplay.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include "emu_thread.h"
+#endif
+
 #ifdef _WIN32
 #ifdef _XBOX
 #include <xtl.h>
@@ -217,6 +221,10 @@ static void print_help(void)
    puts("\t-P/--bsvplay: Playback a BSV movie file.");
    puts("\t-R/--bsvrecord: Start recording a BSV movie file from the beginning.");
    puts("\t--eof-exit: Exit upon reaching the end of the BSV movie file.");
+   puts("\t--startup-trace: Write the time spent in each startup phase to a Chrome trace (JSON) file.");
+   puts("\t--benchmark: Run the given number of frames as fast as possible with null drivers, then print frames/s and a per-stage breakdown.");
+   puts("\t\tCombine with -P/--bsvplay for deterministic input.");
+   puts("\t--perf-trace: Record a per-thread timeline of all performance counters and write it to a Chrome trace (JSON) file on exit.");
    puts("\t-M/--sram-mode: Takes an argument telling how SRAM should be handled in the session.");
    puts("\t\t{no,}load-{no,}save describes if SRAM should be loaded, and if SRAM should be saved.");
    puts("\t\tDo note that noload-save implies that save files will be deleted and overwritten.");
@@ -416,6 +424,9 @@ static void parse_input(int argc, char *argv[])
    *global->bps_name                     = '\0';
    *global->ips_name                     = '\0';
    *global->subsystem                    = '\0';
+   *global->startup_trace_path           = '\0';
+   *global->perf_trace_path              = '\0';
+   global->benchmark.frames              = 0;
    
    global->overrides_active              = false; 
 
@@ -471,6 +482,9 @@ static void parse_input(int argc, char *argv[])
       { "subsystem", 1, NULL, 'Z' },
       { "max-frames", 1, NULL, 'm' },
       { "eof-exit", 0, &val, 'e' },
+      { "startup-trace", 1, &val, 'T' },
+      { "perf-trace", 1, &val, 't' },
+      { "benchmark", 1, &val, 'b' },
       { NULL, 0, NULL, 0 }
    };
 
@@ -757,6 +771,27 @@ static void parse_input(int argc, char *argv[])
                   global->bsv.eof_exit = true;
                   break;
 
+               case 'T':
+                  strlcpy(global->startup_trace_path, optarg,
+                        sizeof(global->startup_trace_path));
+                  break;
+
+               case 't':
+                  strlcpy(global->perf_trace_path, optarg,
+                        sizeof(global->perf_trace_path));
+                  break;
+
+               case 'b':
+                  global->benchmark.frames  = strtoul(optarg, NULL, 10);
+                  if (!global->benchmark.frames)
+                  {
+                     RARCH_ERR("--benchmark needs a frame count above zero.\n");
+                     print_help();
+                     rarch_fail(1, "parse_input()");
+                  }
+                  runloop->frames.video.max = global->benchmark.frames;
+                  break;
+
                default:
                   break;
             }
@@ -1738,6 +1773,7 @@ void rarch_main_free(void)
    rarch_main_command(RARCH_CMD_MSG_QUEUE_DEINIT);
    rarch_main_command(RARCH_CMD_LOG_FILE_DEINIT);
    rarch_main_command(RARCH_CMD_DRIVERS_DEINIT);
+   rarch_perf_deinit();
 
    rarch_main_state_free();
    rarch_main_global_free();
@@ -1893,8 +1929,50 @@ static bool init_content(void)
    return true;
 }
 
+/**
+ * init_benchmark:
+ *
+ * Overrides the loaded config for a --benchmark run: null
+ * drivers, no throttling of any kind, and nothing that would
+ * write to disk on exit or make runs differ from each other.
+ * Run-ahead and the emulation thread are turned off as well,
+ * so one frame is one retro_run on the main thread and the
+ * per-stage timings stay comparable across configs.
+ *
+ * Applied before the drivers are picked, and again after a
+ * core or game override has reloaded the config.
+ **/
+static void init_benchmark(void)
+{
+   settings_t *settings = config_get_ptr();
+   global_t   *global   = global_get_ptr();
+
+   strlcpy(settings->video.driver, "null", sizeof(settings->video.driver));
+   strlcpy(settings->audio.driver, "null", sizeof(settings->audio.driver));
+   strlcpy(settings->input.driver, "null", sizeof(settings->input.driver));
+   strlcpy(settings->input.joypad_driver, "null",
+         sizeof(settings->input.joypad_driver));
+
+   settings->video.vsync                       = false;
+   settings->video.threaded                    = false;
+   settings->video.frame_delay                 = 0;
+   settings->video.frame_delay_auto            = false;
+   settings->audio.sync                        = false;
+   settings->fastforward_ratio_throttle_enable = false;
+   settings->savestate_auto_load               = false;
+   settings->savestate_auto_save               = false;
+   settings->config_save_on_exit               = false;
+   settings->run_ahead_frames                  = 0;
+   settings->emulation_threaded                = false;
+
+   global->sram_load_disable                   = true;
+   global->sram_save_disable                   = true;
+   global->perfcnt_enable                      = true;
+}
+
 static bool init_core(void)
 {
+   bool ret;
    driver_t *driver = driver_get_ptr();
    global_t *global = global_get_ptr();   
    
@@ -1903,17 +1981,28 @@ static bool init_core(void)
    else
       global->overrides_active = false; 
 
+   /* An override reloads the whole config, benchmark or not. */
+   if (global->overrides_active && global->benchmark.frames)
+      init_benchmark();
+
    pretro_set_environment(rarch_environment_cb);  
   
    config_load_remap();
 
    verify_api_version();
+
+   rarch_startup_phase_begin("retro_init");
    pretro_init();
+   rarch_startup_phase_end();
 
    global->use_sram = !global->libretro_dummy &&
       !global->libretro_no_content;
 
-   if (!init_content())
+   rarch_startup_phase_begin("init_content");
+   ret = init_content();
+   rarch_startup_phase_end();
+
+   if (!ret)
       return false;
 
    retro_init_libretro_cbs(&driver->retro_ctx);
@@ -1922,6 +2011,62 @@ static bool init_core(void)
    return true;
 }
 
+/**
+ * rarch_benchmark_report:
+ *
+ * Prints throughput and per-stage timings of a --benchmark
+ * run to stdout, independent of the log verbosity.
+ **/
+void rarch_benchmark_report(void)
+{
+   unsigned i;
+   double secs;
+   struct rarch_perf_percentiles pct;
+   runloop_t *runloop = rarch_main_get_ptr();
+   global_t  *global  = global_get_ptr();
+   uint64_t frames    = runloop->frames.video.count;
+
+   if (!global->benchmark.frames || !global->benchmark.start)
+      return;
+
+   secs = (rarch_get_time_usec() - global->benchmark.start) / 1000000.0;
+
+   printf("Benchmark: %llu frames in %.3f s, %.2f frames/s.\n",
+         (unsigned long long)frames, secs, secs > 0.0 ? frames / secs : 0.0);
+
+   if (rarch_perf_get_frame_time_percentiles(&pct))
+      printf("Frame time: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms.\n",
+            pct.p50 / 1000.0, pct.p95 / 1000.0,
+            pct.p99 / 1000.0, pct.max / 1000.0);
+
+   printf("%-24s %10s %14s %14s %14s\n",
+         "Stage", "Runs", "Ticks/run", "p99", "Ticks/frame");
+
+   for (i = 0; i < perf_ptr_rarch; i++)
+   {
+      retro_perf_tick_t total;
+      uint64_t call_cnt;
+      const struct retro_perf_counter *counter = perf_counters_rarch[i];
+
+      rarch_perf_get_totals(counter, &total, &call_cnt);
+      if (!call_cnt)
+         continue;
+
+      if (!rarch_perf_get_percentiles(counter, &pct))
+         pct.p99 = 0;
+
+      printf("%-24s %10llu %14llu %14llu %14llu\n",
+            counter->ident,
+            (unsigned long long)call_cnt,
+            (unsigned long long)(total / call_cnt),
+            (unsigned long long)pct.p99,
+            (unsigned long long)(frames ? total / frames : 0));
+   }
+
+   fflush(stdout);
+   global->benchmark.start = 0;
+}
+
 /**
  * rarch_main_init:
  * @argc                 : Count of (commandline) arguments.
@@ -1936,15 +2081,23 @@ int rarch_main_init(int argc, char *argv[])
    int sjlj_ret;
    global_t *global = global_get_ptr();
 
+   rarch_perf_init();
+   rarch_startup_trace_init();
    init_state();
 
    if ((sjlj_ret = setjmp(global->error_sjlj_context)) > 0)
    {
       RARCH_ERR("Fatal error received in: \"%s\"\n", global->error_string);
+      rarch_startup_trace_finish(global->startup_trace_path);
       return sjlj_ret;
    }
    global->error_in_init = true;
+
+   rarch_startup_phase_begin("parse_input");
    parse_input(argc, argv);
+   rarch_startup_phase_end();
+
+   rarch_perf_trace_init(global->perf_trace_path);
 
    if (global->verbosity)
    {
@@ -1958,17 +2111,37 @@ int rarch_main_init(int argc, char *argv[])
    }
 
    validate_cpu_features();
+
+   rarch_startup_phase_begin("config_load");
    config_load();
+   rarch_startup_phase_end();
 
+   if (global->benchmark.frames)
+   {
+      init_benchmark();
+      RARCH_LOG("Benchmarking %u frames with null drivers.\n",
+            global->benchmark.frames);
+   }
+
+   rarch_startup_phase_begin("init_libretro_sym");
    init_libretro_sym(global->libretro_dummy);
    init_system_info();
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("init_drivers_pre");
    init_drivers_pre();
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("core_init");
    if (!rarch_main_command(RARCH_CMD_CORE_INIT))
       goto error;
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("drivers_init");
    rarch_main_command(RARCH_CMD_DRIVERS_INIT);
+   rarch_startup_phase_end();
+
+   rarch_startup_phase_begin("subsystems_init");
    rarch_main_command(RARCH_CMD_COMMAND_INIT);
    rarch_main_command(RARCH_CMD_REWIND_INIT);
    rarch_main_command(RARCH_CMD_CONTROLLERS_INIT);
@@ -1977,6 +2150,7 @@ int rarch_main_init(int argc, char *argv[])
    rarch_main_command(RARCH_CMD_REMAPPING_INIT);
 
    rarch_main_command(RARCH_CMD_SAVEFILES_INIT);
+   rarch_startup_phase_end();
 #if defined(GEKKO) && defined(HW_RVL)
    {
       settings_t *settings = config_get_ptr();
@@ -1991,9 +2165,14 @@ int rarch_main_init(int argc, char *argv[])
 
    global->error_in_init = false;
    global->main_is_init  = true;
+   rarch_startup_trace_finish(global->startup_trace_path);
+
+   if (global->benchmark.frames)
+      global->benchmark.start = rarch_get_time_usec();
    return 0;
 
 error:
+   rarch_startup_trace_finish(global->startup_trace_path);
    rarch_main_command(RARCH_CMD_CORE_DEINIT);
 
    global->main_is_init = false;
@@ -2483,6 +2662,22 @@ bool rarch_main_command(unsigned cmd)
          else
             rarch_main_command(RARCH_CMD_REWIND_DEINIT);
          break;
+      case RARCH_CMD_RUNAHEAD_DEINIT:
+         if (!global)
+            break;
+         if (global->runahead.state)
+            free(global->runahead.state);
+         global->runahead.state       = NULL;
+         global->runahead.size        = 0;
+         global->runahead.cost        = 0;
+         global->runahead.slow_frames = 0;
+         global->runahead.disabled    = false;
+         break;
+      case RARCH_CMD_EMU_THREAD_DEINIT:
+#ifdef HAVE_THREADS
+         rarch_emu_thread_deinit();
+#endif
+         break;
       case RARCH_CMD_AUTOSAVE_DEINIT:
 #ifdef HAVE_THREADS
          deinit_autosave();
@@ -2631,7 +2826,11 @@ bool rarch_main_command(unsigned cmd)
          rarch_main_command(RARCH_CMD_CORE_INFO_DEINIT);
 
          if (*settings->libretro_directory)
+         {
+            rarch_startup_phase_begin("core_info_list_new");
             global->core_info = core_info_list_new(settings->libretro_directory);
+            rarch_startup_phase_end();
+         }
          break;
       case RARCH_CMD_CORE_DEINIT:
          deinit_core(true);
@@ -2978,6 +3177,11 @@ bool rarch_main_command(unsigned cmd)
          break;
       case RARCH_CMD_PERFCNT_REPORT_FRONTEND_LOG:
          rarch_perf_log();
+         if (settings->video.frame_delay_auto)
+            RARCH_LOG("[PERF]: Automatic frame delay: %.2f ms, %u missed VSyncs.\n",
+                  runloop->frames.delay.delay / 1000.0,
+                  runloop->frames.delay.misses);
+         rarch_perf_trace_deinit();
          break;
       case RARCH_CMD_VOLUME_UP:
          set_volume(0.5f);
@@ -2999,6 +3203,7 @@ void rarch_main_deinit(void)
 {
    global_t *global = global_get_ptr();
 
+   rarch_main_command(RARCH_CMD_EMU_THREAD_DEINIT);
    rarch_main_command(RARCH_CMD_NETPLAY_DEINIT);
    rarch_main_command(RARCH_CMD_COMMAND_DEINIT);
 
@@ -3009,6 +3214,7 @@ void rarch_main_deinit(void)
    rarch_main_command(RARCH_CMD_SAVEFILES);
 
    rarch_main_command(RARCH_CMD_REWIND_DEINIT);
+   rarch_main_command(RARCH_CMD_RUNAHEAD_DEINIT);
    rarch_main_command(RARCH_CMD_CHEATS_DEINIT);
    rarch_main_command(RARCH_CMD_BSV_MOVIE_DEINIT);
 
@@ -53,6 +53,10 @@ enum basic_event
    RARCH_CMD_REWIND_INIT,
    /* Toggles rewind. */
    RARCH_CMD_REWIND_TOGGLE,
+   /* Deinitializes run-ahead. */
+   RARCH_CMD_RUNAHEAD_DEINIT,
+   /* Stops the emulation thread. */
+   RARCH_CMD_EMU_THREAD_DEINIT,
    /* Deinitializes autosave. */
    RARCH_CMD_AUTOSAVE_DEINIT,
    /* Initializes autosave. */
@@ -304,6 +308,13 @@ void rarch_main_init_wrap(const struct rarch_main_wrap *args,
  **/
 void rarch_main_deinit(void);
 
+/**
+ * rarch_benchmark_report:
+ *
+ * Prints throughput and per-stage timings of a --benchmark run.
+ **/
+void rarch_benchmark_report(void);
+
 /**
  * rarch_render_cached_frame:
  *
@@ -26,6 +26,9 @@
 #include "runloop.h"
 #include "runloop_data.h"
 #include "input/keyboard_line.h"
+#ifdef HAVE_THREADS
+#include "emu_thread.h"
+#endif
 
 #ifdef HAVE_MENU
 #include "menu/menu.h"
@@ -667,7 +670,7 @@ static void rarch_update_frame_time(void)
 static void rarch_limit_frame_time(void)
 {
    retro_time_t target      = 0;
-   retro_time_t to_sleep_ms = 0;
+   retro_time_t woke        = 0;
    runloop_t *runloop       = rarch_main_get_ptr();
    settings_t *settings     = config_get_ptr();
    global_t  *global        = global_get_ptr();
@@ -680,19 +683,28 @@ static void rarch_limit_frame_time(void)
 
    target        = runloop->frames.limit.last_time + 
                    runloop->frames.limit.minimum_time;
-   to_sleep_ms   = (target - current) / 1000;
 
-   if (to_sleep_ms <= 0)
+   if (target <= current)
    {
-      runloop->frames.limit.last_time = rarch_get_time_usec();
+      /* Late. Catch up on the schedule after a short hiccup,
+       * start a new one after a long stall. */
+      if (current - target > runloop->frames.limit.minimum_time)
+         target = current;
+      runloop->frames.limit.last_time = target;
+      runloop->frames.limit.last_wake = 0;
       return;
    }
 
-   rarch_sleep((unsigned int)to_sleep_ms);
+   woke = rarch_sleep_until(target);
+
+   if (runloop->frames.limit.last_wake)
+      rarch_perf_frame_limit_error_add(woke - runloop->frames.limit.last_wake
+            - runloop->frames.limit.minimum_time);
 
-   /* Combat jitter a bit. */
-   runloop->frames.limit.last_time += 
-      runloop->frames.limit.minimum_time;
+   /* Next deadline follows from this one, not from when we
+    * woke, so wakeup latency doesn't accumulate as drift. */
+   runloop->frames.limit.last_time = target;
+   runloop->frames.limit.last_wake = woke;
 }
 
 /**
@@ -844,6 +856,8 @@ static int rarch_main_iterate_quit(void)
    settings_t *settings     = config_get_ptr();
    global_t   *global       = global_get_ptr();
 
+   rarch_main_command(RARCH_CMD_EMU_THREAD_DEINIT);
+
    if (global->core_shutdown_initiated
          && settings->load_dummy_on_core_shutdown)
    {
@@ -1064,6 +1078,447 @@ static void rarch_main_cmd_get_state(rarch_cmd_state_t *cmd,
          RARCH_CHEAT_TOGGLE);
 }
 
+/**
+ * rarch_main_runahead_available:
+ *
+ * Checks whether this frame can be run with run-ahead.
+ *
+ * Returns: true (1) if run-ahead should be used, otherwise false (0).
+ **/
+static bool rarch_main_runahead_available(void)
+{
+   driver_t *driver     = driver_get_ptr();
+   settings_t *settings = config_get_ptr();
+   global_t   *global   = global_get_ptr();
+
+   if (!settings->run_ahead_frames || global->runahead.disabled)
+      return false;
+
+   /* Fast-forward doesn't care about latency; movies and
+    * netplay need every input read exactly once; rewind
+    * is already rolling the core back. */
+   if (driver->nonblock_state || global->bsv.movie
+         || global->rewind.frame_is_reverse
+         || global->system.audio_callback.callback)
+      return false;
+#ifdef HAVE_NETPLAY
+   if (driver->netplay_data)
+      return false;
+#endif
+
+   return true;
+}
+
+/**
+ * rarch_main_runahead_disable:
+ * @msg                : reason, shown to the user.
+ *
+ * Turns run-ahead off until the core is unloaded.
+ **/
+static void rarch_main_runahead_disable(const char *msg)
+{
+   global_t *global = global_get_ptr();
+
+   global->runahead.disabled = true;
+   RARCH_WARN("%s\n", msg);
+   rarch_main_msg_queue_push(msg, 1, 180, false);
+}
+
+/**
+ * rarch_main_runahead_check_cost:
+ * @cost               : time the core took for this shown frame, in usec.
+ *
+ * Turns run-ahead off when it keeps the core from running
+ * at full speed. Short spikes are tolerated, a frame time
+ * that stays over budget for about a second is not.
+ **/
+static void rarch_main_runahead_check_cost(retro_time_t cost)
+{
+   retro_time_t budget;
+   global_t *global = global_get_ptr();
+   double fps       = global->system.av_info.timing.fps;
+
+   if (fps <= 0.0)
+      fps = 60.0;
+   budget = (retro_time_t)(1000000.0 / fps);
+
+   if (!global->runahead.cost)
+      global->runahead.cost = cost;
+   global->runahead.cost += (cost - global->runahead.cost) / 16;
+
+   /* Leave some of the frame for the frontend to present it. */
+   if (global->runahead.cost * 10 < budget * 9)
+   {
+      global->runahead.slow_frames = 0;
+      return;
+   }
+
+   if (++global->runahead.slow_frames < (unsigned)fps)
+      return;
+
+   {
+      char msg[PATH_MAX_LENGTH];
+      snprintf(msg, sizeof(msg),
+            "Run-ahead disabled, the core needs %.2f ms of the %.2f ms frame.",
+            global->runahead.cost / 1000.0, budget / 1000.0);
+      rarch_main_runahead_disable(msg);
+   }
+}
+
+/**
+ * rarch_main_fastforward_skip:
+ *
+ * Decides whether fast forward shows the frame about to
+ * be run, see fastforward_frameskip. Frames are never
+ * skipped while recording.
+ *
+ * Returns: true (1) if the frame should skip video and audio
+ * processing, otherwise false (0).
+ **/
+static bool rarch_main_fastforward_skip(void)
+{
+   retro_time_t now, period;
+   runloop_t *runloop   = rarch_main_get_ptr();
+   driver_t *driver     = driver_get_ptr();
+   settings_t *settings = config_get_ptr();
+   float refresh_rate   = settings->video.refresh_rate;
+
+   if (!driver->nonblock_state || driver->recording_data
+         || settings->fastforward_frameskip == 1)
+   {
+      runloop->frames.fastforward.count = 0;
+      runloop->frames.fastforward.last  = 0;
+      return false;
+   }
+
+   if (settings->fastforward_frameskip)
+      return (runloop->frames.fastforward.count++ 
+            % settings->fastforward_frameskip) != 0;
+
+   if (refresh_rate <= 0.0f)
+      refresh_rate = 60.0f;
+
+   now    = rarch_get_time_usec();
+   period = (retro_time_t)(1000000.0f / refresh_rate);
+
+   if (now - runloop->frames.fastforward.last < period)
+      return true;
+
+   runloop->frames.fastforward.last = now;
+   return false;
+}
+
+/**
+ * rarch_main_run_core:
+ *
+ * Runs libretro for one frame.
+ *
+ * With run-ahead, the frame is run with its video dropped,
+ * the state is saved, and the core is run further ahead
+ * with the same input, output dropped except for the video
+ * of the last frame. That frame is shown and the saved
+ * state restored, so the core appears to react to input
+ * run_ahead_frames frames earlier than it does.
+ **/
+static void rarch_main_run_core(void)
+{
+   unsigned i;
+   size_t size          = 0;
+   retro_time_t start   = 0;
+   bool runahead        = rarch_main_runahead_available();
+   settings_t *settings = config_get_ptr();
+   global_t   *global   = global_get_ptr();
+
+   if (runahead)
+   {
+      start = rarch_get_time_usec();
+      size  = pretro_serialize_size();
+
+      if (!size)
+      {
+         rarch_main_runahead_disable(
+               "Run-ahead disabled, core does not support save states.");
+         runahead = false;
+      }
+      else if (size != global->runahead.size)
+      {
+         void *state = realloc(global->runahead.state, size);
+
+         if (state)
+         {
+            global->runahead.state = state;
+            global->runahead.size  = size;
+         }
+         else
+         {
+            rarch_main_runahead_disable(
+                  "Run-ahead disabled, out of memory for its state buffer.");
+            runahead = false;
+         }
+      }
+   }
+
+   if (runahead)
+      retro_set_runahead_callbacks(false, true);
+
+   {
+      RARCH_PERFORMANCE_INIT(retro_run);
+      RARCH_PERFORMANCE_START(retro_run);
+      pretro_run();
+      RARCH_PERFORMANCE_STOP(retro_run);
+   }
+
+   if (!runahead)
+      return;
+
+   {
+      RARCH_PERFORMANCE_INIT(run_ahead);
+      RARCH_PERFORMANCE_START(run_ahead);
+
+      if (!pretro_serialize(global->runahead.state, size))
+      {
+         retro_set_runahead_callbacks(true, true);
+         RARCH_PERFORMANCE_STOP(run_ahead);
+         rarch_main_runahead_disable(
+               "Run-ahead disabled, core failed to save state.");
+         return;
+      }
+
+      for (i = 1; i <= settings->run_ahead_frames; i++)
+      {
+         retro_set_runahead_callbacks(i == settings->run_ahead_frames, false);
+         pretro_run();
+      }
+
+      retro_set_runahead_callbacks(true, true);
+
+      if (!pretro_unserialize(global->runahead.state, size))
+         rarch_main_runahead_disable(
+               "Run-ahead disabled, core failed to load state.");
+
+      RARCH_PERFORMANCE_STOP(run_ahead);
+   }
+
+   rarch_main_runahead_check_cost(rarch_get_time_usec() - start);
+}
+
+/* Samples needed before the automatic frame delay kicks in. */
+#define FRAME_DELAY_MIN_SAMPLES 16
+
+/**
+ * rarch_frame_delay_work_high:
+ * @runloop            : runloop state.
+ *
+ * Returns: the 95th percentile of the recent core work times.
+ **/
+static retro_time_t rarch_frame_delay_work_high(const runloop_t *runloop)
+{
+   unsigned i, j;
+   retro_time_t sorted[ARRAY_SIZE(runloop->frames.delay.work)];
+   unsigned count = runloop->frames.delay.work_count;
+
+   if (count > ARRAY_SIZE(sorted))
+      count = ARRAY_SIZE(sorted);
+
+   /* Insertion sort, there are at most 64. */
+   for (i = 0; i < count; i++)
+   {
+      retro_time_t v = runloop->frames.delay.work[i];
+      for (j = i; j > 0 && sorted[j - 1] > v; j--)
+         sorted[j] = sorted[j - 1];
+      sorted[j] = v;
+   }
+
+   return sorted[(count * 95) / 100];
+}
+
+/**
+ * rarch_frame_delay_auto:
+ * @now                : time the frame is started.
+ * @max_delay          : upper bound for the delay, in usec.
+ *
+ * Picks the frame delay from the recent time the core took
+ * between being started and handing its frame over for
+ * presentation. The delay leaves room for the high end of
+ * that, plus a margin for presenting it. It drops at once
+ * when the core got slower, and halves on a missed VSync,
+ * after which it stays put for a second. Otherwise it
+ * grows back slowly.
+ *
+ * Returns: the delay to apply to this frame, in usec.
+ **/
+static retro_time_t rarch_frame_delay_auto(retro_time_t now,
+      retro_time_t max_delay)
+{
+   retro_time_t period, margin, target;
+   runloop_t *runloop   = rarch_main_get_ptr();
+   settings_t *settings = config_get_ptr();
+   float refresh_rate   = settings->video.refresh_rate;
+
+   if (refresh_rate <= 0.0f)
+      refresh_rate = 60.0f;
+
+   period = (retro_time_t)(1000000.0f / refresh_rate);
+   margin = period / 16 > 1000 ? period / 16 : 1000;
+
+   if (max_delay > period * 3 / 4)
+      max_delay = period * 3 / 4;
+
+   if (runloop->frames.delay.present > runloop->frames.delay.wake
+         && runloop->frames.delay.wake)
+   {
+      runloop->frames.delay.work[runloop->frames.delay.work_count
+         % ARRAY_SIZE(runloop->frames.delay.work)] =
+         runloop->frames.delay.present - runloop->frames.delay.wake;
+      runloop->frames.delay.work_count++;
+   }
+
+   if (runloop->frames.delay.last)
+   {
+      retro_time_t interval = now - runloop->frames.delay.last;
+
+      /* Anything much longer is a stall, not a missed VSync. */
+      if (interval > period * 3 / 2 && interval < period * 4)
+      {
+         runloop->frames.delay.misses++;
+         runloop->frames.delay.delay /= 2;
+         runloop->frames.delay.hold   = (unsigned)refresh_rate;
+      }
+   }
+   runloop->frames.delay.last = now;
+
+   if (runloop->frames.delay.work_count >= FRAME_DELAY_MIN_SAMPLES)
+   {
+      target = period - margin - rarch_frame_delay_work_high(runloop);
+
+      if (target < 0)
+         target = 0;
+      if (target > max_delay)
+         target = max_delay;
+
+      if (target < runloop->frames.delay.delay)
+         runloop->frames.delay.delay = target;
+      else if (!runloop->frames.delay.hold)
+      {
+         /* Creep up, a quarter millisecond per frame. */
+         runloop->frames.delay.delay += target - runloop->frames.delay.delay > 250
+            ? 250 : target - runloop->frames.delay.delay;
+      }
+   }
+
+   if (runloop->frames.delay.hold)
+      runloop->frames.delay.hold--;
+
+   rarch_perf_trace_counter("frame_delay_us",
+         (unsigned)runloop->frames.delay.delay);
+   rarch_perf_trace_counter("frame_delay_misses",
+         runloop->frames.delay.misses);
+
+   return runloop->frames.delay.delay;
+}
+
+/**
+ * rarch_frame_delay:
+ * @emu_threaded       : the frame runs on the emulation thread.
+ *
+ * Waits the frame delay, a fixed one or the automatic one,
+ * before the core is run so it reads input as late as
+ * possible before VSync.
+ **/
+static void rarch_frame_delay(bool emu_threaded)
+{
+   retro_time_t delay   = 0;
+   retro_time_t now     = 0;
+   runloop_t *runloop   = rarch_main_get_ptr();
+   driver_t *driver     = driver_get_ptr();
+   settings_t *settings = config_get_ptr();
+
+   if (driver->nonblock_state)
+   {
+      runloop->frames.delay.last = 0;
+      return;
+   }
+
+   if (!settings->video.frame_delay_auto && !settings->video.frame_delay)
+      return;
+
+   /* The emulation thread presents the previous frame while
+    * the core runs, so present - wake no longer times the
+    * core. Start over once it runs in place again. */
+   if (settings->video.frame_delay_auto && emu_threaded)
+   {
+      runloop->frames.delay.delay      = 0;
+      runloop->frames.delay.last       = 0;
+      runloop->frames.delay.wake       = 0;
+      runloop->frames.delay.work_count = 0;
+      return;
+   }
+
+   now = rarch_get_time_usec();
+
+   if (settings->video.frame_delay_auto)
+      delay = rarch_frame_delay_auto(now, settings->video.frame_delay
+            ? settings->video.frame_delay * 1000 : 15000);
+   else
+      delay = settings->video.frame_delay * 1000;
+
+   runloop->frames.delay.wake = delay > 0 ? rarch_sleep_until(now + delay) : now;
+}
+
+/**
+ * rarch_main_emu_threaded:
+ *
+ * Checks whether this frame can be run on the emulation
+ * thread, starting or stopping it as needed. Frames that
+ * have to run in place, as movies, netplay, rewind and
+ * run-ahead need, first wait for the emulation thread.
+ *
+ * Returns: true (1) if the frame should be run on the emulation
+ * thread, otherwise false (0).
+ **/
+static bool rarch_main_emu_threaded(void)
+{
+#ifdef HAVE_THREADS
+   driver_t *driver     = driver_get_ptr();
+   settings_t *settings = config_get_ptr();
+   global_t   *global   = global_get_ptr();
+
+   (void)driver;
+
+   if (!settings->emulation_threaded)
+   {
+      rarch_emu_thread_deinit();
+      return false;
+   }
+
+   /* Hardware rendered and threaded audio cores need their
+    * callbacks on the thread they were set up from. Keyboard
+    * callbacks are fired by the video driver's event pump,
+    * which would call into the core while it runs elsewhere. */
+   if (global->bsv.movie || global->rewind.frame_is_reverse
+         || global->system.key_event
+         || global->system.audio_callback.callback
+         || global->system.hw_render_callback.context_type
+         != RETRO_HW_CONTEXT_NONE
+         || rarch_main_runahead_available())
+      goto in_place;
+#ifdef HAVE_NETPLAY
+   if (driver->netplay_data)
+      goto in_place;
+#endif
+
+   if (rarch_emu_thread_init())
+      return true;
+
+   RARCH_ERR("Failed to start emulation thread, running the core in place.\n");
+   settings->emulation_threaded = false;
+
+in_place:
+   rarch_emu_thread_flush();
+#endif
+   return false;
+}
+
 /**
  * rarch_main_iterate:
  *
@@ -1079,7 +1534,9 @@ int rarch_main_iterate(void)
    rarch_cmd_state_t    cmd        = {0};
    runloop_t *runloop              = rarch_main_get_ptr();
    int ret                         = 0;
+   bool emu_threaded               = false;
    static retro_input_t last_input = 0;
+   static retro_time_t frame_start = 0;
    retro_input_t old_input         = last_input;
    retro_input_t input             = input_keys_pressed();
    last_input                      = input;
@@ -1097,6 +1554,13 @@ int rarch_main_iterate(void)
    if (time_to_exit(&cmd))
       return rarch_main_iterate_quit();
 
+   /* Runs while the emulation thread may still be busy. */
+   rarch_main_data_iterate();
+
+#ifdef HAVE_THREADS
+   rarch_emu_thread_sync();
+#endif
+
    if (global->system.frame_time.callback)
       rarch_update_frame_time();
 
@@ -1105,8 +1569,6 @@ int rarch_main_iterate(void)
 #ifdef HAVE_OVERLAY
    rarch_main_iterate_linefeed_overlay();
 #endif
-   
-   rarch_main_data_iterate();
 
 #ifdef HAVE_MENU
    if (runloop->is_menu)
@@ -1118,6 +1580,8 @@ int rarch_main_iterate(void)
 
       if (!input && settings->menu.pause_libretro)
         ret = 1;
+      frame_start = 0;
+      runloop->frames.delay.last = 0;
       goto success;
    }
 #endif
@@ -1133,12 +1597,18 @@ int rarch_main_iterate(void)
       /* RetroArch has been paused */
       driver->retro_ctx.poll_cb();
       rarch_sleep(10);
+      frame_start = 0;
+      runloop->frames.delay.last = 0;
 
       return 1;
    }
 
+   emu_threaded = rarch_main_emu_threaded();
+
 #if defined(HAVE_THREADS)
-   lock_autosave();
+   /* The emulation thread locks around the core itself. */
+   if (!emu_threaded)
+      lock_autosave();
 #endif
 
 #ifdef HAVE_NETPLAY
@@ -1164,12 +1634,29 @@ int rarch_main_iterate(void)
             settings->input.analog_dpad_mode[i]);
    }
 
-   if ((settings->video.frame_delay > 0) && !driver->nonblock_state)
-      rarch_sleep(settings->video.frame_delay);
+   rarch_frame_delay(emu_threaded);
 
 
+   if (global->perfcnt_enable)
+   {
+      /* Frame-to-frame time, gaps from menu or pause excluded. */
+      retro_time_t now = rarch_get_time_usec();
+      if (frame_start)
+         rarch_perf_frame_time_add(now - frame_start);
+      frame_start = now;
+   }
+
    /* Run libretro for one frame. */
-   pretro_run();
+#ifdef HAVE_THREADS
+   if (emu_threaded)
+      rarch_emu_thread_run(rarch_main_fastforward_skip());
+   else
+#endif
+   {
+      runloop->frames.fastforward.skip = rarch_main_fastforward_skip();
+      rarch_main_run_core();
+      runloop->frames.fastforward.skip = false;
+   }
 
    for (i = 0; i < settings->input.max_users; i++)
    {
@@ -1189,12 +1676,17 @@ int rarch_main_iterate(void)
 #endif
 
 #if defined(HAVE_THREADS)
-   unlock_autosave();
+   if (!emu_threaded)
+      unlock_autosave();
 #endif
 
 success:
    if (settings->fastforward_ratio_throttle_enable)
+   {
+      rarch_perf_trace_begin("limit_frame_time");
       rarch_limit_frame_time();
+      rarch_perf_trace_end("limit_frame_time");
+   }
 
    return ret;
 }
@@ -85,8 +85,39 @@ typedef struct runloop
       struct
       {
          retro_time_t minimum_time;
+         /* Deadline of the previous frame. */
          retro_time_t last_time;
+         /* When the limiter actually released the previous
+          * frame, 0 if it didn't wait. */
+         retro_time_t last_wake;
       } limit;
+
+      struct
+      {
+         /* Current automatic frame delay, in usec. */
+         retro_time_t delay;
+         unsigned misses;
+         /* Frames left before the delay may grow again. */
+         unsigned hold;
+         /* When the previous frame was started, 0 after a gap. */
+         retro_time_t last;
+         /* When the core was last started after the delay,
+          * and when it then handed its frame to the video driver. */
+         retro_time_t wake;
+         retro_time_t present;
+         /* Recent time from wake to present, in usec. */
+         retro_time_t work[64];
+         unsigned work_count;
+      } delay;
+
+      struct
+      {
+         /* Set while running a frame fast forward doesn't show. */
+         bool skip;
+         unsigned count;
+         /* When the last fast forward frame was shown. */
+         retro_time_t last;
+      } fastforward;
    } frames;
 
    struct
@@ -113,6 +144,8 @@ typedef struct global
 {
    bool verbosity;
    bool perfcnt_enable;
+   /* Also count CPU events (Linux perf_event) in perf counters. */
+   bool perfcnt_hw_enable;
    bool force_fullscreen;
    bool core_shutdown_initiated;
 
@@ -121,6 +154,18 @@ typedef struct global
    core_info_list_t *core_info;
    core_info_t *core_info_current;
 
+   /* Chrome trace of the startup phases, written if set. */
+   char startup_trace_path[PATH_MAX_LENGTH];
+   /* Chrome trace of all perf counters, written on exit if set. */
+   char perf_trace_path[PATH_MAX_LENGTH];
+
+   struct
+   {
+      /* Frames to run headless, 0 when not benchmarking. */
+      unsigned frames;
+      retro_time_t start;
+   } benchmark;
+
    uint32_t content_crc;
 
    char gb_rom_path[PATH_MAX_LENGTH];
@@ -291,6 +336,17 @@ typedef struct global
       bool frame_is_reverse;
    } rewind;
 
+   struct
+   {
+      /* Run-ahead support. */
+      void *state;
+      size_t size;
+      /* Smoothed time the core takes per shown frame, in usec. */
+      retro_time_t cost;
+      unsigned slow_frames;
+      bool disabled;
+   } runahead;
+
    struct
    {
       /* Movie playback/recording support. */
@@ -16,6 +16,7 @@
 #include <retro_miscellaneous.h>
 #include "runloop_data.h"
 #include "general.h"
+#include "performance.h"
 #include "input/input_overlay.h"
 
 #ifdef HAVE_THREADS
@@ -663,8 +664,10 @@ static void rarch_main_data_nbio_iterate(bool is_thread, nbio_handle_t *nbio)
    {
       if (!nbio->is_blocking)
       {
+         rarch_perf_trace_begin("nbio_transfer");
          if (rarch_main_data_nbio_iterate_transfer(nbio) == -1)
             rarch_main_data_nbio_iterate_parse(nbio);
+         rarch_perf_trace_end("nbio_transfer");
       }
       else if (nbio->is_finished)
          rarch_main_data_nbio_iterate_parse_free(nbio);
@@ -676,13 +679,17 @@ static void rarch_main_data_nbio_iterate(bool is_thread, nbio_handle_t *nbio)
    {
       if (nbio->image.is_blocking_on_processing)
       {
+         rarch_perf_trace_begin("image_process");
          if (rarch_main_data_image_iterate_process_transfer(nbio) == -1)
             rarch_main_data_image_iterate_process_transfer_parse(nbio);
+         rarch_perf_trace_end("image_process");
       }
       else if (!nbio->image.is_blocking)
       {
+         rarch_perf_trace_begin("image_transfer");
          if (rarch_main_data_image_iterate_transfer(nbio) == -1)
             rarch_main_data_image_iterate_transfer_parse(nbio);
+         rarch_perf_trace_end("image_transfer");
       }
       else if (nbio->image.is_finished)
          rarch_main_data_image_iterate_parse_free(nbio);
@@ -834,6 +841,8 @@ static void data_thread_loop(void *data)
 {
    data_runloop_t *runloop = (data_runloop_t*)data;
 
+   rarch_perf_trace_thread_name("data");
+
    RARCH_LOG("[Data Thread]: Initializing data thread.\n");
 
    slock_lock(runloop->lock);
@@ -858,6 +867,8 @@ static void data_thread_loop(void *data)
    RARCH_LOG("[Data Thread]: Stopping data thread.\n");
    
    data_runloop_thread_deinit(runloop);
+
+   rarch_perf_thread_exit();
 }
 
 static void rarch_main_data_thread_init(void)
@@ -2157,6 +2157,13 @@ int setting_get_description(const char *label, char *msg,
             "-- Enable or disable frontend \n"
             "performance counters.");
    }
+   else if (!strcmp(label, "perfcnt_hw_enable"))
+   {
+      snprintf(msg, sizeof_msg,
+            "-- Also count CPU cycles, instructions, \n"
+            "cache and branch misses in performance \n"
+            "counters. Linux only.");
+   }
    else if (!strcmp(label, "system_directory"))
    {
       snprintf(msg, sizeof_msg,
@@ -2252,6 +2259,19 @@ int setting_get_description(const char *label, char *msg,
             " \n"
             "Maximum is 15.");
    }
+   else if (!strcmp(label, "video_frame_delay_auto"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Picks the frame delay automatically.\n"
+            " \n"
+            "Delays as long as the time the core \n"
+            "has recently been taking per frame \n"
+            "allows, and backs off as soon as a \n"
+            "VSync is missed. \n"
+            " \n"
+            "A non-zero Frame Delay is then the \n"
+            "upper bound.");
+   }
    else if (!strcmp(label, "audio_rate_control_delta"))
    {
       snprintf(msg, sizeof_msg,
@@ -2420,6 +2440,19 @@ int setting_get_description(const char *label, char *msg,
             "Do not rely on this cap to be perfectly \n"
             "accurate.");
    }
+   else if (!strcmp(label, "fastforward_frameskip"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Fast forward frame skip.\n"
+            " \n"
+            "Presents only every Nth frame while \n"
+            "fast forwarding. The other frames skip \n"
+            "video and audio processing, so fast \n"
+            "forward runs as fast as the core can.\n"
+            " \n"
+            " 0: Present at the display's refresh rate.\n"
+            " 1: Present every frame.");
+   }
    else if (!strcmp(label, "pause_nonactive"))
    {
       snprintf(msg, sizeof_msg,
@@ -2549,6 +2582,33 @@ int setting_get_description(const char *label, char *msg,
             "at a time, increasing the rewinding \n"
             "speed.");
    }
+   else if (!strcmp(label, "run_ahead_frames"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Run-ahead frames.\n"
+            " \n"
+            "Runs the core this many frames ahead \n"
+            "of what is shown and rolls back, \n"
+            "hiding the game's own input lag. \n"
+            " \n"
+            "Needs save state support, and costs \n"
+            "that many extra frames of CPU time. \n"
+            "Turned off if the core can't keep up.");
+   }
+   else if (!strcmp(label, "emulation_threaded"))
+   {
+      snprintf(msg, sizeof_msg,
+            " -- Threaded emulation.\n"
+            " \n"
+            "Runs the core on its own thread, so \n"
+            "presenting frames and background \n"
+            "tasks don't take time out of the \n"
+            "frame. Adds a frame of latency. \n"
+            " \n"
+            "Not used for hardware rendered cores, \n"
+            "nor with rewind, netplay, movies or \n"
+            "run-ahead.");
+   }
    else if (!strcmp(label, "rewind_enable"))
    {
       snprintf(msg, sizeof_msg,
@@ -3714,6 +3774,18 @@ static bool setting_append_list_general_options(
          general_read_handler);
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 
+   CONFIG_BOOL(global->perfcnt_hw_enable,
+         "perfcnt_hw_enable",
+         "Hardware Performance Counters",
+         false,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
    CONFIG_BOOL(settings->config_save_on_exit,
          "config_save_on_exit",
          "Configuration Save On Exit",
@@ -3767,6 +3839,41 @@ static bool setting_append_list_general_options(
 
    END_SUB_GROUP(list, list_info);
 
+   START_SUB_GROUP(list, list_info, "Run-ahead", group_info.name, subgroup_info);
+
+   CONFIG_UINT(
+         settings->run_ahead_frames,
+         "run_ahead_frames",
+         "Run-Ahead Frames",
+         run_ahead_frames,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 6, 1, true, true);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
+   END_SUB_GROUP(list, list_info);
+
+#ifdef HAVE_THREADS
+   START_SUB_GROUP(list, list_info, "Threaded emulation", group_info.name, subgroup_info);
+
+   CONFIG_BOOL(
+         settings->emulation_threaded,
+         "emulation_threaded",
+         "Threaded Emulation",
+         emulation_threaded,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
+   END_SUB_GROUP(list, list_info);
+#endif
+
    START_SUB_GROUP(list, list_info, "Saving", group_info.name, subgroup_info);
 
    CONFIG_BOOL(
@@ -3863,6 +3970,18 @@ static bool setting_append_list_general_options(
          general_read_handler);
    settings_list_current_add_range(list, list_info, 1, 10, 0.1, true, true);
 
+   CONFIG_UINT(
+         settings->fastforward_frameskip,
+         "fastforward_frameskip",
+         "Fast Forward Frame Skip",
+         fastforward_frameskip,
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_list_current_add_range(list, list_info, 0, 30, 1, true, true);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
    CONFIG_FLOAT(
          settings->slowmotion_ratio,
          "slowmotion_ratio",
@@ -4341,6 +4460,19 @@ static bool setting_append_list_video_options(
    settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 
+   CONFIG_BOOL(
+         settings->video.frame_delay_auto,
+         "video_frame_delay_auto",
+         "Automatic Frame Delay",
+         frame_delay_auto,
+         "OFF",
+         "ON",
+         group_info.name,
+         subgroup_info.name,
+         general_write_handler,
+         general_read_handler);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
 #if !defined(RARCH_MOBILE)
    CONFIG_BOOL(
          settings->video.black_frame_insertion,